@@ -680,17 +680,23 @@
 #define INCLUDED_LORA_DECODER_H
 
 #include <lora/api.h>
-#include <gnuradio/sync_block.h>
+#include <gnuradio/block.h>
+#include <string>
 
 namespace gr {
   namespace lora {
 
     /*!
-     * \brief <+description of block+>
+     * \brief Decodes LoRa frames of one spreading factor.
      * \ingroup lora
      *
+     * Every decoded frame is published on the `frames` port as a PDU: a metadata
+     * dictionary and a u8vector with the header and payload bytes. The dictionary holds
+     * `sf`, `cr`, `length` (payload bytes), `crc_ok` (unless the CRC check is off),
+     * `cfo` (Hz), `snr` (dB), the absolute sample offsets `preamble_index` and `end_index`,
+     * and `end_time` and `publish_time` (seconds since the epoch).
      */
-    class LORA_API decoder : virtual public gr::sync_block {
+    class LORA_API decoder : virtual public gr::block {
      public:
       typedef boost::shared_ptr<decoder> sptr;
 
@@ -701,12 +707,73 @@ namespace gr {
        * constructor is in a private implementation
        * class. lora::decoder::make is the public interface for
        * creating new instances.
+       *
+       * \param samp_rate     The sample rate of the input.
+       * \param sf            The spreading factor to decode.
+       * \param demodulation  "gradient", "fft", or "auto" to time both at startup and keep the fastest.
+       * \param export_raw    Publish the raw samples of every decoded symbol on the `debug` port,
+       *                      as a PDU of an `offset` in the input stream and a c32vector of samples, taken from the
+       *                      second input (or the first if unconnected). Not zero-copy: a pmt vector owns its
+       *                      storage, so each symbol is copied once into a new one, which any sink (or Python) can
+       *                      read. Off, the decoder pays nothing for it.
+       */
+      static sptr make(float samp_rate, int sf, const std::string &demodulation = "auto", bool export_raw = false);
+
+      /*!
+       * \brief Switch to another spreading factor while running, at the next symbol boundary.
+       *
+       * A frame being decoded at that moment is dropped. The state of every spreading factor
+       * and sample rate used so far (ideal chirps, FFT plans, filters) is kept, so switching
+       * back is only a pointer swap. A symbol longer than the input buffer was sized for when
+       * the flowgraph started is refused, see prepare().
+       *
+       * \return Whether the switch was accepted, false for an invalid or refused configuration.
+       */
+      virtual bool set_sf(uint8_t sf) = 0;
+
+      /*!
+       * \brief Switch to another input sample rate while running, like set_sf().
+       *
+       * \return Whether the switch was accepted.
        */
-      static sptr make(float samp_rate, int sf);
+      virtual bool set_samp_rate(float samp_rate) = 0;
+
+      /*!
+       * \brief Build the state of the given spreading factor and sample rate ahead of a switch,
+       * and size the input buffer for its symbols when the flowgraph is (re)started.
+       */
+      virtual void prepare(uint8_t sf, float samp_rate) = 0;
 
-      virtual void set_sf(uint8_t sf) = 0;
-      virtual void set_samp_rate(float samp_rate) = 0;
       virtual void set_abs_threshold(float threshold) = 0;
+
+      /*!
+       * \brief Track the noise floor while looking for preambles, and keep the detection
+       * threshold the given margin above it instead of the absolute threshold.
+       *
+       * \param margin_db The margin in dB, around 1 to 3. 0 (default) uses the absolute threshold.
+       */
+      virtual void set_threshold_margin(float margin_db) = 0;
+
+      /*!
+       * \brief Size the input buffer to hold the given amount of symbols (at least 4, the default).
+       *
+       * Larger buffers let the scheduler hand over more symbols per call, at the cost of memory.
+       * Only takes effect when the flowgraph is (re)started.
+       */
+      virtual void set_buffer_symbols(uint32_t symbols) = 0;
+
+      /*!
+       * \brief Set what to do with the CRC-16 after the payload of each frame.
+       *
+       * \param check "off" to publish frames unchecked, "flag" (default) to publish every frame
+       *              with `crc_ok` in its metadata, or "drop" to only publish frames whose CRC matches.
+       */
+      virtual void set_crc_check(const std::string &check) = 0;
+
+      /*!
+       * \brief Set whether to check the header checksum (default), and skip the payload of a corrupt header.
+       */
+      virtual void set_header_check(bool check) = 0;
     };
 
   } // namespace lora
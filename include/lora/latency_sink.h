@@ -0,0 +1,70 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_LORA_LATENCY_SINK_H
+#define INCLUDED_LORA_LATENCY_SINK_H
+
+#include <lora/api.h>
+#include <gnuradio/block.h>
+#include <cstdint>
+#include <string>
+
+namespace gr {
+  namespace lora {
+
+    /*!
+     * \brief Measures how long decoded frames take to reach it, per spreading factor.
+     * \ingroup lora
+     *
+     * Connect it to the `frames` port of a lora::decoder or lora::multi_sf_decoder.
+     * For each frame it measures the decode latency (from demodulating the last
+     * payload symbol to publishing the frame) and the delivery latency (from
+     * demodulating the last symbol to the frame arriving here), both from the
+     * frame's metadata. The percentiles are printed when the flowgraph stops.
+     */
+    class LORA_API latency_sink : virtual public gr::block {
+     public:
+      typedef boost::shared_ptr<latency_sink> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of lora::latency_sink.
+       */
+      static sptr make();
+
+      /*!
+       * \brief Return the given percentile (0 to 100) of the delivery latency in seconds, 0 without frames.
+       */
+      virtual double percentile(int sf, double p) const = 0;
+
+      /*!
+       * \brief Return the amount of frames received with the given spreading factor.
+       */
+      virtual uint64_t count(int sf) const = 0;
+
+      /*!
+       * \brief Return a table of the p50 and p99 latencies per spreading factor.
+       */
+      virtual std::string report() const = 0;
+    };
+
+  } // namespace lora
+} // namespace gr
+
+#endif /* INCLUDED_LORA_LATENCY_SINK_H */
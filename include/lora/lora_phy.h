@@ -0,0 +1,118 @@
+/* -*- c -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_LORA_LORA_PHY_H
+#define INCLUDED_LORA_LORA_PHY_H
+
+/*!
+ * \file
+ * \brief C interface of liblora-phy, the LoRa PHY without GNU Radio.
+ * \ingroup lora
+ *
+ * Push (channelized) samples at any pace, decoded frames come back through a
+ * callback, called from within lora_phy_push or lora_phy_flush.
+ * An instance is not thread-safe, but instances are independent of each other.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#  define LORA_PHY_API __attribute__((visibility("default")))
+#else
+#  define LORA_PHY_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct lora_phy lora_phy;
+
+/*!
+ * \brief What is known about a decoded frame, like the `frames` port metadata of lora::decoder.
+ */
+typedef struct lora_frame_info {
+  uint8_t  sf;              /*!< Spreading factor. */
+  uint8_t  cr;              /*!< Coding rate from the header, 1 to 4 for 4/5 to 4/8. */
+  uint8_t  length;          /*!< Payload length from the header. */
+  uint8_t  crc_checked;     /*!< Whether the payload CRC was checked. */
+  uint8_t  crc_ok;          /*!< Whether it matched, if checked. */
+  float    cfo;             /*!< Carrier frequency offset in Hz. */
+  float    snr;             /*!< SNR in dB. */
+  uint64_t preamble_index;  /*!< Index of the detected preamble in the pushed samples. */
+  uint64_t end_index;       /*!< Index right after the last payload symbol. */
+  int64_t  end_time;        /*!< Wall clock (ns since the epoch) at which the last symbol was demodulated. */
+} lora_frame_info;
+
+/*!
+ * \brief Receives every decoded frame: the header and payload bytes, and their metadata.
+ */
+typedef void (*lora_frame_callback)(const uint8_t *bytes, uint32_t len, const lora_frame_info *info, void *user);
+
+/*!
+ * \brief Return a new decoder, or NULL if the arguments are invalid.
+ *
+ * \param samp_rate     Sample rate of the samples to push, a multiple of 125 kHz.
+ * \param sf            Spreading factor, 6 to 12.
+ * \param demodulation  "gradient", "fft" or "auto" (NULL), which times both and keeps the fastest.
+ */
+LORA_PHY_API lora_phy *lora_phy_create(float samp_rate, int sf, const char *demodulation);
+
+/*!
+ * \brief Destroy a decoder. Frames still being decoded are dropped, flush first to keep them.
+ */
+LORA_PHY_API void lora_phy_destroy(lora_phy *phy);
+
+LORA_PHY_API void lora_phy_set_frame_callback(lora_phy *phy, lora_frame_callback callback, void *user);
+
+/*!
+ * \brief Decode the given samples, kept until enough follow to process them.
+ *        They are dropped, with a warning on stderr, if there is no memory to keep them.
+ *
+ * \param iq    Interleaved I and Q, as in a `.cfile`.
+ * \param count Amount of (complex) samples.
+ */
+LORA_PHY_API void lora_phy_push(lora_phy *phy, const float *iq, size_t count);
+
+/*!
+ * \brief Wait until every frame that ended in the pushed samples went to the callback.
+ */
+LORA_PHY_API void lora_phy_flush(lora_phy *phy);
+
+/*!
+ * \brief Set what to do with the payload CRC: "off", "flag" (default) or "drop". Returns 0 for an unknown value.
+ */
+LORA_PHY_API int lora_phy_set_crc_check(lora_phy *phy, const char *check);
+
+LORA_PHY_API void lora_phy_set_header_check(lora_phy *phy, int check);
+LORA_PHY_API void lora_phy_set_abs_threshold(lora_phy *phy, float threshold);
+LORA_PHY_API void lora_phy_set_threshold_margin(lora_phy *phy, float margin_db);
+
+/*!
+ * \brief Return the amount of samples pushed so far.
+ */
+LORA_PHY_API uint64_t lora_phy_samples_pushed(const lora_phy *phy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDED_LORA_LORA_PHY_H */
@@ -0,0 +1,75 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_LORA_MULTI_SF_DECODER_H
+#define INCLUDED_LORA_MULTI_SF_DECODER_H
+
+#include <lora/api.h>
+#include <gnuradio/block.h>
+#include <string>
+#include <vector>
+
+namespace gr {
+  namespace lora {
+
+    /*!
+     * \brief Decode several spreading factors from one channelized input stream.
+     * \ingroup lora
+     *
+     * Shares a single energy gate between all spreading factors and only
+     * runs the per-SF decoders (on a thread pool) while the channel is busy.
+     */
+    class LORA_API multi_sf_decoder : virtual public gr::block {
+     public:
+      typedef boost::shared_ptr<multi_sf_decoder> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of lora::multi_sf_decoder.
+       *
+       * \param samp_rate The sample rate of the (channelized) input.
+       * \param sfs       The spreading factors to decode, e.g. 7 to 12.
+       * \param threads   Amount of decoding threads, 0 to pick one per spreading factor.
+       * \param demodulation "gradient", "fft", or "auto" to pick the fastest for each spreading factor.
+       */
+      static sptr make(float samp_rate, const std::vector<int> &sfs, int threads = 0, const std::string &demodulation = "auto");
+
+      virtual void set_abs_threshold(float threshold) = 0;
+
+      /*!
+       * \brief Keep the energy gate and every decoder the given margin (dB) above the tracked
+       * noise floor, instead of the absolute threshold. 0 (default) turns it off.
+       */
+      virtual void set_threshold_margin(float margin_db) = 0;
+
+      /*!
+       * \brief Set what to do with the payload CRC of each frame: "off", "flag" (default) or "drop".
+       */
+      virtual void set_crc_check(const std::string &check) = 0;
+
+      /*!
+       * \brief Set whether to check the header checksum (default), and skip the payload of a corrupt header.
+       */
+      virtual void set_header_check(bool check) = 0;
+    };
+
+  } // namespace lora
+} // namespace gr
+
+#endif /* INCLUDED_LORA_MULTI_SF_DECODER_H */
@@ -0,0 +1,77 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_LORA_MULTICHANNEL_RECEIVER_H
+#define INCLUDED_LORA_MULTICHANNEL_RECEIVER_H
+
+#include <lora/api.h>
+#include <gnuradio/hier_block2.h>
+#include <string>
+#include <vector>
+
+namespace gr {
+  namespace lora {
+
+    /*!
+     * \brief Gateway-style receiver decoding several LoRa channels from one wideband capture.
+     * \ingroup lora
+     *
+     * A polyphase filterbank channelizer splits the input into channels of
+     * `channel_spacing` Hz. Every requested channel is resampled to
+     * `out_samp_rate` and decoded by its own lora::multi_sf_decoder.
+     * All decoded frames are published on the `frames` message port.
+     */
+    class LORA_API multichannel_receiver : virtual public gr::hier_block2 {
+     public:
+      typedef boost::shared_ptr<multichannel_receiver> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of lora::multichannel_receiver.
+       *
+       * \param samp_rate       The sample rate of the wideband input.
+       * \param center_freq     The center frequency of the wideband input.
+       * \param channel_spacing Spacing of the channelizer bins, e.g. 200e3 for the EU868 and US915 uplink grids.
+       * \param channel_freqs   Absolute frequencies of the channels to decode, empty to decode every bin.
+       * \param sfs             The spreading factors to decode on every channel.
+       * \param out_samp_rate   The sample rate given to the decoders, a multiple of the 125 kHz bandwidth.
+       * \param cores           CPU cores to pin the per-channel chains and their decoding threads to (round robin), empty to not pin.
+       * \param demodulation    "gradient", "fft", or "auto" to pick the fastest for each spreading factor.
+       */
+      static sptr make(float samp_rate,
+                       double center_freq,
+                       double channel_spacing,
+                       const std::vector<double> &channel_freqs,
+                       const std::vector<int> &sfs,
+                       float out_samp_rate = 500e3,
+                       const std::vector<int> &cores = std::vector<int>(),
+                       const std::string &demodulation = "auto");
+
+      virtual size_t num_channels() const = 0;
+      virtual double channel_freq(size_t channel) const = 0;
+      virtual void set_abs_threshold(float threshold) = 0;
+      virtual void set_threshold_margin(float margin_db) = 0;
+      virtual void set_crc_check(const std::string &check) = 0;
+      virtual void set_header_check(bool check) = 0;
+    };
+
+  } // namespace lora
+} // namespace gr
+
+#endif /* INCLUDED_LORA_MULTICHANNEL_RECEIVER_H */
@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_LORA_PHY_STREAM_H
+#define INCLUDED_LORA_PHY_STREAM_H
+
+#include <lora/lora_phy.h>
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace gr {
+  namespace lora {
+
+    /*!
+     * \brief The LoRa PHY as a plain C++ stream, without GNU Radio (liblora-phy).
+     * \ingroup lora
+     *
+     * Push (channelized) samples in chunks of any size, decoded frames come back
+     * through the frame callback. lora::decoder runs the same state machine
+     * inside a GNU Radio flowgraph. See lora_phy.h for the C interface.
+     */
+    class LORA_PHY_API phy_stream {
+     public:
+      typedef std::function<void(const uint8_t *bytes, uint32_t len, const lora_frame_info &info)> frame_callback;
+
+      /*!
+       * \param samp_rate     Sample rate of the samples to push, a multiple of 125 kHz.
+       * \param sf            Spreading factor, 6 to 12.
+       * \param demodulation  "gradient", "fft", or "auto" to time both and keep the fastest.
+       * \param decode_thread Decode the payloads on a worker thread, calling the frame callback from there.
+       *                      Inline (default), frames are published from push or flush.
+       */
+      phy_stream(float samp_rate, int sf, const std::string &demodulation = "auto", bool decode_thread = false);
+      ~phy_stream();
+
+      phy_stream(const phy_stream&)            = delete;
+      phy_stream& operator=(const phy_stream&) = delete;
+
+      /*!
+       * \brief Decode the given samples, the last few are kept until enough follow to process them.
+       */
+      void push(const std::complex<float> *samples, size_t count);
+
+      /*!
+       * \brief Wait until every frame that ended in the pushed samples went to the callback.
+       */
+      void flush();
+
+      void set_frame_callback(const frame_callback &callback);
+
+      /*!
+       * \brief Set what to do with the payload CRC: "off", "flag" (default) or "drop".
+       * \return False for an unknown value, which leaves the setting unchanged.
+       */
+      bool set_crc_check(const std::string &check);
+      void set_header_check(bool check);
+      void set_abs_threshold(float threshold);
+      void set_threshold_margin(float margin_db);
+
+      uint64_t samples_pushed() const;
+
+     private:
+      struct impl;
+      std::unique_ptr<impl> d_impl;
+    };
+
+  } // namespace lora
+} // namespace gr
+
+#endif /* INCLUDED_LORA_PHY_STREAM_H */
@@ -0,0 +1,129 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ *  \brief  Benchmark of the `upchirp_correlator` against one `kernels::cross_correlate_ifreq` per offset.
+ *
+ *  Usage: bench-correlator [samp_rate (1e6)]
+ *
+ *  For every SF, a noisy upchirp is searched over a range of offsets with both methods.
+ *  Reports the cost per offset, the cost of a typical detection attempt in DETECT
+ *  (the range `sliding_norm_cross_correlate_upchirp` searches) and the largest difference in correlation.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "kernels.h"
+#include "upchirp_correlator.h"
+
+typedef gr::lora::kernels::complex_t complex_t;
+
+/**
+ *  Average time in ns of one call to `f`, over enough calls to last about 100 ms.
+ */
+template <typename F>
+static double time_ns(F f) {
+    typedef std::chrono::steady_clock clock;
+    uint32_t runs = 1u;
+
+    for (;;) {
+        const clock::time_point start = clock::now();
+        for (uint32_t r = 0u; r < runs; r++) f();
+        const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+        if (ns > 1e8 || runs >= (1u << 20)) return ns / runs;
+        runs *= 4u;
+    }
+}
+
+int main(int argc, char **argv) {
+    const double samp_rate = argc > 1 ? std::atof(argv[1]) : 1e6;
+    const double bw        = 125e3;
+
+    std::mt19937 gen(42);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+
+    std::printf("%-4s %8s %16s %16s %18s %18s %9s %10s\n",
+                "SF", "offsets", "direct ns/off", "running ns/off", "direct ns/detect", "running ns/detect", "speedup", "max diff");
+
+    for (uint32_t sf = 7u; sf <= 12u; sf++) {
+        const uint32_t sps    = (uint32_t)(samp_rate * (1u << sf) / bw);
+        const uint32_t window = 2u * sps;
+        const uint32_t len    = sps - 1u;
+        const uint32_t shift  = sps / 3u;
+
+        // Ideal upchirp and two noisy upchirps starting at `shift`
+        std::vector<complex_t> ideal(sps), samples(window);
+        for (uint32_t i = 0u; i < sps; i++) {
+            const double t = i / samp_rate;
+            ideal[i] = std::polar(1.0f, (float)(-2.0 * M_PI * t * (bw / 2.0 - 0.5 * bw * (bw / (1u << sf)) * t)));
+        }
+        for (uint32_t i = 0u; i < window; i++) {
+            samples[i] = ideal[(i + sps - shift) % sps] + complex_t(noise(gen), noise(gen));
+        }
+
+        std::vector<float> ideal_ifreq(sps), samples_ifreq(window);
+        gr::lora::kernels::instantaneous_frequency(&ideal[0],   &ideal_ifreq[0],   sps);
+        gr::lora::kernels::instantaneous_frequency(&samples[0], &samples_ifreq[0], window);
+
+        gr::lora::upchirp_correlator correlator;
+        correlator.set_ideal(&ideal_ifreq[0], len);
+
+        if (!correlator.is_linear()) {
+            std::printf("%-4u ideal ifreq is not linear at this sample rate, running sums are not used\n", sf);
+            continue;
+        }
+
+        // Per offset: the direct method over a limited range, the running sums over a whole symbol
+        const uint32_t direct_offsets  = std::min(256u, sps);
+        const uint32_t running_offsets = sps;
+        int32_t index;
+        volatile float sink;
+
+        const double direct  = time_ns([&] { sink = correlator.best_direct(&samples_ifreq[0], window, 0u, direct_offsets,  &index); }) / direct_offsets;
+        const double running = time_ns([&] { sink = correlator.best       (&samples_ifreq[0], window, 0u, running_offsets, &index); }) / running_offsets;
+
+        // One detection attempt searches about 3 * coeff offsets around the falling edge
+        const uint32_t coeff  = sf + sf + sf / 2u;
+        const uint32_t from   = shift - 2u * coeff;
+        const uint32_t to     = shift + coeff;
+        const double   direct_detect  = time_ns([&] { sink = correlator.best_direct(&samples_ifreq[0], window, from, to, &index); });
+        const double   running_detect = time_ns([&] { sink = correlator.best       (&samples_ifreq[0], window, from, to, &index); });
+        (void) sink;
+
+        // Both methods should agree on every offset, checked around the peak where the correlation is positive
+        float max_diff = 0.0f;
+        for (uint32_t i = from - 64u; i < to + 64u; i++) {
+            int32_t i1 = -1, i2 = -1;
+            const float c_running = correlator.best       (&samples_ifreq[0], window, i, i + 1u, &i1);
+            const float c_direct  = correlator.best_direct(&samples_ifreq[0], window, i, i + 1u, &i2);
+            max_diff = std::max(max_diff, std::abs(c_running - c_direct));
+        }
+
+        std::printf("%-4u %8u %16.1f %16.1f %18.0f %18.0f %8.1fx %10.2e\n",
+                    sf, to - from, direct, running, direct_detect, running_detect, direct_detect / running_detect, max_diff);
+    }
+
+    return 0;
+}
@@ -0,0 +1,439 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ *  \brief  End-to-end throughput of `phy_decoder`, fed as fast as possible instead of throttled to real time.
+ *
+ *  Usage: bench-e2e [options] [qa_BasicTest_Data_*.xml ...]
+ *
+ *      -m method       Demodulation: "gradient", "fft" or "auto" (auto)
+ *      -n snr          SNR in the 125 kHz channel of the synthetic frames, in dB (20)
+ *      -l length       Payload length of the synthetic frames (16)
+ *      -R repeats      Decode every input this many times and keep the fastest run (3)
+ *      -o file         Write the results as JSON to this file
+ *      -b file         Compare against the JSON results in this file, exit with 1 on a regression
+ *      -t threshold    Largest drop in samples/s that is not a regression, as a fraction (0.10)
+ *      -S              Skip the synthetic frames, only decode the captures
+ *
+ *  Synthetic: for every SF 7 to 12 at 250 kS/s, 1 MS/s and 2 MS/s, frames from `frame_encoder` (CR 4/8, random payloads)
+ *  are spread over channel-filtered noise, about 4M samples in total (at least 4 frames).
+ *  <BR>Captures: every TEST of the given XML files with an existing capture is channelized like in `qa_BasicTest_XML.py`
+ *  and decoded at 1 MS/s. Missing captures are skipped.
+ *  <BR>Reports the samples decoded per second, the real-time factor (how many times faster than the sample rate), the frames
+ *  with a matching CRC per second and out of those sent, and the CPU time spent in each `DecoderState`. Frames are decoded on
+ *  the calling thread, so their CPU time counts towards DECODE_PAYLOAD.
+ *  <BR>A run regresses when its samples/s drop more than the threshold below the baseline, or fewer frames decode.
+ *  Runs missing from the baseline are only reported.
+ */
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "frame_encoder.h"
+#include "phy_decoder.h"
+
+typedef gr::lora::DecoderState DecoderState;
+
+static const uint32_t num_states      = (uint32_t)DecoderState::STOP + 1u;
+static const float    sample_rates[]  = { 250e3f, 1e6f, 2e6f };
+static const uint64_t target_samples  = 4000000u;
+static const uint32_t noise_length    = 100003u;    ///< Prime, so the noise never repeats in step with a symbol.
+
+/**
+ *  Settings from the command line.
+ */
+struct options {
+    std::string demodulation = "auto";
+    float       snr          = 20.0f;
+    uint32_t    length       = 16u;
+    uint32_t    repeats      = 3u;
+    const char *output       = nullptr;
+    const char *baseline     = nullptr;
+    double      threshold    = 0.10;
+    bool        synthetic    = true;
+};
+
+/**
+ *  One input to decode.
+ */
+struct input {
+    std::string             name;
+    uint8_t                 sf;
+    float                   samp_rate;
+    std::vector<gr_complex> samples;
+    uint32_t                frames;             ///< Amount of frames sent (synthetic) or expected (captures).
+};
+
+/**
+ *  One row of results, of the fastest run.
+ */
+struct result {
+    std::string name;
+    uint8_t     sf;
+    float       samp_rate;
+    uint64_t    samples;
+    double      seconds;                        ///< Wall time of the run.
+    double      state_seconds[num_states];      ///< CPU time spent in each state.
+    uint32_t    frames_decoded;                 ///< Frames with a matching CRC.
+    uint32_t    frames_sent;
+
+    double samples_per_second() const { return this->samples / this->seconds; }
+    double realtime_factor()    const { return this->samples_per_second() / this->samp_rate; }
+    double frames_per_second()  const { return this->frames_decoded / this->seconds; }
+};
+
+/**
+ *  Swallows what the decoder prints to `std::cout` (its setup and every frame), stdout holds the results.
+ */
+class null_buffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return traits_type::not_eof(c); }
+};
+
+static void usage(const char *name) {
+    std::fprintf(stderr, "Usage: %s [-m gradient|fft|auto] [-n snr] [-l length] [-R repeats] [-o results.json] "
+                         "[-b baseline.json] [-t threshold] [-S] [qa_BasicTest_Data_*.xml ...]\n", name);
+}
+
+/**
+ *  Like the channelizer in `qa_BasicTest_XML.py`: move the channel at `offset` to 0 Hz and low-pass (86 kHz).
+ */
+static std::vector<gr_complex> channelize(std::vector<gr_complex> samples, const double samp_rate, const double offset) {
+    const uint32_t     taps = 101u;
+    const double       fc   = 86e3 / samp_rate;
+    std::vector<float> h(taps);
+
+    for (uint32_t i = 0u; i < taps; i++) {
+        const double n = (double)i - (taps - 1u) / 2.0;
+        const double w = 0.54 - 0.46 * std::cos(2.0 * M_PI * i / (taps - 1u));
+        h[i] = (float)(w * (n == 0.0 ? 2.0 * fc : std::sin(2.0 * M_PI * fc * n) / (M_PI * n)));
+    }
+
+    for (size_t i = 0u; offset != 0.0 && i < samples.size(); i++)
+        samples[i] *= std::polar(1.0f, (float)(-2.0 * M_PI * std::fmod(offset * i / samp_rate, 1.0)));
+
+    std::vector<gr_complex> filtered(samples.size());
+    for (size_t i = 0u; i < samples.size(); i++) {
+        gr_complex acc(0.0f, 0.0f);
+        for (uint32_t k = 0u; k < taps && k <= i; k++)
+            acc += h[k] * samples[i - k];
+        filtered[i] = acc;
+    }
+
+    return filtered;
+}
+
+static std::vector<gr_complex> read_capture(const std::string &path) {
+    std::vector<gr_complex> samples;
+    std::ifstream in(path.c_str(), std::ios::binary);
+    gr_complex s;
+
+    while (in.read(reinterpret_cast<char *>(&s), sizeof(gr_complex)))
+        samples.push_back(s);
+
+    return samples;
+}
+
+static void synthetic(const options &opts, std::vector<input> &inputs) {
+    for (uint32_t sf = 7u; sf <= 12u; sf++) {
+        for (const float samp_rate : sample_rates) {
+            gr::lora::frame_encoder encoder(samp_rate, sf, 4u);
+
+            const uint32_t sps    = encoder.samples_per_symbol();
+            const uint32_t len    = std::min(opts.length, encoder.max_payload_length());
+            const uint32_t frames = std::max<uint64_t>(4u, target_samples / (encoder.frame_samples(len) + 6u * sps));
+
+            std::mt19937 gen(sf);
+            std::normal_distribution<float>         noise(0.0f, 1.0f);
+            std::uniform_int_distribution<uint32_t> byte(0u, 255u);
+            std::uniform_int_distribution<uint32_t> gap(4u * sps, 8u * sps);
+
+            std::ostringstream name;
+            name << "sf" << sf << "/" << (uint32_t)(samp_rate / 1e3f) << "ksps";
+
+            input in = { name.str(), (uint8_t)sf, samp_rate, std::vector<gr_complex>(), frames };
+            std::vector<uint8_t> payload(len);
+
+            in.samples.reserve(frames * (encoder.frame_samples(len) + 8u * sps) + 8u * sps);
+
+            for (uint32_t f = 0u; f < frames; f++) {
+                for (uint8_t &b : payload) b = (uint8_t)byte(gen);
+
+                in.samples.resize(in.samples.size() + gap(gen));
+                encoder.modulate(payload.data(), len, in.samples);
+            }
+            in.samples.resize(in.samples.size() + 8u * sps);
+
+            // The SNR is measured in the channel, after the same low-pass as the captures
+            std::vector<gr_complex> channel_noise(noise_length);
+            for (gr_complex &n : channel_noise) n = gr_complex(noise(gen), noise(gen));
+            channel_noise = channelize(channel_noise, samp_rate, 0.0);
+
+            const float noise_power = std::accumulate(channel_noise.begin(), channel_noise.end(), 0.0,
+                                                      [](double sum, const gr_complex &n) { return sum + std::norm(n); }) / noise_length;
+            const float scale       = std::sqrt(std::pow(10.0f, -opts.snr / 10.0f) / noise_power);
+
+            for (size_t i = 0u; i < in.samples.size(); i++) in.samples[i] += scale * channel_noise[i % noise_length];
+
+            inputs.push_back(std::move(in));
+        }
+    }
+}
+
+static void captures(const char *xml, std::vector<input> &inputs) {
+    boost::property_tree::ptree tree;
+
+    try {
+        boost::property_tree::read_xml(xml, tree);
+    } catch (const boost::property_tree::xml_parser_error &e) {
+        std::fprintf(stderr, "Skipping %s: %s\n", xml, e.what());
+        return;
+    }
+
+    const std::string dir = std::string(xml).substr(0u, std::string(xml).find_last_of('/') + 1u);
+
+    for (const auto &test : tree.get_child("lora-test-data")) {
+        if (test.first != "TEST")
+            continue;
+
+        const std::string file  = test.second.get<std::string>("file", "");
+        const uint32_t    sf    = test.second.get<uint32_t>("spreading-factor", 7u);
+        const uint32_t    times = test.second.get<uint32_t>("expected-times", 0u);
+
+        // As given, relative to the XML, or in `lora-samples` next to the XML
+        std::string path;
+        for (const std::string &candidate : { file, dir + file, dir + "lora-samples/" + file.substr(file.find_last_of('/') + 1u) }) {
+            if (std::ifstream(candidate.c_str()).good()) {
+                path = candidate;
+                break;
+            }
+        }
+
+        if (path.empty()) {
+            std::fprintf(stderr, "Skipping TEST %s: %s does not exist\n", test.second.get<std::string>("<xmlattr>.id", "?").c_str(), file.c_str());
+            continue;
+        }
+
+        // Captured at 868.0 MHz, transmitted at 868.1 MHz
+        input in = { path.substr(path.find_last_of('/') + 1u), (uint8_t)sf, 1e6f, channelize(read_capture(path), 1e6, 100e3), times };
+        inputs.push_back(std::move(in));
+    }
+}
+
+/**
+ *  Decode `in` once, timing every step by the state it started in.
+ */
+static result run(const options &opts, const input &in) {
+    typedef std::chrono::steady_clock clock;
+
+    result r = { in.name, in.sf, in.samp_rate, in.samples.size(), 0.0, { 0.0 }, 0u, in.frames };
+
+    gr::lora::phy_decoder decoder(in.samp_rate, in.sf, opts.demodulation, false);
+    decoder.set_frame_callback([&r](const uint8_t *, const uint32_t, const gr::lora::frame_info &info) {
+        if (info.crc_checked && info.crc_ok)
+            r.frames_decoded++;
+    });
+
+    const clock::time_point start = clock::now();
+    uint64_t pos = 0u;
+
+    while (pos + decoder.samples_needed() <= in.samples.size()) {
+        const DecoderState      before     = decoder.state();
+        const clock::time_point step_start = clock::now();
+
+        pos += decoder.process(&in.samples[pos], &in.samples[pos]);
+
+        r.state_seconds[(uint32_t)before] += std::chrono::duration<double>(clock::now() - step_start).count();
+    }
+
+    decoder.flush();
+    r.seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    return r;
+}
+
+static void write_json(const options &opts, const std::vector<result> &results) {
+    FILE *out = std::fopen(opts.output, "w");
+
+    if (!out) {
+        std::fprintf(stderr, "Cannot write %s\n", opts.output);
+        return;
+    }
+
+    std::fprintf(out, "{\n  \"demodulation\": \"%s\",\n  \"snr\": %g,\n  \"results\": [", opts.demodulation.c_str(), opts.snr);
+
+    for (size_t i = 0u; i < results.size(); i++) {
+        const result &r = results[i];
+
+        std::fprintf(out, "%s\n    {\n      \"name\": \"%s\",\n      \"sf\": %u,\n      \"samp_rate\": %g,\n      \"samples\": %llu,\n"
+                          "      \"seconds\": %.6f,\n      \"samples_per_second\": %.1f,\n      \"realtime_factor\": %.3f,\n"
+                          "      \"frames_per_second\": %.3f,\n      \"frames_decoded\": %u,\n      \"frames_sent\": %u,\n"
+                          "      \"state_seconds\": {",
+                     i ? "," : "", r.name.c_str(), r.sf, r.samp_rate, (unsigned long long)r.samples, r.seconds,
+                     r.samples_per_second(), r.realtime_factor(), r.frames_per_second(), r.frames_decoded, r.frames_sent);
+
+        for (uint32_t s = 0u; s < num_states; s++)
+            std::fprintf(out, "%s \"%s\": %.6f", s ? "," : "", gr::lora::DecoderStateToString((DecoderState)s).c_str(), r.state_seconds[s]);
+
+        std::fprintf(out, " }\n    }");
+    }
+
+    std::fprintf(out, "\n  ]\n}\n");
+    std::fclose(out);
+}
+
+/**
+ *  Compare against the baseline, returns the amount of regressions (or 1 if the baseline is unreadable).
+ */
+static uint32_t compare(const options &opts, const std::vector<result> &results) {
+    boost::property_tree::ptree tree;
+
+    try {
+        boost::property_tree::read_json(opts.baseline, tree);
+    } catch (const boost::property_tree::json_parser_error &e) {
+        std::fprintf(stderr, "Cannot read the baseline %s: %s\n", opts.baseline, e.what());
+        return 1u;
+    }
+
+    const boost::property_tree::ptree                          none;
+    std::map<std::string, const boost::property_tree::ptree *> baseline;
+    for (const auto &entry : tree.get_child("results", none))
+        baseline[entry.second.get<std::string>("name", "")] = &entry.second;
+
+    uint32_t regressions = 0u;
+
+    std::printf("\n%-28s %12s %12s %8s %10s  %s\n", "Baseline", "Msamples/s", "was", "change", "decoded", "");
+    for (const result &r : results) {
+        const auto found = baseline.find(r.name);
+
+        if (found == baseline.end()) {
+            std::printf("%-28s %12.3f %12s %8s %10u  new\n", r.name.c_str(), r.samples_per_second() / 1e6, "-", "-", r.frames_decoded);
+            continue;
+        }
+
+        const double   was_rate    = found->second->get<double>("samples_per_second", 0.0);
+        const uint32_t was_decoded = found->second->get<uint32_t>("frames_decoded", 0u);
+        const double   change      = was_rate > 0.0 ? r.samples_per_second() / was_rate - 1.0 : 0.0;
+        const bool     slower      = change < -opts.threshold;
+        const bool     fewer       = r.frames_decoded < was_decoded;
+
+        std::printf("%-28s %12.3f %12.3f %+7.1f%% %5u/%-4u  %s\n", r.name.c_str(), r.samples_per_second() / 1e6, was_rate / 1e6,
+                    change * 100.0, r.frames_decoded, was_decoded, slower || fewer ? "REGRESSION" : "ok");
+
+        if (slower || fewer)
+            regressions++;
+    }
+
+    return regressions;
+}
+
+int main(int argc, char **argv) {
+    options opts;
+    int     c;
+
+    while ((c = getopt(argc, argv, "m:n:l:R:o:b:t:S")) != -1) {
+        switch (c) {
+            case 'm': opts.demodulation = optarg;                                              break;
+            case 'n': opts.snr          = std::strtof(optarg, nullptr);                        break;
+            case 'l': opts.length       = (uint32_t)std::strtoul(optarg, nullptr, 0);          break;
+            case 'R': opts.repeats      = std::max(1ul, std::strtoul(optarg, nullptr, 0));     break;
+            case 'o': opts.output       = optarg;                                              break;
+            case 'b': opts.baseline     = optarg;                                              break;
+            case 't': opts.threshold    = std::strtod(optarg, nullptr);                        break;
+            case 'S': opts.synthetic    = false;                                               break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (opts.length == 0u || opts.length > 255u) {
+        std::fprintf(stderr, "The payload length must be 1 to 255 bytes\n");
+        return 2;
+    }
+
+    std::vector<input> inputs;
+
+    if (opts.synthetic)
+        synthetic(opts, inputs);
+
+    for (int i = optind; i < argc; i++)
+        captures(argv[i], inputs);
+
+    if (inputs.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    null_buffer     discard;
+    std::streambuf *cout_buffer = std::cout.rdbuf(&discard);
+
+    std::vector<result> results;
+    for (const input &in : inputs) {
+        result best = run(opts, in);
+
+        for (uint32_t i = 1u; i < opts.repeats; i++) {
+            const result r = run(opts, in);
+            if (r.seconds < best.seconds)
+                best = r;
+        }
+
+        results.push_back(best);
+    }
+
+    std::cout.rdbuf(cout_buffer);
+
+    std::printf("\n%-28s %10s %12s %10s %10s %10s  %6s %6s %6s %6s %6s\n", "Input", "signal s", "Msamples/s", "realtime", "frames/s",
+                "decoded", "DETECT", "SYNC", "PAUSE", "HDR", "PAYLD");
+    for (const result &r : results) {
+        const double cpu = std::accumulate(r.state_seconds, r.state_seconds + num_states, 0.0);
+        double       share[num_states];
+
+        for (uint32_t s = 0u; s < num_states; s++)
+            share[s] = cpu > 0.0 ? 100.0 * r.state_seconds[s] / cpu : 0.0;
+
+        std::printf("%-28s %10.2f %12.3f %9.1fx %10.1f %6u/%-4u %5.1f%% %5.1f%% %5.1f%% %5.1f%% %5.1f%%\n",
+                    r.name.c_str(), r.samples / r.samp_rate, r.samples_per_second() / 1e6, r.realtime_factor(), r.frames_per_second(),
+                    r.frames_decoded, r.frames_sent, share[(uint32_t)DecoderState::DETECT], share[(uint32_t)DecoderState::SYNC],
+                    share[(uint32_t)DecoderState::PAUSE], share[(uint32_t)DecoderState::DECODE_HEADER], share[(uint32_t)DecoderState::DECODE_PAYLOAD]);
+    }
+
+    if (opts.output)
+        write_json(opts, results);
+
+    if (opts.baseline && compare(opts, results) > 0u)
+        return 1;
+
+    return 0;
+}
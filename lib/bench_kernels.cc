@@ -0,0 +1,317 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ *  \brief  Microbenchmarks of every decoder kernel, with Google Benchmark.
+ *
+ *  Usage: bench-kernels [--benchmark_filter=<regex>] [--benchmark_out=<file> --benchmark_out_format=json]
+ *
+ *  The symbol kernels run for every SF from 7 to 12 at several sample rates (in kS/s, the second argument),
+ *  and report the samples per second. The bit pipeline kernels do not depend on the sample rate,
+ *  and report the codewords (bytes) per second. The whole bit pipeline, from the demodulated symbols to the payload,
+ *  runs both one stage at a time (`BM_bit_chain_generic`) and fused (`BM_bit_chain`), and reports payload bytes per second.
+ *  Write the results as JSON to compare them between releases.
+ */
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "demodulator.h"
+#include "frame_decoder.h"
+#include "frame_encoder.h"
+#include "kernels.h"
+#include "tables.h"
+#include "utilities.h"
+
+typedef gr::lora::kernels::complex_t complex_t;
+
+namespace {
+
+    const double bw = 125e3;
+
+    /**
+     *  Amount of codewords given to the bit pipeline kernels, a payload of 128 bytes at CR 4/8.
+     *  The shortest whitening sequence is longer than this.
+     */
+    const uint32_t payload_words = 256u;
+
+    /**
+     *  \brief  Noisy symbols of one SF and sample rate, with the ideal chirps to process them with.
+     */
+    struct symbols {
+        uint32_t sps;                       ///< The amount of samples in one symbol.
+        uint32_t bins;                      ///< `2^SF`.
+        std::vector<complex_t> upchirp;     ///< The ideal upchirp, also the conjugate of the downchirp.
+        std::vector<complex_t> samples;     ///< A noisy symbol for a random bin.
+        std::vector<float>     ideal_ifreq; ///< The instantaneous frequency of the upchirp.
+        std::vector<float>     ifreq;       ///< The instantaneous frequency of `samples`.
+
+        symbols(const uint32_t sf, const double samp_rate)
+            : sps((uint32_t)(samp_rate * (1u << sf) / bw)),
+              bins(1u << sf),
+              upchirp(sps), samples(sps), ideal_ifreq(sps), ifreq(sps) {
+            std::mt19937 gen(sf);
+            std::normal_distribution<float> noise(0.0f, 0.05f);
+            const uint32_t shift = (uint32_t)(gen() % this->bins) * (this->sps / this->bins);
+
+            for (uint32_t i = 0u; i < this->sps; i++) {
+                const double t = i / samp_rate;
+                this->upchirp[i] = std::polar(1.0f, (float)(-2.0 * M_PI * t * (bw / 2.0 - 0.5 * bw * (bw / this->bins) * t)));
+            }
+            for (uint32_t i = 0u; i < this->sps; i++) {
+                this->samples[i] = this->upchirp[(i + shift) % this->sps] + complex_t(noise(gen), noise(gen));
+            }
+
+            gr::lora::kernels::instantaneous_frequency(&this->upchirp[0], &this->ideal_ifreq[0], this->sps);
+            gr::lora::kernels::instantaneous_frequency(&this->samples[0], &this->ifreq[0],       this->sps);
+        }
+    };
+
+    /**
+     *  \brief  Random codewords, as demodulated from a payload.
+     */
+    std::vector<uint8_t> codewords(const uint32_t len) {
+        std::mt19937 gen(len);
+        std::vector<uint8_t> words(len);
+
+        for (uint8_t &w : words) w = (uint8_t)gen();
+
+        return words;
+    }
+
+    /**
+     *  Every SF from 7 to 12, at 125 kS/s (one sample per chip) up to 2 MS/s.
+     */
+    void symbol_args(benchmark::internal::Benchmark *b) {
+        b->ArgNames({ "sf", "ksps" })->ArgsProduct({ benchmark::CreateDenseRange(7, 12, 1), { 125, 250, 1000, 2000 } });
+    }
+
+    /**
+     *  Every SF from 7 to 12, at CR 4/5 and 4/8.
+     */
+    void bit_args(benchmark::internal::Benchmark *b) {
+        b->ArgNames({ "sf", "cr" })->ArgsProduct({ benchmark::CreateDenseRange(7, 12, 1), { 1, 4 } });
+    }
+
+    void BM_instantaneous_frequency(benchmark::State &state) {
+        symbols s((uint32_t)state.range(0), state.range(1) * 1e3);
+
+        for (auto _ : state) {
+            gr::lora::kernels::instantaneous_frequency(&s.samples[0], &s.ifreq[0], s.sps);
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations() * s.sps);
+    }
+    BENCHMARK(BM_instantaneous_frequency)->Apply(symbol_args);
+
+    void BM_cross_correlate_ifreq(benchmark::State &state) {
+        symbols s((uint32_t)state.range(0), state.range(1) * 1e3);
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(gr::lora::kernels::cross_correlate_ifreq(&s.ifreq[0], &s.ideal_ifreq[0], s.sps - 1u));
+        }
+
+        state.SetItemsProcessed(state.iterations() * (s.sps - 1u));
+    }
+    BENCHMARK(BM_cross_correlate_ifreq)->Apply(symbol_args);
+
+    /**
+     *  `get_shift_fft`: dechirp, FFT and peak search.
+     */
+    void BM_get_shift_fft(benchmark::State &state) {
+        symbols s((uint32_t)state.range(0), state.range(1) * 1e3);
+        gr::lora::fft_demodulator demod(s.sps, s.bins, &s.upchirp[0]);
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(demod.demodulate(&s.samples[0], false));
+        }
+
+        state.SetItemsProcessed(state.iterations() * s.sps);
+    }
+    BENCHMARK(BM_get_shift_fft)->Apply(symbol_args);
+
+    /**
+     *  `max_frequency_gradient_idx`: instantaneous frequency and its steepest fall.
+     */
+    void BM_max_frequency_gradient_idx(benchmark::State &state) {
+        symbols s((uint32_t)state.range(0), state.range(1) * 1e3);
+        gr::lora::gradient_demodulator demod(s.sps, s.bins);
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(demod.demodulate(&s.samples[0], false));
+        }
+
+        state.SetItemsProcessed(state.iterations() * s.sps);
+    }
+    BENCHMARK(BM_max_frequency_gradient_idx)->Apply(symbol_args);
+
+    /**
+     *  One interleaved block: `4 + CR` symbols into `SF` codewords.
+     */
+    void BM_deinterleave(benchmark::State &state) {
+        const uint32_t sf    = (uint32_t)state.range(0),
+                       count = 4u + (uint32_t)state.range(1);
+        std::mt19937 gen(sf);
+        std::vector<uint32_t> words(count);
+        uint8_t out[16];
+
+        for (uint32_t &w : words) w = gen() & ((1u << sf) - 1u);
+
+        for (auto _ : state) {
+            gr::lora::frame_decoder::deinterleave(&words[0], count, sf, out);
+            benchmark::DoNotOptimize(out);
+        }
+
+        state.SetBytesProcessed(state.iterations() * sf);
+    }
+    BENCHMARK(BM_deinterleave)->Apply(bit_args);
+
+    void BM_deinterleave_generic(benchmark::State &state) {
+        const uint32_t sf    = (uint32_t)state.range(0),
+                       count = 4u + (uint32_t)state.range(1);
+        std::mt19937 gen(sf);
+        std::vector<uint32_t> words(count);
+        uint8_t out[16];
+
+        for (uint32_t &w : words) w = gen() & ((1u << sf) - 1u);
+
+        for (auto _ : state) {
+            gr::lora::frame_decoder::deinterleave_generic(&words[0], count, sf, out);
+            benchmark::DoNotOptimize(out);
+        }
+
+        state.SetBytesProcessed(state.iterations() * sf);
+    }
+    BENCHMARK(BM_deinterleave_generic)->Apply(bit_args);
+
+    void BM_deshuffle(benchmark::State &state) {
+        const std::vector<uint8_t> words = codewords(payload_words);
+        std::vector<uint8_t> out(payload_words);
+
+        for (auto _ : state) {
+            gr::lora::frame_decoder::deshuffle(&words[0], payload_words, &out[0]);
+            benchmark::ClobberMemory();
+        }
+
+        state.SetBytesProcessed(state.iterations() * payload_words);
+    }
+    BENCHMARK(BM_deshuffle);
+
+    void BM_dewhiten(benchmark::State &state) {
+        const std::vector<uint8_t> words = codewords(payload_words);
+        const uint8_t *prng = gr::lora::payload_whitening_sequence((uint8_t)state.range(0));
+        std::vector<uint8_t> out(payload_words);
+
+        for (auto _ : state) {
+            gr::lora::frame_decoder::dewhiten(&words[0], payload_words, prng, &out[0]);
+            benchmark::ClobberMemory();
+        }
+
+        state.SetBytesProcessed(state.iterations() * payload_words);
+    }
+    BENCHMARK(BM_dewhiten)->ArgName("sf")->DenseRange(7, 12, 1);
+
+    void BM_hamming_decode_soft(benchmark::State &state) {
+        const std::vector<uint8_t> words = codewords(payload_words);
+        std::vector<uint8_t> out(payload_words / 2u);
+
+        for (auto _ : state) {
+            gr::lora::hamming_decode_soft(&words[0], payload_words, &out[0]);
+            benchmark::ClobberMemory();
+        }
+
+        state.SetBytesProcessed(state.iterations() * payload_words);
+    }
+    BENCHMARK(BM_hamming_decode_soft);
+
+    /**
+     *  \brief  The demodulated symbols of a payload, with the buffers to decode them into.
+     */
+    struct payload_blocks {
+        static const uint32_t length = 64u;     ///< Payload bytes, the CRC included in the blocks.
+
+        uint32_t              sf;
+        uint32_t              count;            ///< Symbols per block, `4 + CR`.
+        uint32_t              blocks;
+        const uint8_t        *prng;
+        const uint8_t        *shuffled_prng;    ///< For `decode_codewords`.
+        std::vector<uint32_t> symbols;
+        std::vector<uint8_t>  words;            ///< The deinterleaved codewords.
+        std::vector<uint8_t>  scratch;          ///< The deshuffled and dewhitened codewords (generic chain).
+        std::vector<uint8_t>  data;
+
+        payload_blocks(const uint32_t sf, const uint32_t cr)
+            : sf(sf),
+              count(4u + cr),
+              blocks(gr::lora::frame_encoder::payload_symbols(length, (uint8_t)cr, (uint8_t)sf, true) / (4u + cr)),
+              prng(gr::lora::payload_whitening_sequence((uint8_t)sf)),
+              shuffled_prng(gr::lora::payload_whitening_sequence((uint8_t)sf, nullptr, true)),
+              symbols(blocks * count), words(blocks * sf), scratch(blocks * sf), data(blocks * sf / 2u + 1u) {
+            std::mt19937 gen(sf);
+
+            for (uint32_t &s : this->symbols) s = gen() & ((1u << sf) - 1u);
+        }
+    };
+
+    /**
+     *  One stage at a time, through a buffer per stage.
+     */
+    void BM_bit_chain_generic(benchmark::State &state) {
+        payload_blocks p((uint32_t)state.range(0), (uint32_t)state.range(1));
+        const uint32_t len = p.blocks * p.sf;
+
+        for (auto _ : state) {
+            for (uint32_t b = 0u; b < p.blocks; b++)
+                gr::lora::frame_decoder::deinterleave_generic(&p.symbols[b * p.count], p.count, p.sf, &p.words[b * p.sf]);
+
+            gr::lora::frame_decoder::deshuffle(&p.words[0], len, &p.scratch[0]);
+            gr::lora::frame_decoder::dewhiten(&p.scratch[0], len, p.prng, &p.scratch[0]);
+            gr::lora::frame_decoder::hamming_decode(&p.scratch[0], len, (uint8_t)state.range(1), &p.data[0]);
+            benchmark::ClobberMemory();
+        }
+
+        state.SetBytesProcessed(state.iterations() * payload_blocks::length);
+    }
+    BENCHMARK(BM_bit_chain_generic)->Apply(bit_args);
+
+    /**
+     *  The bit-matrix transpose, then the lookup tables.
+     */
+    void BM_bit_chain(benchmark::State &state) {
+        payload_blocks p((uint32_t)state.range(0), (uint32_t)state.range(1));
+        const uint32_t len = p.blocks * p.sf;
+
+        for (auto _ : state) {
+            for (uint32_t b = 0u; b < p.blocks; b++)
+                gr::lora::frame_decoder::deinterleave(&p.symbols[b * p.count], p.count, p.sf, &p.words[b * p.sf]);
+
+            gr::lora::frame_decoder::decode_codewords(&p.words[0], len, p.shuffled_prng, (uint8_t)state.range(1), &p.data[0]);
+            benchmark::ClobberMemory();
+        }
+
+        state.SetBytesProcessed(state.iterations() * payload_blocks::length);
+    }
+    BENCHMARK(BM_bit_chain)->Apply(bit_args);
+
+} // namespace
+
+BENCHMARK_MAIN();
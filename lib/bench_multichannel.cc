@@ -0,0 +1,119 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ *  \brief  Benchmark of the `multichannel_receiver`, reporting the CPU time spent per channel.
+ *
+ *  Usage: bench-multichannel [samp_rate (1.6e6)] [seconds of input (10)] [capture.cfile]
+ *
+ *  Without a capture, low-level noise is used, which shows the cost of idle channels.
+ *  The CPU time comes from the GNU Radio performance counters, which are enabled here,
+ *  plus the CPU time of the threads decoding the payloads of each channel, which the counters do not see.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/blocks/file_source.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/head.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "multichannel_receiver_impl.h"
+#include "multi_sf_decoder_impl.h"
+
+static double cpu_seconds(const std::vector<gr::block_sptr> &blocks) {
+    double total = 0.0;
+
+    for (const gr::block_sptr &block : blocks) {
+        total += block->pc_work_time_total();
+    }
+
+    return total / gr::high_res_timer_tps();
+}
+
+int main(int argc, char **argv) {
+    const float    samp_rate = argc > 1 ? std::atof(argv[1]) : 1.6e6f;
+    const double   seconds   = argc > 2 ? std::atof(argv[2]) : 10.0;
+    const char    *capture   = argc > 3 ? argv[3] : NULL;
+    const uint64_t samples   = (uint64_t)(seconds * samp_rate);
+
+    // Read by the preferences singleton, so before any block is made
+    setenv("GR_CONF_PERFCOUNTERS_ON", "True", 1);
+
+    gr::top_block_sptr tb = gr::make_top_block("bench_multichannel");
+
+    gr::basic_block_sptr source;
+    if (capture) {
+        source = gr::blocks::file_source::make(sizeof(gr_complex), capture, true);
+    } else {
+        std::mt19937 gen(42);
+        std::normal_distribution<float> noise(0.0f, 0.001f);
+        std::vector<gr_complex> v(1u << 16);
+
+        for (gr_complex &s : v) {
+            s = gr_complex(noise(gen), noise(gen));
+        }
+        source = gr::blocks::vector_source_c::make(v, true);
+    }
+
+    gr::blocks::head::sptr head = gr::blocks::head::make(sizeof(gr_complex), samples);
+
+    std::vector<int> sfs;
+    for (int sf = 7; sf <= 12; sf++) {
+        sfs.push_back(sf);
+    }
+
+    gr::lora::multichannel_receiver::sptr rx = gr::lora::multichannel_receiver::make(samp_rate, 0.0, 200e3, std::vector<double>(), sfs);
+    gr::lora::multichannel_receiver_impl *impl = dynamic_cast<gr::lora::multichannel_receiver_impl *>(rx.get());
+
+    tb->connect(source, 0, head, 0);
+    tb->connect(head,   0, rx,   0);
+
+    const auto start = std::chrono::steady_clock::now();
+    tb->run();
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("Input: %.1f s of %s at %.0f S/s, ran in %.3f s wall time\n\n",
+                seconds, capture ? capture : "noise", samp_rate, wall);
+    std::printf("%-12s %16s %12s %12s\n", "Channel", "Offset (Hz)", "CPU (s)", "CPU / input");
+
+    const double front = cpu_seconds(impl->front_end_blocks());
+    double       total = front;
+
+    std::printf("%-12s %16s %12.3f %11.2f%%\n", "channelizer", "-", front, 100.0 * front / seconds);
+
+    for (size_t ch = 0u; ch < impl->num_channels(); ch++) {
+        gr::lora::multi_sf_decoder_impl *decoder = dynamic_cast<gr::lora::multi_sf_decoder_impl *>(impl->channel_decoder(ch).get());
+        const double cpu = cpu_seconds(impl->channel_blocks(ch)) + decoder->decode_cpu_seconds();
+        total += cpu;
+
+        std::printf("%-12zu %16.0f %12.3f %11.2f%%\n", ch, impl->channel_freq(ch), cpu, 100.0 * cpu / seconds);
+    }
+
+    std::printf("%-12s %16s %12.3f %11.2f%%\n", "total", "-", total, 100.0 * total / seconds);
+
+    return 0;
+}
@@ -0,0 +1,326 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ *  \brief  Benchmark of the preamble detection methods of `phy_decoder` (see `PreambleDetection`).
+ *
+ *  Usage: bench-preamble [qa_BasicTest_Data_*.xml ...]
+ *
+ *  Synthetic: for every SF and SNR (in the channel), frames (8 upchirps, 2 sync symbols, 2.25 downchirps
+ *  and a short payload) are spread over noise. Reports the CPU time spent in DETECT, the preambles detected
+ *  at an upchirp boundary, the other detections and the frames that reached the HDR. After each frame, the decoder is reset and
+ *  moved to the end of the frame, so a missed detection never hides the next frame.
+ *  <BR>Captures: every TEST of the given XML files with an existing capture is channelized like in
+ *  `qa_BasicTest_XML.py` and decoded. Reports the CPU time spent in DETECT and the frames decoded
+ *  with the expected data, out of the expected amount. Missing captures are skipped.
+ *  <BR>EXACT demodulates a symbol at every offset, so it only runs up to SF8.
+ */
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "phy_decoder.h"
+
+typedef gr::lora::PreambleDetection PreambleDetection;
+
+static const PreambleDetection methods[]      = { PreambleDetection::FAST, PreambleDetection::EXACT, PreambleDetection::STREAMING };
+static const char             *method_names[] = { "fast", "exact", "streaming" };
+static const uint32_t          max_exact_sf   = 8u;
+
+/**
+ *  One row of results.
+ */
+struct result {
+    std::string name;
+    double      seconds;        ///< Duration of the input signal.
+    double      detect_cpu;     ///< CPU time spent in DETECT.
+    uint32_t    hits;           ///< Synthetic: preambles detected at an upchirp boundary. Captures: frames decoded.
+    uint32_t    false_hits;     ///< Synthetic: detections outside a preamble or off the upchirp boundary.
+    uint32_t    synced;         ///< Synthetic: frames that reached the HDR.
+    uint32_t    total;          ///< Amount of frames in the input.
+};
+
+static std::vector<gr_complex> upchirp(const double samp_rate, const uint32_t sf) {
+    const double   bw  = 125e3;
+    const uint32_t sps = (uint32_t)(samp_rate * (1u << sf) / bw);
+    std::vector<gr_complex> chirp(sps);
+
+    // Same as `phy_decoder::build_ideal_chirps`
+    for (uint32_t i = 0u; i < sps; i++) {
+        const double t = i / samp_rate;
+        chirp[i] = gr_complex(1.0f, 1.0f) * std::polar(1.0f, (float)(-2.0 * M_PI * t * (bw / 2.0 - 0.5 * bw * (bw / (1u << sf)) * t)));
+    }
+
+    return chirp;
+}
+
+/**
+ *  Run `decoder` over `samples`, calling `on_step` with the state before and after each step.
+ *  `on_step` can move `pos` (e.g. to skip a frame). Returns the CPU time spent in DETECT.
+ */
+template <typename F>
+static double run(gr::lora::phy_decoder &decoder, const std::vector<gr_complex> &samples, F on_step) {
+    typedef std::chrono::steady_clock clock;
+    double   detect_cpu = 0.0;
+    uint64_t pos        = 0u;
+
+    while (pos + 3u * decoder.samples_per_symbol() <= samples.size()) {
+        const gr::lora::DecoderState before = decoder.state();
+        const clock::time_point      start  = clock::now();
+
+        const uint32_t consumed = decoder.process(&samples[pos], &samples[pos]);
+
+        if (before == gr::lora::DecoderState::DETECT)
+            detect_cpu += std::chrono::duration<double>(clock::now() - start).count();
+
+        pos += consumed;
+        on_step(before, decoder.state(), pos);
+    }
+
+    decoder.flush();
+
+    return detect_cpu;
+}
+
+/**
+ *  Like the channelizer in `qa_BasicTest_XML.py`: move the channel at `offset` to 0 Hz and low-pass (86 kHz).
+ */
+static std::vector<gr_complex> channelize(std::vector<gr_complex> samples, const double samp_rate, const double offset) {
+    const uint32_t     taps = 101u;
+    const double       fc   = 86e3 / samp_rate;
+    std::vector<float> h(taps);
+
+    for (uint32_t i = 0u; i < taps; i++) {
+        const double n = (double)i - (taps - 1u) / 2.0;
+        const double w = 0.54 - 0.46 * std::cos(2.0 * M_PI * i / (taps - 1u));
+        h[i] = (float)(w * (n == 0.0 ? 2.0 * fc : std::sin(2.0 * M_PI * fc * n) / (M_PI * n)));
+    }
+
+    for (size_t i = 0u; offset != 0.0 && i < samples.size(); i++)
+        samples[i] *= std::polar(1.0f, (float)(-2.0 * M_PI * std::fmod(offset * i / samp_rate, 1.0)));
+
+    std::vector<gr_complex> filtered(samples.size());
+    for (size_t i = 0u; i < samples.size(); i++) {
+        gr_complex acc(0.0f, 0.0f);
+        for (uint32_t k = 0u; k < taps && k <= i; k++)
+            acc += h[k] * samples[i - k];
+        filtered[i] = acc;
+    }
+
+    return filtered;
+}
+
+static std::vector<gr_complex> read_capture(const std::string &path) {
+    std::vector<gr_complex> samples;
+    std::ifstream in(path.c_str(), std::ios::binary);
+    gr_complex s;
+
+    while (in.read(reinterpret_cast<char *>(&s), sizeof(gr_complex)))
+        samples.push_back(s);
+
+    return samples;
+}
+
+static void synthetic(const double samp_rate, std::vector<result> &results) {
+    const uint32_t frames  = 20u;
+    const float    snrs[]  = { 20.0f, 10.0f, 0.0f, -5.0f, -10.0f, -15.0f };
+
+    for (uint32_t sf = 7u; sf <= 12u; sf++) {
+        const std::vector<gr_complex> up = upchirp(samp_rate, sf);
+        const uint32_t sps   = up.size();
+        const uint32_t decim = sps >> sf;
+
+        for (const float snr : snrs) {
+            std::mt19937 gen(sf);
+            std::normal_distribution<float>         noise(0.0f, 1.0f);
+            std::uniform_int_distribution<uint32_t> symbol(0u, (1u << sf) - 1u);
+            std::uniform_int_distribution<uint32_t> gap(4u * sps, 8u * sps);
+
+            std::vector<gr_complex> samples;
+            std::vector<uint64_t>   starts, ends;
+
+            for (uint32_t f = 0u; f < frames; f++) {
+                samples.resize(samples.size() + gap(gen));
+                starts.push_back(samples.size());
+
+                for (uint32_t i = 0u; i < 8u * sps; i++) samples.push_back(up[i % sps]);
+                for (uint32_t s : { 24u, 32u })
+                    for (uint32_t i = 0u; i < sps; i++) samples.push_back(up[(i + s * decim) % sps]);
+                for (uint32_t i = 0u; i < 9u * sps / 4u; i++) samples.push_back(std::conj(up[i % sps]));
+                for (uint32_t s = 0u; s < 20u; s++) {
+                    const uint32_t v = symbol(gen);
+                    for (uint32_t i = 0u; i < sps; i++) samples.push_back(up[(i + v * decim) % sps]);
+                }
+
+                ends.push_back(samples.size());
+            }
+            samples.resize(samples.size() + 8u * sps);
+
+            // The SNR is measured in the channel, after the same low-pass as the captures
+            std::vector<gr_complex> channel_noise(samples.size());
+            for (gr_complex &n : channel_noise) n = gr_complex(noise(gen), noise(gen));
+            channel_noise = channelize(channel_noise, samp_rate, 0.0);
+
+            const float noise_power = std::accumulate(channel_noise.begin(), channel_noise.end(), 0.0,
+                                                      [](double sum, const gr_complex &n) { return sum + std::norm(n); }) / samples.size();
+            const float scale       = std::sqrt(std::norm(up[0]) * std::pow(10.0f, -snr / 10.0f) / noise_power);
+
+            for (size_t i = 0u; i < samples.size(); i++) samples[i] += scale * channel_noise[i];
+
+            for (uint32_t m = 0u; m < 3u; m++) {
+                if (methods[m] == PreambleDetection::EXACT && sf > max_exact_sf)
+                    continue;
+
+                gr::lora::phy_decoder decoder(samp_rate, sf, "fft", false);
+                decoder.set_preamble_detection(methods[m]);
+
+                std::ostringstream name;
+                name << "SF" << sf << " " << snr << " dB " << method_names[m];
+
+                result r = { name.str(), samples.size() / samp_rate, 0.0, 0u, 0u, 0u, frames };
+                uint32_t frame = 0u;
+
+                r.detect_cpu = run(decoder, samples, [&](gr::lora::DecoderState before, gr::lora::DecoderState after, uint64_t &pos) {
+                    while (frame < frames && pos >= ends[frame]) frame++;
+
+                    if (before == gr::lora::DecoderState::DETECT && after == gr::lora::DecoderState::SYNC) {
+                        // Within the upchirps and sync symbols, at most 2 bins from an upchirp boundary
+                        const bool    inside = frame < frames && pos + 2u * decim >= starts[frame] && pos < starts[frame] + 10u * sps;
+                        const int64_t offset = ((int64_t)pos - (int64_t)starts[frame] + sps / 2u) % sps - sps / 2u;
+
+                        if (inside && std::abs(offset) <= 2 * (int64_t)decim) r.hits++;
+                        else                                                  r.false_hits++;
+                    }
+
+                    if (before == gr::lora::DecoderState::SYNC && after == gr::lora::DecoderState::PAUSE && frame < frames) {
+                        r.synced++;
+                        decoder.reset();
+                        pos = ends[frame];
+                    }
+                });
+
+                results.push_back(r);
+            }
+        }
+    }
+}
+
+static std::string to_hex(const uint8_t *bytes, const uint32_t len) {
+    std::ostringstream out;
+    char hex[4];
+
+    for (uint32_t i = 0u; i < len; i++) {
+        std::snprintf(hex, sizeof(hex), i ? " %02x" : "%02x", bytes[i]);
+        out << hex;
+    }
+
+    return out.str();
+}
+
+static void captures(const char *xml, const double samp_rate, std::vector<result> &results) {
+    boost::property_tree::ptree tree;
+
+    try {
+        boost::property_tree::read_xml(xml, tree);
+    } catch (const boost::property_tree::xml_parser_error &e) {
+        std::fprintf(stderr, "Skipping %s: %s\n", xml, e.what());
+        return;
+    }
+
+    const std::string dir = std::string(xml).substr(0u, std::string(xml).find_last_of('/') + 1u);
+
+    for (const auto &test : tree.get_child("lora-test-data")) {
+        if (test.first != "TEST")
+            continue;
+
+        const std::string file     = test.second.get<std::string>("file", "");
+        const uint32_t    sf       = test.second.get<uint32_t>("spreading-factor", 7u);
+        const std::string expected = test.second.get<std::string>("expected-data-only", "");
+        const uint32_t    times    = test.second.get<uint32_t>("expected-times", 0u);
+
+        // As given, relative to the XML, or in `lora-samples` next to the XML
+        std::string path;
+        for (const std::string &candidate : { file, dir + file, dir + "lora-samples/" + file.substr(file.find_last_of('/') + 1u) }) {
+            if (std::ifstream(candidate.c_str()).good()) {
+                path = candidate;
+                break;
+            }
+        }
+
+        if (path.empty()) {
+            std::fprintf(stderr, "Skipping TEST %s: %s does not exist\n", test.second.get<std::string>("<xmlattr>.id", "?").c_str(), file.c_str());
+            continue;
+        }
+
+        // Captured at 868.0 MHz, transmitted at 868.1 MHz
+        const std::vector<gr_complex> samples = channelize(read_capture(path), samp_rate, 100e3);
+
+        for (uint32_t m = 0u; m < 3u; m++) {
+            if (methods[m] == PreambleDetection::EXACT && (sf == 6u || sf > max_exact_sf))
+                continue;
+
+            gr::lora::phy_decoder decoder(samp_rate, sf, "fft", false);
+            decoder.set_preamble_detection(methods[m]);
+
+            result r = { path.substr(path.find_last_of('/') + 1u) + " " + method_names[m], samples.size() / samp_rate, 0.0, 0u, 0u, 0u, times };
+
+            decoder.set_frame_callback([&](const uint8_t *bytes, const uint32_t len, const gr::lora::frame_info &) {
+                if (len > 3u && to_hex(bytes + 3u, len - 3u).compare(0u, expected.size(), expected) == 0)
+                    r.hits++;
+            });
+
+            r.detect_cpu = run(decoder, samples, [](gr::lora::DecoderState, gr::lora::DecoderState, uint64_t &) {});
+            results.push_back(r);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const double samp_rate = 1e6;
+    std::vector<result> synthetic_results, capture_results;
+
+    synthetic(samp_rate, synthetic_results);
+
+    for (int i = 1; i < argc; i++)
+        captures(argv[i], samp_rate, capture_results);
+
+    std::printf("\n%-28s %10s %14s %10s %8s %8s\n", "Synthetic", "signal s", "DETECT cpu ms", "detected", "false", "synced");
+    for (const result &r : synthetic_results)
+        std::printf("%-28s %10.2f %14.2f %6u/%-3u %8u %5u/%-3u\n",
+                    r.name.c_str(), r.seconds, r.detect_cpu * 1e3, r.hits, r.total, r.false_hits, r.synced, r.total);
+
+    if (!capture_results.empty()) {
+        std::printf("\n%-48s %10s %14s %10s\n", "Capture", "signal s", "DETECT cpu ms", "decoded");
+        for (const result &r : capture_results)
+            std::printf("%-48s %10.2f %14.2f %6u/%-3u\n",
+                        r.name.c_str(), r.seconds, r.detect_cpu * 1e3, r.hits, r.total);
+    }
+
+    return 0;
+}
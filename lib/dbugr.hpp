@@ -24,17 +24,16 @@
 #include <stdio.h>
 #include <string.h>
 #include <chrono>
+#include <fstream>
 
 #include "utilities.h"
 
 #define CLAMP_VAL   0.7e6f  //1000000.0f  //0.7f
 
-#undef NDEBUG            /// Debug printing
-//#define NDEBUG           /// No debug printing
-
+//#define DBGR_PLOT        /// Plot and dump signals, pausing in between (runtime logging lives in trace.h)
 //#define DBGR_CHRONO      /// Measure execution time
 
-#ifdef NDEBUG
+#ifndef DBGR_PLOT
     #define DBGR_PAUSE(MSG)
     #define DBGR_QUICK_TO_FILE(FILEPATH, APPEND, DATA, SIZE, FORMAT)
     #define DBGR_WRITE_SIGNAL(IDEAL_SIG_FP, SAMPLE_SIG_FP, WINDOW, OFFSET, MIN, MAX, FULL, PAUSE, MSG)
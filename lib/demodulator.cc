@@ -0,0 +1,208 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include "demodulator.h"
+#include "kernels.h"
+#include "trace.h"
+
+//#define PLOT_BINS   // Uncomment to visualize the bins of `gradient_demodulator`
+
+#ifdef PLOT_BINS
+    #define DBGR_PLOT
+    #include "dbugr.hpp"
+#endif
+
+namespace gr {
+    namespace lora {
+
+        gradient_demodulator::gradient_demodulator(const uint32_t samples_per_symbol, const uint32_t number_of_bins)
+            : d_samples_per_symbol(samples_per_symbol),
+              d_number_of_bins(number_of_bins),
+              d_decim_factor(samples_per_symbol / number_of_bins) {
+            this->d_workspace.allocate(workspace::bytes_for<float>(samples_per_symbol));
+            this->d_ifreq = this->d_workspace.take<float>(samples_per_symbol);
+        }
+
+        uint32_t gradient_demodulator::demodulate(const gr_complex *samples, const bool is_header) {
+            float *samples_ifreq = this->d_ifreq;
+
+            gr::lora::kernels::instantaneous_frequency(samples, samples_ifreq, this->d_samples_per_symbol);
+
+            /*** Visualize bins in plot ******************************************/
+            #ifdef PLOT_BINS
+                uint32_t gradbins  = this->d_number_of_bins;
+                uint32_t graddecim = this->d_decim_factor;
+                if (is_header) {
+                    gradbins  /= 4u;
+                    graddecim *= 4u;
+                }
+
+                printf("Bins: %d, len: %d\n", gradbins, graddecim);
+                float samples_bins[this->d_samples_per_symbol];
+                for (uint32_t i = 0u; i < this->d_samples_per_symbol; i++) {
+                    samples_bins[i] = i % (graddecim * 2u) == 0u ? 0.5f : i % graddecim == 0u ? -0.5f : 0.0f;
+                }
+
+                DBGR_WRITE_SIGNAL(samples_bins, samples_ifreq, this->d_samples_per_symbol, 0, 0, this->d_samples_per_symbol, false, false, Printed bins in freq_grad_idx);
+
+            #endif
+            /*********************************************************************/
+
+            for (uint32_t i = 1u; i < this->d_number_of_bins - 2u; i++) {
+                if (samples_ifreq[this->d_decim_factor * i] - samples_ifreq[this->d_decim_factor * (i + 1u)] > 0.2f) {
+                    #ifdef PLOT_BINS
+                        printf("[Freq_Grad] Down on idx: %4d in bin %4d (in [%4d, %4d])\n",
+                               this->d_decim_factor * i,
+                               is_header ? (i + !is_header) / 4u : (i + !is_header),
+                               graddecim * (is_header ? i / 4u : i),
+                               graddecim * ((is_header ? i / 4u : i) + 1u));
+                        DBGR_PAUSE();
+                    #endif
+                    return i + !is_header;
+                }
+            }
+
+            const float zero_bin = samples_ifreq[0u] - samples_ifreq[this->d_decim_factor * 2u];
+            const float high_bin = samples_ifreq[(this->d_number_of_bins - 2u) * this->d_decim_factor] - samples_ifreq[this->d_number_of_bins * this->d_decim_factor - 1u];
+
+            #ifdef PLOT_BINS
+                if (zero_bin > 0.2f || zero_bin > high_bin)
+                    printf("[Freq_Grad] Down on idx: %4d in bin %4d (at %4d)\n", 0, 0, 1);
+                else
+                    printf("[Freq_Grad] Down on idx: %4d in bin %4d (at %4d)\n",
+                           this->d_decim_factor * (this->d_number_of_bins - 1u),
+                           this->d_number_of_bins,
+                           this->d_decim_factor * this->d_number_of_bins);
+                DBGR_PAUSE();
+            #endif
+
+            // Prefer first bin over last. (First bin == 0 or 1?)
+            return zero_bin > 0.2f || zero_bin > high_bin
+                    ? 1u : this->d_number_of_bins;
+        }
+
+        size_t gradient_demodulator::memory_footprint() const {
+            return sizeof(*this) + this->d_workspace.size();
+        }
+
+        fft_demodulator::fft_demodulator(const uint32_t samples_per_symbol, const uint32_t number_of_bins, const gr_complex *downchirp_conj)
+            : d_samples_per_symbol(samples_per_symbol),
+              d_number_of_bins(number_of_bins),
+              d_downchirp_conj(downchirp_conj) {
+            this->d_workspace.allocate(workspace::bytes_for<gr_complex>(samples_per_symbol)     // d_mult_hf
+                                     + workspace::bytes_for<gr_complex>(samples_per_symbol)     // d_fft
+                                     + workspace::bytes_for<gr_complex>(number_of_bins)         // d_tmp
+                                     + workspace::bytes_for<float>(number_of_bins));            // d_fft_mag
+
+            this->d_mult_hf = this->d_workspace.take<gr_complex>(samples_per_symbol);
+            this->d_fft     = this->d_workspace.take<gr_complex>(samples_per_symbol);
+            this->d_tmp     = this->d_workspace.take<gr_complex>(number_of_bins);
+            this->d_fft_mag = this->d_workspace.take<float>(number_of_bins);
+
+            this->d_q = fft_create_plan(samples_per_symbol, this->d_mult_hf, this->d_fft, LIQUID_FFT_FORWARD, 0);
+        }
+
+        fft_demodulator::~fft_demodulator() {
+            fft_destroy_plan(this->d_q);
+        }
+
+        uint32_t fft_demodulator::demodulate(const gr_complex *samples, const bool is_header) {
+            // Multiply with ideal downchirp
+            gr::lora::kernels::dechirp(this->d_mult_hf, samples, this->d_downchirp_conj, this->d_samples_per_symbol);
+
+            // Perform FFT
+            fft_execute(this->d_q);
+
+            // Decimate. Note: assumes fft size is multiple of decimation factor and number of bins is even
+            const uint32_t N = this->d_number_of_bins;
+            memcpy(&this->d_tmp[0],               &this->d_fft[0],                                     (N + 1u) / 2u * sizeof(gr_complex));
+            memcpy(&this->d_tmp[ (N + 1u) / 2u ], &this->d_fft[this->d_samples_per_symbol - (N / 2u)],        N / 2u * sizeof(gr_complex));
+            this->d_tmp[N / 2u] += this->d_fft[N / 2u];
+
+            const uint32_t bin = gr::lora::kernels::argmax_magnitude(this->d_tmp, this->d_fft_mag, N);
+
+            // Match `gradient_demodulator`: bin 0 is the last bin, and HDR bins are one lower
+            return (bin == 0u ? N : bin) - is_header;
+        }
+
+        size_t fft_demodulator::memory_footprint() const {
+            // Not counted: the liquid-dsp FFT plan
+            return sizeof(*this) + this->d_workspace.size();
+        }
+
+        /**
+         *  Return the average time in seconds `demod` takes on `symbol`,
+         *  or a negative value if it does not demodulate it to `expected`.
+         */
+        static double time_demodulator(demodulator &demod, const gr_complex *symbol, const uint32_t expected) {
+            if (demod.demodulate(symbol, false) != expected)
+                return -1.0;
+
+            // At least 3 runs, and enough to cover about a millisecond
+            uint32_t runs = 0u;
+            const auto start = std::chrono::steady_clock::now();
+            auto now = start;
+
+            for (; runs < 3u || now - start < std::chrono::milliseconds(1); runs++) {
+                demod.demodulate(symbol, false);
+                now = std::chrono::steady_clock::now();
+            }
+
+            return std::chrono::duration<double>(now - start).count() / runs;
+        }
+
+        std::unique_ptr<demodulator> demodulator::make(const std::string &strategy,
+                                                       const uint32_t samples_per_symbol,
+                                                       const uint32_t number_of_bins,
+                                                       const gr_complex *downchirp_conj,
+                                                       const gr_complex *upchirp) {
+            if (strategy == "gradient")
+                return std::unique_ptr<demodulator>(new gradient_demodulator(samples_per_symbol, number_of_bins));
+
+            if (strategy == "fft")
+                return std::unique_ptr<demodulator>(new fft_demodulator(samples_per_symbol, number_of_bins, downchirp_conj));
+
+            if (strategy != "auto")
+                throw std::invalid_argument("[LoRa Decoder] ERROR : Unknown demodulator \"" + strategy + "\", expected \"gradient\", \"fft\" or \"auto\".");
+
+            std::unique_ptr<demodulator> gradient(new gradient_demodulator(samples_per_symbol, number_of_bins));
+            std::unique_ptr<demodulator> fft(new fft_demodulator(samples_per_symbol, number_of_bins, downchirp_conj));
+
+            // The ideal upchirp is symbol 0, i.e. the last bin
+            const double t_gradient = time_demodulator(*gradient, upchirp, number_of_bins);
+            const double t_fft      = time_demodulator(*fft,      upchirp, number_of_bins);
+
+            const bool use_fft = t_fft >= 0.0 && (t_gradient < 0.0 || t_fft < t_gradient);
+
+            LORA_TRACE(DEMOD, INFO, "Demodulation: gradient " << t_gradient * 1e3 << " ms, fft " << t_fft * 1e3
+                                    << " ms => " << (use_fft ? "fft" : "gradient"));
+
+            return use_fft ? std::move(fft) : std::move(gradient);
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
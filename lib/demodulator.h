@@ -0,0 +1,137 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DEMODULATOR_H
+#define DEMODULATOR_H
+
+#include <liquid/liquid.h>
+#include "lora_complex.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "workspace.h"
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Demodulator** : Strategy to find the bin of a HDR or payload symbol.
+         *          <BR>Use `make` to create one by name: "gradient", "fft" or "auto".
+         */
+        class demodulator {
+            public:
+                virtual ~demodulator() {}
+
+                /**
+                 *  \brief  Return the bin of the given symbol, in `[1, number_of_bins]` for the payload.
+                 *          <BR>The HDR bin still needs to be divided by 4.
+                 *
+                 *  \param  samples
+                 *          The complex symbol to demodulate, `samples_per_symbol` long.
+                 *  \param  is_header
+                 *          Whether the given symbol is part of a HDR.
+                 */
+                virtual uint32_t demodulate(const gr_complex *samples, const bool is_header) = 0;
+
+                /**
+                 *  \brief  Return the name the strategy is selected with.
+                 */
+                virtual const char *name() const = 0;
+
+                /**
+                 *  \brief  Return the memory used by this instance in bytes.
+                 */
+                virtual size_t memory_footprint() const = 0;
+
+                /**
+                 *  \brief  Create the demodulator with the given name.
+                 *          <BR>"auto" times every strategy on the ideal upchirp and keeps the fastest
+                 *          of the ones demodulating it correctly.
+                 *
+                 *  \param  strategy
+                 *          "gradient", "fft" or "auto".
+                 *  \param  samples_per_symbol
+                 *          The amount of samples in one symbol.
+                 *  \param  number_of_bins
+                 *          The amount of bins in a payload symbol, `2^SF`.
+                 *  \param  downchirp_conj
+                 *          The complex conjugate of the ideal downchirp, kept by pointer.
+                 *  \param  upchirp
+                 *          The ideal upchirp, only used by "auto".
+                 */
+                static std::unique_ptr<demodulator> make(const std::string &strategy,
+                                                         const uint32_t samples_per_symbol,
+                                                         const uint32_t number_of_bins,
+                                                         const gr_complex *downchirp_conj,
+                                                         const gr_complex *upchirp);
+        };
+
+        /**
+         *  \brief  Find the falling edge in the instantaneous frequency of the symbol.
+         */
+        class gradient_demodulator : public demodulator {
+            private:
+                uint32_t   d_samples_per_symbol;    ///< The amount of samples in one symbol.
+                uint32_t   d_number_of_bins;        ///< The amount of bins in a payload symbol.
+                uint32_t   d_decim_factor;          ///< The amount of samples (data points) in each bin.
+
+                workspace  d_workspace;             ///< Holds `d_ifreq`.
+                float     *d_ifreq;                 ///< Instantaneous frequency of the symbol.
+
+            public:
+                gradient_demodulator(const uint32_t samples_per_symbol, const uint32_t number_of_bins);
+
+                uint32_t    demodulate(const gr_complex *samples, const bool is_header);
+                const char *name() const { return "gradient"; }
+                size_t      memory_footprint() const;
+        };
+
+        /**
+         *  \brief  Dechirp the symbol and return the FFT bin with the highest magnitude.
+         */
+        class fft_demodulator : public demodulator {
+            private:
+                uint32_t          d_samples_per_symbol; ///< The amount of samples in one symbol.
+                uint32_t          d_number_of_bins;     ///< The amount of bins in a payload symbol.
+                const gr_complex *d_downchirp_conj;     ///< The complex conjugate of the ideal downchirp.
+
+                workspace   d_workspace;                ///< Holds every buffer below.
+                gr_complex *d_mult_hf;                  ///< The dechirped symbol, input of the FFT.
+                gr_complex *d_fft;                      ///< Array containing the FFT results.
+                gr_complex *d_tmp;                      ///< The FFT decimated to `number_of_bins` bins.
+                float      *d_fft_mag;                  ///< Magnitudes of the decimated bins.
+
+                fftplan     d_q;                        ///< The LiquidDSP::FFT_Plan.
+
+            public:
+                fft_demodulator(const uint32_t samples_per_symbol, const uint32_t number_of_bins, const gr_complex *downchirp_conj);
+                ~fft_demodulator();
+
+                fft_demodulator(const fft_demodulator&)            = delete;
+                fft_demodulator& operator=(const fft_demodulator&) = delete;
+
+                uint32_t    demodulate(const gr_complex *samples, const bool is_header);
+                const char *name() const { return "fft"; }
+                size_t      memory_footprint() const;
+        };
+    } // namespace lora
+} // namespace gr
+
+#endif /* DEMODULATOR_H */
@@ -0,0 +1,437 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include "frame_decoder.h"
+#include "tables.h"
+#include "utilities.h"
+#include "trace.h"
+
+namespace gr {
+    namespace lora {
+
+        frame_decoder::frame_decoder(uint8_t sf, const uint8_t *whitening_sequence, bool threaded)
+            : d_sf(sf),
+              d_whitening_sequence(whitening_sequence),
+              d_crc_check(CrcCheck::FLAG),
+              d_crc_failures(0u),
+              d_in_frame(false),
+              d_cr(4u),
+              d_payload_length(0u),
+              d_info(),
+              d_threaded(false),
+              d_running(false),
+              d_sleeping(false),
+              d_pushed(0u),
+              d_handled(0u) {
+            // The largest frame (255 bytes at CR 4/8) deinterleaves to about 520 words
+            this->d_demodulated.reserve(1024u);
+            this->d_decoded.resize(1024u);
+            this->d_data.reserve(3u + 1024u);
+
+            this->set_threaded(threaded);
+        }
+
+        frame_decoder::~frame_decoder() {
+            this->set_threaded(false);
+        }
+
+        void frame_decoder::set_threaded(const bool threaded) {
+            if (threaded == this->d_threaded)
+                return;
+
+            if (threaded) {
+                this->d_running = true;
+                this->d_worker  = std::thread(&frame_decoder::run, this);
+            } else {
+                // The worker empties the queue before it returns, the frame state is ours after the join
+                this->d_running = false;
+                {
+                    std::lock_guard<std::mutex> lock(this->d_mutex);
+                    this->d_wakeup.notify_one();
+                }
+                this->d_worker.join();
+            }
+
+            this->d_threaded = threaded;
+        }
+
+        void frame_decoder::push(const job &j) {
+            if (!this->d_threaded) {
+                this->handle(j);
+                return;
+            }
+
+            while (!this->d_queue.push(j)) {
+                std::this_thread::yield();
+            }
+            this->d_pushed++;
+
+            // Pairs with the fence in `run`: either the worker sees the new job, or we see it sleeping
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (this->d_sleeping.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(this->d_mutex);
+                this->d_wakeup.notify_one();
+            }
+        }
+
+        void frame_decoder::run() {
+            job j;
+
+            for (;;) {
+                while (this->d_queue.pop(j)) {
+                    this->handle(j);
+                    this->d_handled.fetch_add(1u, std::memory_order_release);
+                }
+
+                std::unique_lock<std::mutex> lock(this->d_mutex);
+                this->d_sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                this->d_wakeup.wait(lock, [this] {
+                    return this->d_queue.read_available() > 0u || !this->d_running;
+                });
+                this->d_sleeping.store(false, std::memory_order_relaxed);
+
+                if (!this->d_running && this->d_queue.read_available() == 0u)
+                    return;
+            }
+        }
+
+        void frame_decoder::handle(const job &j) {
+            switch (j.type) {
+                case job::FRAME_START: {
+                    this->d_in_frame       = true;
+                    this->d_cr             = j.info.cr;
+                    this->d_payload_length = j.info.length;
+                    this->d_info           = j.info;
+                    this->d_info.sf        = this->d_sf;
+
+                    this->d_data.clear();
+                    this->d_demodulated.clear();
+
+                    for (uint32_t i = 0u; i < 3u; i++)
+                        this->d_data.push_back((uint8_t)j.words[i]);
+
+                    for (uint32_t i = 3u; i < j.count; i++)
+                        this->d_demodulated.push_back((uint8_t)j.words[i]);
+                    break;
+                }
+
+                case job::BLOCK: {
+                    if (!this->d_in_frame)
+                        break;
+
+                    uint32_t words[12];
+                    uint8_t  deinterleaved[16];
+
+                    std::copy(j.words, j.words + j.count, words);
+                    frame_decoder::deinterleave(words, j.count, this->d_sf, deinterleaved);
+
+                    this->d_demodulated.insert(this->d_demodulated.end(), deinterleaved, deinterleaved + this->d_sf);
+                    break;
+                }
+
+                case job::FRAME_END: {
+                    this->d_info.end_index = j.info.end_index;
+                    this->d_info.end_time  = j.info.end_time;
+
+                    if (this->d_in_frame)
+                        this->finish_frame();
+
+                    this->d_in_frame = false;
+                    break;
+                }
+
+                case job::FRAME_ABORT: {
+                    this->d_in_frame = false;
+                    break;
+                }
+            }
+        }
+
+        void frame_decoder::finish_frame() {
+            const uint32_t len = this->d_demodulated.size();
+
+            if (gr::lora::trace::enabled(gr::lora::trace::FRAME, gr::lora::trace::VERBOSE)) {
+                gr::lora::trace::line out(gr::lora::trace::FRAME, gr::lora::trace::VERBOSE);
+                out << "Deshuffled: ";
+
+                for (uint32_t i = 0u; i < len; i++) {
+                    uint8_t deshuffled;
+                    frame_decoder::deshuffle(&this->d_demodulated[i], 1u, &deshuffled);
+                    out << gr::lora::to_bin(deshuffled, 8u);
+                }
+            }
+
+            uint8_t *decoded = &this->d_decoded[0];
+            memset(decoded, 0u, (this->d_payload_length + 2u) * sizeof(uint8_t));
+
+            frame_decoder::decode_codewords(&this->d_demodulated[0], std::min(len, 2u * (uint32_t)this->d_decoded.size()),
+                                            this->d_whitening_sequence, this->d_cr, decoded);
+
+            // The CRC follows the payload, LSB first, if the HDR announced one
+            const CrcCheck check = this->d_crc_check.load(std::memory_order_relaxed);
+            this->d_info.crc_checked = check != CrcCheck::OFF && this->d_info.has_crc;
+            this->d_info.crc_ok      = false;
+
+            if (this->d_info.crc_checked) {
+                const uint16_t received = (uint16_t)(decoded[this->d_payload_length] | decoded[this->d_payload_length + 1u] << 8u);
+                this->d_info.crc_ok = received == gr::lora::payload_crc(decoded, this->d_payload_length);
+
+                if (!this->d_info.crc_ok) {
+                    this->d_crc_failures.fetch_add(1u, std::memory_order_relaxed);
+                    LORA_TRACE(FRAME, INFO, "CRC mismatch, received " << std::hex << received << ", expected "
+                                            << gr::lora::payload_crc(decoded, this->d_payload_length));
+
+                    // Rejected before any formatting or publishing
+                    if (check == CrcCheck::DROP)
+                        return;
+                }
+            }
+
+            // Only formatted when traced, the frame itself goes to the callback
+            if (gr::lora::trace::enabled(gr::lora::trace::FRAME, gr::lora::trace::INFO)) {
+                gr::lora::trace::line result(gr::lora::trace::FRAME, gr::lora::trace::INFO);
+
+                for (uint32_t i = 0u; i < 3u; i++) {
+                    result << " " << std::hex << std::setw(2) << std::setfill('0') << (int)this->d_data[i];
+                }
+                for (uint32_t i = 0u; i < this->d_payload_length; i++) {
+                    result << " " << std::hex << std::setw(2) << std::setfill('0') << (int)decoded[i];
+                }
+                if (this->d_info.crc_checked && !this->d_info.crc_ok)
+                    result << " (CRC mismatch)";
+            }
+
+            this->d_data.insert(this->d_data.end(), decoded, decoded + this->d_payload_length);
+
+            if (this->d_frame_callback) {
+                this->d_frame_callback(&this->d_data[0], this->d_payload_length + 3u, this->d_info);
+            }
+        }
+
+        void frame_decoder::start_frame(const uint8_t *hdr, const uint8_t *leftover, const uint32_t leftover_len, const frame_info &info) {
+            job j;
+            j.type   = job::FRAME_START;
+            j.count  = (uint8_t)(3u + std::min(leftover_len, 9u));
+            j.info   = info;
+
+            for (uint32_t i = 0u; i < 3u; i++)
+                j.words[i] = hdr[i];
+
+            for (uint32_t i = 3u; i < j.count; i++)
+                j.words[i] = leftover[i - 3u];
+
+            this->push(j);
+        }
+
+        void frame_decoder::add_block(const uint32_t *words, const uint32_t count) {
+            job j;
+            j.type  = job::BLOCK;
+            j.count = (uint8_t)std::min(count, 12u);
+
+            for (uint32_t i = 0u; i < j.count; i++)
+                j.words[i] = (uint16_t)words[i];
+
+            this->push(j);
+        }
+
+        void frame_decoder::end_frame(const uint64_t end_index, const int64_t end_time) {
+            job j;
+            j.type  = job::FRAME_END;
+            j.count = 0u;
+            j.info.end_index = end_index;
+            j.info.end_time  = end_time;
+
+            this->push(j);
+        }
+
+        void frame_decoder::abort_frame() {
+            job j;
+            j.type  = job::FRAME_ABORT;
+            j.count = 0u;
+
+            this->push(j);
+        }
+
+        void frame_decoder::flush() {
+            if (!this->d_threaded)
+                return;
+
+            while (this->d_handled.load(std::memory_order_acquire) < this->d_pushed) {
+                std::this_thread::yield();
+            }
+        }
+
+        void frame_decoder::set_frame_callback(const frame_callback& callback) {
+            this->d_frame_callback = callback;
+        }
+
+        void frame_decoder::set_crc_check(const CrcCheck check) {
+            this->d_crc_check.store(check, std::memory_order_relaxed);
+        }
+
+        bool frame_decoder::parse_crc_check(const std::string &name, CrcCheck &check) {
+            if (name == "off")  { check = CrcCheck::OFF;  return true; }
+            if (name == "flag") { check = CrcCheck::FLAG; return true; }
+            if (name == "drop") { check = CrcCheck::DROP; return true; }
+
+            return false;
+        }
+
+        size_t frame_decoder::memory_footprint() const {
+            return sizeof(*this)
+                 + this->d_demodulated.capacity()
+                 + this->d_decoded.capacity()
+                 + this->d_data.capacity();
+        }
+
+        void frame_decoder::deinterleave(const uint32_t *words, const uint32_t count, const uint32_t ppm, uint8_t *out_words) {
+            if (count > 8u) {
+                // Not sure if this can ever occur. It would imply coding rate high than 4/8 e.g. 4/9.
+                std::cerr << "[LoRa Decoder] WARNING : Deinterleaver: More than 8 bits per word. uint8_t will not be sufficient!\nBytes need to be stored in intermediate array and then packed into words_deinterleaved!" << std::endl;
+            }
+
+            // Row `i` holds the rotated word `i`: its low 8 bits in `low`, the (at most 4) others in `high`
+            uint64_t low = 0u, high = 0u;
+
+            for (uint32_t i = 0u; i < std::min(count, 8u); i++) {
+                const uint64_t word = gr::lora::rotl(words[i], i, ppm);
+
+                low  |= (word & 0xffu) << (8u * i);
+                high |= (word >> 8u)   << (8u * i);
+            }
+
+            // Column `x` becomes row `x`: output word `x`, with bit `i` from word `i`
+            low  = gr::lora::transpose_8x8(low);
+            high = gr::lora::transpose_8x8(high);
+
+            for (uint32_t x = 0u; x < ppm; x++)
+                out_words[x] = (uint8_t)((x < 8u ? low >> (8u * x) : high >> (8u * (x - 8u))) & 0xffu);
+        }
+
+        void frame_decoder::deinterleave_generic(const uint32_t *words, const uint32_t count, const uint32_t ppm, uint8_t *out_words) {
+            const uint32_t offset_start = ppm - 1u;
+
+            memset(out_words, 0u, ppm * sizeof(uint8_t));
+
+            for (uint32_t i = 0u; i < count; i++) {
+                const uint32_t word = gr::lora::rotl(words[i], i, ppm);
+
+                for (uint32_t j = (1u << offset_start), x = offset_start; j; j >>= 1u, x--) {
+                    out_words[x] |= !!(word & j) << i;
+                }
+            }
+        }
+
+        void frame_decoder::deshuffle(const uint8_t *words, const uint32_t len, uint8_t *out_words) {
+            static const uint8_t shuffle_pattern[] = {7, 6, 3, 4, 2, 1, 0, 5};
+            uint8_t result;
+
+            for (uint32_t i = 0u; i < len; i++) {
+                result = 0u;
+
+                for (uint32_t j = 0u; j < sizeof(shuffle_pattern); j++) {
+                    result |= !!(words[i] & (1u << shuffle_pattern[j])) << j;
+                }
+
+                out_words[i] = result;
+            }
+        }
+
+        void frame_decoder::dewhiten(const uint8_t *words, const uint32_t len, const uint8_t *prng, uint8_t *out_words) {
+            uint32_t i = 0u;
+
+            // TODO: reverse bit order is performed here,
+            //       but is probably due to mistake in whitening or interleaving
+            for (; i + 8u <= len; i += 8u) {
+                uint64_t w, p;
+                memcpy(&w, words + i, sizeof(w));
+                memcpy(&p, prng + i,  sizeof(p));
+
+                w = gr::lora::bit_reverse_bytes(w ^ p);
+                memcpy(out_words + i, &w, sizeof(w));
+            }
+
+            for (; i < len; i++) {
+                uint8_t xor_b = words[i] ^ prng[i];
+
+                xor_b = (xor_b & 0xF0) >> 4 | (xor_b & 0x0F) << 4;
+                xor_b = (xor_b & 0xCC) >> 2 | (xor_b & 0x33) << 2;
+                xor_b = (xor_b & 0xAA) >> 1 | (xor_b & 0x55) << 1;
+                out_words[i] = xor_b;
+            }
+        }
+
+        void frame_decoder::hamming_decode(const uint8_t *words, const uint32_t len, const uint8_t cr, uint8_t *out_data) {
+            static const uint8_t data_indices[4] = {1, 2, 3, 5};
+
+            switch(cr) {
+                case 4: case 3: // Hamming(8,4) or Hamming(7,4)
+                    gr::lora::hamming_decode_soft(words, len, out_data);
+                    break;
+                case 2: case 1: // Hamming(6,4) or Hamming(5,4)
+                    // TODO: Report parity error to the user
+                    gr::lora::fec_extract_data_only(words, len, data_indices, 4u, out_data);
+                    break;
+            }
+        }
+
+        void frame_decoder::decode_codewords(const uint8_t *words, const uint32_t len, const uint8_t *prng, const uint8_t cr, uint8_t *out_data) {
+            const uint8_t *fec = cr >= 3u ? gr::lora::hamming_decode_lut : gr::lora::fec_data_lut;
+            uint32_t i = 0u;
+
+            for (; i + 8u <= len; i += 8u) {
+                uint64_t w, p;
+                uint8_t  x[8];
+                memcpy(&w, words + i, sizeof(w));
+                memcpy(&p, prng + i,  sizeof(p));
+
+                w ^= p;
+                memcpy(x, &w, sizeof(w));
+
+                for (uint32_t j = 0u; j < 8u; j += 2u)
+                    out_data[(i + j) / 2u] = (uint8_t)(fec[x[j + 1u]] << 4u | fec[x[j]]);
+            }
+
+            for (; i + 1u < len; i += 2u)
+                out_data[i / 2u] = (uint8_t)(fec[words[i + 1u] ^ prng[i + 1u]] << 4u | fec[words[i] ^ prng[i]]);
+
+            if (len & 1u)
+                out_data[len / 2u] = fec[words[len - 1u] ^ prng[len - 1u]];
+        }
+
+        void frame_decoder::nibble_reverse(uint8_t *out_data, const uint32_t len) {
+            for (uint32_t i = 0u; i < len; i++) {
+                out_data[i] = ((out_data[i] & 0x0f) << 4u) | ((out_data[i] & 0xf0) >> 4u);
+            }
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
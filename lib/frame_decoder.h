@@ -0,0 +1,348 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FRAME_DECODER_H
+#define FRAME_DECODER_H
+
+#include <boost/lockfree/spsc_queue.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **CrcCheck** : What to do with the CRC-16 after the payload.
+         *          <BR>OFF: Don't check it.
+         *          <BR>FLAG: Check it, and publish every frame with the result in its `frame_info`.
+         *          <BR>DROP: Check it, and only publish the frames that match.
+         */
+        enum class CrcCheck : uint8_t {
+            OFF,
+            FLAG,
+            DROP
+        };
+
+        /**
+         *  \brief  What was received, where and when, and how well. Published along with the frame's bytes.
+         */
+        struct frame_info {
+            uint8_t  sf;                ///< The spreading factor.
+            uint8_t  cr;                ///< The coding rate from the HDR.
+            uint8_t  length;            ///< The payload length from the HDR.
+            bool     has_crc;           ///< Whether the HDR announced a payload CRC.
+            bool     crc_checked;       ///< Whether the payload CRC was checked, i.e. announced and not `CrcCheck::OFF`.
+            bool     crc_ok;            ///< Whether the payload CRC matched, if checked.
+            float    cfo;               ///< Carrier frequency offset in Hz, estimated on the HDR symbols.
+            float    snr;               ///< SNR in dB, estimated on the HDR symbols from their dechirped peak against the other bins.
+            uint64_t preamble_index;    ///< Stream index of the first sample of the detected preamble.
+            uint64_t end_index;         ///< Stream index right after the last payload symbol.
+            int64_t  end_time;          ///< Wall clock (ns since the epoch) at which the last payload symbol was demodulated.
+        };
+
+        /**
+         *  \brief  **Frame decoder** : The bit pipeline of the payload, from demodulated symbols to frame bytes.
+         *          <BR>1. Deinterleave each block of `4 + CR` symbols
+         *          <BR>2. Deshuffle the words
+         *          <BR>3. Dewhiten the words
+         *          <BR>4. Hamming decoding
+         *          <BR><BR>`phy_decoder` hands over each demodulated block through a lock-free single-producer,
+         *          single-consumer queue. A worker thread runs the pipeline and publishes the frame
+         *          through the callback, so the thread consuming samples never waits on decoding,
+         *          formatting or I/O. Without a worker, every block is decoded when it is pushed.
+         *          <BR>The HDR needs to be decoded before the payload can be demodulated, so `phy_decoder`
+         *          runs the same (static) steps inline for it.
+         */
+        class frame_decoder {
+            public:
+                /**
+                 *  \brief  Called with the HDR and payload bytes of each decoded frame, and where and when it was received.
+                 */
+                typedef std::function<void (const uint8_t *frame_bytes, const uint32_t frame_len, const frame_info &info)> frame_callback;
+
+            private:
+                /**
+                 *  \brief  One entry in the queue. Plain data, so pushing never allocates.
+                 */
+                struct job {
+                    enum : uint8_t { FRAME_START, BLOCK, FRAME_END, FRAME_ABORT };
+
+                    uint8_t    type;
+                    uint8_t    count;     ///< Amount of `words` in use.
+                    uint16_t   words[12]; ///< FRAME_START: the 3 HDR bytes and the deinterleaved words left after it.
+                                          ///< <BR>BLOCK: the `4 + CR` demodulated symbols.
+                    frame_info info;      ///< FRAME_START: everything known from the preamble and HDR.
+                                          ///< <BR>FRAME_END: the end index and time.
+                };
+
+                typedef boost::lockfree::spsc_queue<job, boost::lockfree::capacity<256> > job_queue;
+
+                uint8_t        d_sf;                        ///< The Spreading Factor.
+                const uint8_t *d_whitening_sequence;        ///< The shuffled whitening sequence of the payload for this SF.
+                frame_callback d_frame_callback;            ///< Receiver of the decoded frames.
+                std::atomic<CrcCheck> d_crc_check;          ///< What to do with the payload CRC, read by the worker.
+                std::atomic<uint64_t> d_crc_failures;       ///< Frames whose payload CRC did not match, dropped or not.
+
+                // Only touched by the worker (or by `push` without a worker)
+                bool                  d_in_frame;           ///< Whether a FRAME_START was seen without its end.
+                uint8_t               d_cr;                 ///< The Coding Rate of the current frame.
+                uint32_t              d_payload_length;     ///< The payload length of the current frame.
+                frame_info            d_info;               ///< Where and when the current frame was received.
+                std::vector<uint8_t>  d_demodulated;        ///< Vector containing the words after deinterleaving.
+                std::vector<uint8_t>  d_decoded;            ///< Vector containing the words after Hamming decode.
+                std::vector<uint8_t>  d_data;               ///< The HDR bytes followed by the decoded payload.
+
+                job_queue               d_queue;
+                std::thread             d_worker;
+                bool                    d_threaded;         ///< Whether `d_worker` runs the pipeline.
+                std::atomic<bool>       d_running;
+                std::atomic<bool>       d_sleeping;         ///< Whether the worker is (about to be) waiting on `d_wakeup`.
+                std::mutex              d_mutex;            ///< Only used to sleep and wake up the worker.
+                std::condition_variable d_wakeup;
+                uint64_t                d_pushed;           ///< Jobs pushed, only touched by the producer.
+                std::atomic<uint64_t>   d_handled;          ///< Jobs handled by the worker.
+
+                /**
+                 *  \brief  Hand a job to the worker, or handle it right away without one.
+                 *          <BR>Only waits if the queue is full, i.e. the worker is hundreds of blocks behind.
+                 */
+                void push(const job &j);
+
+                /**
+                 *  \brief  Run the pipeline step for the given job.
+                 */
+                void handle(const job &j);
+
+                /**
+                 *  \brief  Decode the payload of the current frame and publish it.
+                 */
+                void finish_frame();
+
+                /**
+                 *  \brief  The worker thread: handle jobs until stopped and the queue is empty.
+                 */
+                void run();
+
+            public:
+                /**
+                 *  \brief  Default ctor.
+                 *
+                 *  \param  sf
+                 *          The spreading factor of the frames.
+                 *  \param  whitening_sequence
+                 *          The shuffled whitening sequence of the payload (see `payload_whitening_sequence`), kept by pointer.
+                 *  \param  threaded
+                 *          Whether to start a worker thread, or decode in the caller's thread.
+                 */
+                frame_decoder(uint8_t sf, const uint8_t *whitening_sequence, bool threaded);
+
+                frame_decoder(const frame_decoder&)            = delete;
+                frame_decoder& operator=(const frame_decoder&) = delete;
+
+                /**
+                 *  \brief  Default dtor. Decodes whatever is still queued, then stops the worker.
+                 */
+                ~frame_decoder();
+
+                /**
+                 *  \brief  Start a new frame after its HDR has been decoded.
+                 *
+                 *  \param  hdr
+                 *          The 3 decoded HDR bytes, published in front of the payload.
+                 *  \param  leftover
+                 *          The deinterleaved words of the HDR block that belong to the payload.
+                 *  \param  leftover_len
+                 *          Length of said array, at most 9.
+                 *  \param  info
+                 *          The CR, payload length and CRC flag from the HDR, the preamble index, CFO and SNR.
+                 *          <BR>The SF, CRC result, end index and time are filled in later.
+                 */
+                void start_frame(const uint8_t *hdr, const uint8_t *leftover, const uint32_t leftover_len, const frame_info &info);
+
+                /**
+                 *  \brief  Add a block of `4 + CR` demodulated payload symbols to the current frame.
+                 *
+                 *  \param  words
+                 *          The demodulated (gray decoded) symbols.
+                 *  \param  count
+                 *          Length of said array.
+                 */
+                void add_block(const uint32_t *words, const uint32_t count);
+
+                /**
+                 *  \brief  Decode and publish the current frame.
+                 *
+                 *  \param  end_index
+                 *          Stream index right after the last payload symbol.
+                 *  \param  end_time
+                 *          Wall clock (ns since the epoch) at which the last payload symbol was demodulated.
+                 */
+                void end_frame(const uint64_t end_index, const int64_t end_time);
+
+                /**
+                 *  \brief  Drop the current frame, if any.
+                 */
+                void abort_frame();
+
+                /**
+                 *  \brief  Wait until every pushed job has been handled.
+                 */
+                void flush();
+
+                /**
+                 *  \brief  Start a worker thread, or stop it once it has handled every queued job.
+                 *          <BR>Called from the thread pushing the jobs, which decodes them itself without a worker.
+                 */
+                void set_threaded(const bool threaded);
+
+                /**
+                 *  \brief  Set the receiver of the decoded frames. Called from the worker thread, if any.
+                 */
+                void set_frame_callback(const frame_callback& callback);
+
+                /**
+                 *  \brief  Set what to do with the payload CRC of the frames finished from now on.
+                 */
+                void set_crc_check(const CrcCheck check);
+
+                /**
+                 *  \brief  Return the worker thread, e.g. to pin it next to the thread pushing the jobs.
+                 *          <BR>Not joinable without a worker.
+                 */
+                std::thread &worker() { return this->d_worker; }
+
+                /**
+                 *  \brief  Return the amount of frames whose payload CRC did not match.
+                 */
+                uint64_t crc_failures() const { return this->d_crc_failures.load(std::memory_order_relaxed); }
+
+                /**
+                 *  \brief  Parse `"off"`, `"flag"` or `"drop"` into `check`. Returns false, leaving `check` as is, otherwise.
+                 */
+                static bool parse_crc_check(const std::string &name, CrcCheck &check);
+
+                /**
+                 *  \brief  Return the memory used by this instance in bytes.
+                 */
+                size_t memory_footprint() const;
+
+                /**
+                 *  \brief  Correct the interleaving by extracting each column of bits after rotating to the left.
+                 *          <BR>(The words were interleaved diagonally, by rotating we make them straight into columns.)
+                 *          <BR>The rotated words are the rows of a bit matrix, transposed 8x8 bits at a time in a 64-bit word.
+                 *
+                 *  \param  words
+                 *          The demodulated words, one per bit of the output words (`4 + CR`).
+                 *  \param  count
+                 *          Length of said array.
+                 *  \param  ppm
+                 *          The amount of words that were interleaved. Depends on `SF`.
+                 *  \param  out_words
+                 *          The `ppm` deinterleaved words.
+                 */
+                static void deinterleave(const uint32_t *words, const uint32_t count, const uint32_t ppm, uint8_t *out_words);
+
+                /**
+                 *  \brief  `deinterleave` one bit at a time, the reference in `qa_frame_decoder`.
+                 */
+                static void deinterleave_generic(const uint32_t *words, const uint32_t count, const uint32_t ppm, uint8_t *out_words);
+
+                /**
+                 *  \brief  Deshuffle the deinterleaved words.
+                 *
+                 *  \param  words
+                 *          The words to deshuffle.
+                 *  \param  len
+                 *          Length of said array.
+                 *  \param  out_words
+                 *          The deshuffled words.
+                 */
+                static void deshuffle(const uint8_t *words, const uint32_t len, uint8_t *out_words);
+
+                /**
+                 *  \brief  Dewhiten the deshuffled words by XORing with the whitening sequence, 8 words at a time.
+                 *
+                 *  \param  words
+                 *          The words to dewhiten.
+                 *  \param  len
+                 *          Length of said array.
+                 *  \param  prng
+                 *          The whitening sequence to XOR with.
+                 *  \param  out_words
+                 *          The dewhitened words.
+                 */
+                static void dewhiten(const uint8_t *words, const uint32_t len, const uint8_t *prng, uint8_t *out_words);
+
+                /**
+                 *  \brief  Use Hamming to decode the dewhitened words.
+                 *          <BR>- CR 4 or 3: Hamming(8,4) or Hamming(7,4) with parity correction
+                 *          <BR>- CR 2 or 1: Extract data only (can only find parity errors, not correct them)
+                 *
+                 *  \param  words
+                 *          The words to decode.
+                 *  \param  len
+                 *          Length of said array.
+                 *  \param  cr
+                 *          The coding rate.
+                 *  \param  out_data
+                 *          The result after decoding the words, `(len + 1) / 2` bytes.
+                 */
+                static void hamming_decode(const uint8_t *words, const uint32_t len, const uint8_t cr, uint8_t *out_data);
+
+                /**
+                 *  \brief  `deshuffle`, `dewhiten` and `hamming_decode` in one pass, with the lookup tables in `tables.h`.
+                 *          <BR>Dewhitening commutes with deshuffling when the whitening sequence is shuffled as well, so
+                 *          the words are XORed 8 at a time, after which deshuffling, the bit reversal and decoding are one
+                 *          lookup per codeword.
+                 *
+                 *  \param  words
+                 *          The deinterleaved codewords.
+                 *  \param  len
+                 *          Length of said array.
+                 *  \param  prng
+                 *          The shuffled whitening sequence (see `payload_whitening_sequence`), at least `len` long.
+                 *  \param  cr
+                 *          The coding rate.
+                 *  \param  out_data
+                 *          The decoded bytes, `(len + 1) / 2` of them.
+                 */
+                static void decode_codewords(const uint8_t *words, const uint32_t len, const uint8_t *prng, const uint8_t cr, uint8_t *out_data);
+
+                /**
+                 *  \brief  Reverse the nibbles for each byte in the given array.
+                 *          <BR>`MSB LSB` nibbles --> `LSB MSB`
+                 *
+                 *  \param  out_data
+                 *          The array of bytes to reverse the nibbles in.
+                 *  \param  len
+                 *          Length of said array.
+                 */
+                static void nibble_reverse(uint8_t *out_data, const uint32_t len);
+        };
+    } // namespace lora
+} // namespace gr
+
+#endif /* FRAME_DECODER_H */
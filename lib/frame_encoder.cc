@@ -0,0 +1,234 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "frame_encoder.h"
+#include "tables.h"
+#include "utilities.h"
+
+namespace gr {
+    namespace lora {
+
+        frame_encoder::frame_encoder(const float samp_rate, const uint8_t sf, const uint8_t cr)
+            : d_sf(sf),
+              d_cr(cr),
+              d_preamble_length(8u),
+              d_sync_word(0x12u),
+              d_timing_offset(0.0f),
+              d_has_crc(true) {
+            const double bw = 125000.0;
+
+            if (sf < 7u || sf > 12u)
+                throw std::invalid_argument("[LoRa Encoder] ERROR : Spreading factor should be between 7 and 12 (inclusive)!");
+            if (cr < 1u || cr > 4u)
+                throw std::invalid_argument("[LoRa Encoder] ERROR : Coding rate should be between 1 and 4 (inclusive)!");
+            if (samp_rate < bw || std::fmod((double)samp_rate, bw) != 0.0)
+                throw std::invalid_argument("[LoRa Encoder] ERROR : Sample rate should be a multiple of 125 kHz!");
+
+            this->d_number_of_bins     = 1u << sf;
+            this->d_decim_factor       = (uint32_t)(samp_rate / bw);
+            this->d_samples_per_symbol = this->d_number_of_bins * this->d_decim_factor;
+            this->d_whitening_sequence = gr::lora::payload_whitening_sequence(sf, &this->d_whitening_length);
+        }
+
+        void frame_encoder::append_chirp(const uint32_t shift, const bool down, const uint32_t len, double &phase, std::vector<gr_complex> &samples) const {
+            const uint32_t sps   = this->d_samples_per_symbol;
+            const uint32_t start = (shift % this->d_number_of_bins) * this->d_decim_factor;
+
+            // The frequency sweeps BW once per symbol, from -BW/2 and wrapping around. In radians per sample,
+            // taken halfway each sample like the phase of the ideal chirp:
+            const double step = 2.0 * M_PI / ((double)this->d_decim_factor * sps);
+
+            // A delay of `d_timing_offset` samples lags the phase by that fraction of the current frequency
+            for (uint32_t i = 0u; i < len; i++) {
+                const double freq = (((start + i) % sps) - sps / 2.0 + 0.5) * step * (down ? -1.0 : 1.0);
+
+                samples.push_back(std::polar(1.0f, (float)(phase - freq * this->d_timing_offset)));
+                phase = std::fmod(phase + freq, 2.0 * M_PI);
+            }
+        }
+
+        void frame_encoder::encode(const uint8_t *payload, const uint32_t len, std::vector<uint32_t> &symbols) const {
+            const uint32_t sf     = this->d_sf;
+            const uint32_t N      = this->d_number_of_bins;
+            const uint32_t blocks = frame_encoder::payload_symbols(len, this->d_cr, this->d_sf, this->d_has_crc) / (4u + this->d_cr);
+
+            // The HDR block carries `SF - 7` payload words after its own 5
+            const uint32_t words = (sf - 7u) + blocks * sf;
+
+            if (len > 255u || words > this->d_whitening_length)
+                throw std::invalid_argument("[LoRa Encoder] ERROR : Payload longer than the whitening sequence!");
+
+            // Nibbles of the payload and its CRC (LSB first), the low nibble of each byte first. Padded with zeroes.
+            const uint16_t crc = gr::lora::payload_crc(payload, len);
+            std::vector<uint8_t> codewords(words, gr::lora::hamming_encode_soft(0u));
+
+            for (uint32_t i = 0u; i < len + (this->d_has_crc ? 2u : 0u); i++) {
+                const uint8_t byte = i < len ? payload[i] : (uint8_t)(crc >> (8u * (i - len)));
+
+                codewords[2u * i]      = gr::lora::hamming_encode_soft(byte & 0x0fu);
+                codewords[2u * i + 1u] = gr::lora::hamming_encode_soft(byte >> 4u);
+            }
+
+            frame_encoder::whiten(&codewords[0], words, this->d_whitening_sequence, &codewords[0]);
+            frame_encoder::shuffle(&codewords[0], words, &codewords[0]);
+
+            // HDR: the length, the CR with the CRC flag (its MSB flipped, see `phy_decoder::check_header`) and the checksum
+            const uint8_t n2  = (uint8_t)(this->d_cr << 1u | (this->d_has_crc ? 0x01u : 0x00u));
+            const uint8_t chk = gr::lora::header_checksum((uint8_t)(len >> 4u), (uint8_t)(len & 0x0fu), n2);
+            const uint8_t hdr_nibbles[5] = { (uint8_t)(len >> 4u), (uint8_t)(len & 0x0fu), (uint8_t)(n2 ^ 0x08u), (uint8_t)(chk >> 4u), (uint8_t)(chk & 0x0fu) };
+            uint8_t  hdr[12];
+            uint32_t interleaved[8];
+
+            for (uint32_t i = 0u; i < 5u; i++)
+                hdr[i] = gr::lora::hamming_encode_soft(hdr_nibbles[i]);
+
+            frame_encoder::whiten(hdr, 5u, gr::lora::header_whitening_sequence(), hdr);
+            frame_encoder::shuffle(hdr, 5u, hdr);
+
+            for (uint32_t i = 5u; i < sf - 2u; i++)
+                hdr[i] = codewords[i - 5u];
+
+            // The decoder divides the HDR bin by 4 after subtracting 1: aim for the middle of those 4 bins
+            frame_encoder::interleave(hdr, 8u, sf - 2u, interleaved);
+
+            for (uint32_t i = 0u; i < 8u; i++)
+                symbols.push_back(N - 3u - 4u * gr::lora::gray_decode(interleaved[i]));
+
+            // Payload: bin `b` is demodulated from the upchirp shifted by `N - b`
+            const uint32_t count = 4u + this->d_cr;
+
+            for (uint32_t b = 0u; b < blocks; b++) {
+                frame_encoder::interleave(&codewords[(sf - 7u) + b * sf], count, sf, interleaved);
+
+                for (uint32_t i = 0u; i < count; i++)
+                    symbols.push_back((N - gr::lora::gray_decode(interleaved[i])) % N);
+            }
+        }
+
+        void frame_encoder::modulate(const uint8_t *payload, const uint32_t len, std::vector<gr_complex> &samples) const {
+            std::vector<uint32_t> symbols;
+
+            this->encode(payload, len, symbols);
+            samples.reserve(samples.size() + this->frame_samples(len));
+
+            this->modulate(symbols, samples);
+        }
+
+        void frame_encoder::modulate(const std::vector<uint32_t> &symbols, std::vector<gr_complex> &samples) const {
+            const uint32_t sps   = this->d_samples_per_symbol;
+            double         phase = 0.0;
+
+            for (uint32_t i = 0u; i < this->d_preamble_length; i++)
+                this->append_chirp(0u, false, sps, phase, samples);
+
+            // The sync word nibbles, 8 bins apart
+            this->append_chirp((this->d_sync_word >> 4u) * 8u,   false, sps, phase, samples);
+            this->append_chirp((this->d_sync_word & 0x0fu) * 8u, false, sps, phase, samples);
+
+            this->append_chirp(0u, true, sps,      phase, samples);
+            this->append_chirp(0u, true, sps,      phase, samples);
+            this->append_chirp(0u, true, sps / 4u, phase, samples);
+
+            for (const uint32_t s : symbols)
+                this->append_chirp(s, false, sps, phase, samples);
+        }
+
+        uint32_t frame_encoder::frame_samples(const uint32_t len) const {
+            const uint32_t symbols = this->d_preamble_length + 2u + 2u + 8u + frame_encoder::payload_symbols(len, this->d_cr, this->d_sf, this->d_has_crc);
+
+            return symbols * this->d_samples_per_symbol + this->d_samples_per_symbol / 4u;
+        }
+
+        uint32_t frame_encoder::max_payload_length() const {
+            uint32_t len = 255u;
+
+            while (len > 0u && (this->d_sf - 7u) + frame_encoder::payload_symbols(len, this->d_cr, this->d_sf, this->d_has_crc) / (4u + this->d_cr) * this->d_sf > this->d_whitening_length)
+                len--;
+
+            return len;
+        }
+
+        uint32_t frame_encoder::payload_symbols(const uint32_t len, const uint8_t cr, const uint8_t sf, const bool has_crc) {
+            // Same as the DECODE_HEADER state of `phy_decoder`
+            const int symbols_per_block = cr + 4u;
+            const float bits_needed     = float(len) * 8.0f + (has_crc ? 16.0f : 0.0f);
+            const float symbols_needed  = bits_needed * (symbols_per_block / 4.0f) / float(sf);
+            const int blocks_needed     = (int)std::ceil(symbols_needed / symbols_per_block);
+
+            return (uint32_t)(blocks_needed * symbols_per_block);
+        }
+
+        void frame_encoder::interleave(const uint8_t *words, const uint32_t count, const uint32_t ppm, uint32_t *out_symbols) {
+            for (uint32_t i = 0u; i < count; i++) {
+                uint32_t word = 0u;
+
+                for (uint32_t x = 0u; x < ppm; x++)
+                    word |= (uint32_t)((words[x] >> i) & 0x01u) << x;
+
+                // Undo the rotation to the left by `i`
+                out_symbols[i] = gr::lora::rotl(word, ppm - i % ppm, ppm);
+            }
+        }
+
+        void frame_encoder::shuffle(const uint8_t *words, const uint32_t len, uint8_t *out_words) {
+            static const uint8_t shuffle_pattern[] = {7, 6, 3, 4, 2, 1, 0, 5};
+
+            for (uint32_t i = 0u; i < len; i++) {
+                uint8_t result = 0u;
+
+                for (uint32_t j = 0u; j < sizeof(shuffle_pattern); j++) {
+                    result |= !!(words[i] & (1u << j)) << shuffle_pattern[j];
+                }
+
+                out_words[i] = result;
+            }
+        }
+
+        void frame_encoder::whiten(const uint8_t *words, const uint32_t len, const uint8_t *prng, uint8_t *out_words) {
+            uint32_t i = 0u;
+
+            for (; i + 8u <= len; i += 8u) {
+                uint64_t w, p;
+                std::memcpy(&w, words + i, sizeof(w));
+                std::memcpy(&p, prng + i,  sizeof(p));
+
+                w = gr::lora::bit_reverse_bytes(w) ^ p;
+                std::memcpy(out_words + i, &w, sizeof(w));
+            }
+
+            for (; i < len; i++) {
+                uint8_t b = words[i];
+
+                b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+                b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+                b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+                out_words[i] = b ^ prng[i];
+            }
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,168 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FRAME_ENCODER_H
+#define FRAME_ENCODER_H
+
+#include "lora_complex.h"
+#include <cstdint>
+#include <vector>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Frame encoder** : The bit pipeline of `frame_decoder` and `phy_decoder` in reverse, and the chirps to send it with.
+         *          <BR>1. Hamming encoding of every nibble of the payload and its CRC (unless disabled with `set_crc`)
+         *          <BR>2. Whitening
+         *          <BR>3. Shuffling
+         *          <BR>4. Interleaving into blocks of `4 + CR` symbols, Gray mapped to chirps
+         *          <BR><BR>A frame is the preamble (upchirps), the sync word, 2.25 downchirps, the explicit HDR
+         *          (8 symbols at `SF - 2` bits, always CR 4/8) and the payload with its CRC. Every symbol is placed
+         *          where this decoder demodulates it, so an encoded frame round-trips through `phy_decoder`.
+         *          Only meant to generate test signals, at the 125 kHz bandwidth of the decoder.
+         */
+        class frame_encoder {
+            private:
+                uint8_t        d_sf;                        ///< The Spreading Factor.
+                uint8_t        d_cr;                        ///< The coding rate of the payload, 1 to 4 for 4/5 to 4/8.
+                uint32_t       d_samples_per_symbol;        ///< The amount of samples in one symbol.
+                uint32_t       d_number_of_bins;            ///< The amount of bins in a symbol, `2^SF`.
+                uint32_t       d_decim_factor;              ///< The amount of samples in each bin.
+                uint32_t       d_preamble_length;           ///< The amount of upchirps in the preamble.
+                uint8_t        d_sync_word;                 ///< The sync word, one nibble per symbol.
+                const uint8_t *d_whitening_sequence;        ///< The whitening sequence of the payload for this SF.
+                uint32_t       d_whitening_length;          ///< Length of said sequence, which limits the payload length.
+                float          d_timing_offset;             ///< Delay of the samples, as a fraction of a sample.
+                bool           d_has_crc;                   ///< Whether the payload is followed by its CRC, and the HDR says so.
+
+                /**
+                 *  \brief  Append the first `len` samples of the upchirp (or downchirp) starting `shift` bins up.
+                 *          <BR>The phase continues from the previous chirp, like a transmitter's.
+                 */
+                void append_chirp(const uint32_t shift, const bool down, const uint32_t len, double &phase, std::vector<gr_complex> &samples) const;
+
+            public:
+                /**
+                 *  \brief  Default ctor, throws `std::invalid_argument` for an unsupported SF, CR or sample rate.
+                 *
+                 *  \param  samp_rate
+                 *          The sample rate, a multiple of the 125 kHz bandwidth.
+                 *  \param  sf
+                 *          The spreading factor, 7 to 12.
+                 *  \param  cr
+                 *          The coding rate of the payload, 1 to 4 for 4/5 to 4/8.
+                 */
+                frame_encoder(const float samp_rate, const uint8_t sf, const uint8_t cr = 4u);
+
+                /**
+                 *  \brief  Append the symbols of the HDR and payload of a frame, as chirp shifts in `[0, 2^SF)`.
+                 *          <BR>Throws `std::invalid_argument` if the payload is longer than `max_payload_length`.
+                 *
+                 *  \param  payload
+                 *          The payload bytes, without CRC.
+                 *  \param  len
+                 *          Length of said array.
+                 *  \param  symbols
+                 *          The vector to append to.
+                 */
+                void encode(const uint8_t *payload, const uint32_t len, std::vector<uint32_t> &symbols) const;
+
+                /**
+                 *  \brief  Append the samples of a whole frame, with a unit amplitude.
+                 *
+                 *  \param  payload
+                 *          The payload bytes, without CRC.
+                 *  \param  len
+                 *          Length of said array.
+                 *  \param  samples
+                 *          The vector to append to, `frame_samples(len)` longer afterwards.
+                 */
+                void modulate(const uint8_t *payload, const uint32_t len, std::vector<gr_complex> &samples) const;
+
+                /**
+                 *  \brief  Append the samples of a frame with the given HDR and payload symbols, e.g. from `encode` with some corrupted.
+                 *
+                 *  \param  symbols
+                 *          The HDR and payload symbols.
+                 *  \param  samples
+                 *          The vector to append to.
+                 */
+                void modulate(const std::vector<uint32_t> &symbols, std::vector<gr_complex> &samples) const;
+
+                /**
+                 *  \brief  Return the amount of samples of a frame with the given payload length.
+                 */
+                uint32_t frame_samples(const uint32_t len) const;
+
+                /**
+                 *  \brief  Return the longest payload the whitening sequence covers, at most 255 bytes.
+                 */
+                uint32_t max_payload_length() const;
+
+                void set_preamble_length(const uint32_t length) { this->d_preamble_length = length; }
+                void set_sync_word(const uint8_t sync_word)     { this->d_sync_word = sync_word; }
+                void set_crc(const bool has_crc)                { this->d_has_crc = has_crc; }
+
+                /**
+                 *  \brief  Delay the chirps by a fraction of a sample, as if sampled at another instant than the preamble start.
+                 *
+                 *  \param  offset
+                 *          The delay in samples, in `[0, 1)`.
+                 */
+                void set_timing_offset(const float offset)      { this->d_timing_offset = offset; }
+
+                uint32_t samples_per_symbol() const { return this->d_samples_per_symbol; }
+                uint8_t  sf()                 const { return this->d_sf; }
+                uint8_t  cr()                 const { return this->d_cr; }
+
+                /**
+                 *  \brief  Return the amount of payload symbols `phy_decoder` demodulates after a HDR with the given length, CR and CRC flag.
+                 */
+                static uint32_t payload_symbols(const uint32_t len, const uint8_t cr, const uint8_t sf, const bool has_crc);
+
+                /**
+                 *  \brief  The inverse of `frame_decoder::deinterleave`.
+                 *
+                 *  \param  words
+                 *          The `ppm` words to interleave, of which the lowest `count` bits are used.
+                 *  \param  count
+                 *          The amount of symbols to interleave them into (`4 + CR`).
+                 *  \param  ppm
+                 *          The amount of bits per symbol.
+                 *  \param  out_symbols
+                 *          The `count` interleaved words, before Gray mapping.
+                 */
+                static void interleave(const uint8_t *words, const uint32_t count, const uint32_t ppm, uint32_t *out_symbols);
+
+                /**
+                 *  \brief  The inverse of `frame_decoder::deshuffle`.
+                 */
+                static void shuffle(const uint8_t *words, const uint32_t len, uint8_t *out_words);
+
+                /**
+                 *  \brief  The inverse of `frame_decoder::dewhiten`, bit reversal included.
+                 */
+                static void whiten(const uint8_t *words, const uint32_t len, const uint8_t *prng, uint8_t *out_words);
+        };
+    } // namespace lora
+} // namespace gr
+
+#endif /* FRAME_ENCODER_H */
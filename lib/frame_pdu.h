@@ -0,0 +1,72 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FRAME_PDU_H
+#define FRAME_PDU_H
+
+#include <pmt/pmt.h>
+#include <cstdint>
+#include "frame_decoder.h"
+#include "utilities.h"
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  Return the PDU published on the `"frames"` port: a metadata dictionary and the HDR and payload bytes.
+         *          <BR>Metadata:
+         *          <BR>- `sf`, `cr` and `length` (payload bytes, from the HDR)
+         *          <BR>- `crc_ok` (bool), left out when the payload CRC was not checked
+         *          <BR>- `cfo` (Hz) and `snr` (dB), estimated on the HDR symbols
+         *          <BR>- `preamble_index` and `end_index`, the absolute sample offsets of the frame in the input stream
+         *          <BR>- `end_time` and `publish_time`, wall clock in seconds since the epoch, stamped when the last symbol
+         *            was demodulated and now, right before publishing
+         *
+         *  \param  frame_bytes
+         *          The HDR and payload bytes.
+         *  \param  frame_len
+         *          Size of said array.
+         *  \param  info
+         *          What was received, where and when.
+         */
+        inline pmt::pmt_t make_frame_pdu(const uint8_t *frame_bytes, const uint32_t frame_len, const frame_info &info) {
+            pmt::pmt_t meta = pmt::make_dict();
+
+            meta = pmt::dict_add(meta, pmt::mp("sf"),             pmt::from_long(info.sf));
+            meta = pmt::dict_add(meta, pmt::mp("cr"),             pmt::from_long(info.cr));
+            meta = pmt::dict_add(meta, pmt::mp("length"),         pmt::from_long(info.length));
+            meta = pmt::dict_add(meta, pmt::mp("cfo"),            pmt::from_double(info.cfo));
+            meta = pmt::dict_add(meta, pmt::mp("snr"),            pmt::from_double(info.snr));
+            meta = pmt::dict_add(meta, pmt::mp("preamble_index"), pmt::from_uint64(info.preamble_index));
+            meta = pmt::dict_add(meta, pmt::mp("end_index"),      pmt::from_uint64(info.end_index));
+            meta = pmt::dict_add(meta, pmt::mp("end_time"),       pmt::from_double(info.end_time * 1e-9));
+            meta = pmt::dict_add(meta, pmt::mp("publish_time"),   pmt::from_double(gr::lora::wall_clock_ns() * 1e-9));
+
+            if (info.crc_checked) {
+                meta = pmt::dict_add(meta, pmt::mp("crc_ok"),     pmt::from_bool(info.crc_ok));
+            }
+
+            return pmt::cons(meta, pmt::init_u8vector(frame_len, frame_bytes));
+        }
+
+    } // namespace lora
+} // namespace gr
+
+#endif /* FRAME_PDU_H */
@@ -0,0 +1,183 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <volk/volk.h>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include "kernels.h"
+
+namespace gr {
+    namespace lora {
+        namespace kernels {
+
+            /**
+             *  Wrap the phase difference of two samples to `[-pi, pi]`.
+             *  Same arithmetic as the unwrap loops from liquid_unwrap_phase, without the loops:
+             *  both phases are in `[-pi, pi]`, so one correction is always sufficient.
+             *  Written branchless so the compiler can vectorize the surrounding loop.
+             */
+            static inline float wrapped_phase_diff(const float iphase_1, float iphase_2) {
+                iphase_2 = ((iphase_2 - iphase_1) >  M_PI) ? (float)(iphase_2 - 2.0f*M_PI) : iphase_2;
+                iphase_2 = ((iphase_2 - iphase_1) < -M_PI) ? (float)(iphase_2 + 2.0f*M_PI) : iphase_2;
+                return iphase_2 - iphase_1;
+            }
+
+            void instantaneous_frequency(const complex_t *in_samples, float *out_ifreq, const uint32_t window) {
+                // Phase of every sample in one vectorized pass
+                volk_32fc_s32f_atan2_32f(out_ifreq, in_samples, 1.0f, window);
+
+                // Forward difference in-place; out_ifreq[i + 1] is still the phase when it is read
+                for (uint32_t i = 0u; i < window - 1u; i++) {
+                    out_ifreq[i] = wrapped_phase_diff(out_ifreq[i], out_ifreq[i + 1u]);
+                }
+
+                // Make sure there is no strong gradient if this value is accessed by mistake
+                out_ifreq[window - 1u] = out_ifreq[window - 2u];
+            }
+
+            void instantaneous_frequency_generic(const complex_t *in_samples, float *out_ifreq, const uint32_t window) {
+                for (uint32_t i = 1u; i < window; i++) {
+                    const float iphase_1 = std::arg(in_samples[i - 1]);
+                          float iphase_2 = std::arg(in_samples[i]);
+
+                    // Unwrapped loops from liquid_unwrap_phase
+                    while ( (iphase_2 - iphase_1) >  M_PI ) iphase_2 -= 2.0f*M_PI;
+                    while ( (iphase_2 - iphase_1) < -M_PI ) iphase_2 += 2.0f*M_PI;
+
+                    out_ifreq[i - 1] = iphase_2 - iphase_1;
+                }
+
+                out_ifreq[window - 1] = out_ifreq[window - 2];
+            }
+
+            float stddev(const float *values, const uint32_t len, const float mean) {
+                float result;
+                volk_32f_stddev_32f(&result, values, mean, len);
+                return result;
+            }
+
+            float stddev_generic(const float *values, const uint32_t len, const float mean) {
+                float variance = 0.0f;
+
+                for (uint32_t i = 0u; i < len; i++) {
+                    const float temp = values[i] - mean;
+                    variance += temp * temp;
+                }
+
+                variance /= (float)len;
+                return std::sqrt(variance);
+            }
+
+            /**
+             *  Expanded form of the normalized cross correlation:
+             *  `sum((x - mx) * (c - mc)) = sum(x * c) - len * mx * mc`,
+             *  so only sums and dot products are needed, which are all available in VOLK.
+             */
+            float cross_correlate_ifreq(const float *samples_ifreq, const float *ideal_chirp, const uint32_t len) {
+                float sum_x, sum_c, dot_xc;
+
+                volk_32f_accumulator_s32f(&sum_x,  samples_ifreq, len);
+                volk_32f_accumulator_s32f(&sum_c,  ideal_chirp,   len);
+                volk_32f_x2_dot_prod_32f (&dot_xc, samples_ifreq, ideal_chirp, len);
+
+                const float average   = sum_x / (float)len;
+                const float chirp_avg = sum_c / (float)len;
+                const float sd        =   stddev(samples_ifreq, len, average)
+                                        * stddev(ideal_chirp,   len, chirp_avg);
+
+                return (dot_xc - (float)len * average * chirp_avg) / sd / (float)(len - 1u);
+            }
+
+            float cross_correlate_ifreq_generic(const float *samples_ifreq, const float *ideal_chirp, const uint32_t len) {
+                float result = 0.0f;
+
+                const float average   = std::accumulate(samples_ifreq, samples_ifreq + len, 0.0f) / (float)(len);
+                const float chirp_avg = std::accumulate(ideal_chirp,   ideal_chirp   + len, 0.0f) / (float)(len);
+                const float sd        =   stddev_generic(samples_ifreq, len, average)
+                                        * stddev_generic(ideal_chirp,   len, chirp_avg);
+
+                for (uint32_t i = 0u; i < len; i++) {
+                    result += (samples_ifreq[i] - average) * (ideal_chirp[i] - chirp_avg) / sd;
+                }
+
+                result /= (float)(len - 1u);
+
+                return result;
+            }
+
+            float energy(const complex_t *samples, const uint32_t len) {
+                complex_t result;
+                volk_32fc_x2_conjugate_dot_prod_32fc(&result, samples, samples, len);
+                return result.real() / (float)len;
+            }
+
+            float energy_generic(const complex_t *samples, const uint32_t len) {
+                float result = 0.0f;
+
+                for (uint32_t i = 0u; i < len; i++) {
+                    const float magn = std::abs(samples[i]);
+                    result += magn * magn;
+                }
+
+                return result / (float)len;
+            }
+
+            /**
+             *  `conj(s * c) = conj(c) * conj(s)`, which is exactly VOLK's `a * conj(b)` with `a = conj(c)`.
+             */
+            void dechirp(complex_t *out, const complex_t *samples, const complex_t *chirp_conj, const uint32_t len) {
+                volk_32fc_x2_multiply_conjugate_32fc(out, chirp_conj, samples, len);
+            }
+
+            void dechirp_generic(complex_t *out, const complex_t *samples, const complex_t *chirp_conj, const uint32_t len) {
+                for (uint32_t i = 0u; i < len; i++) {
+                    out[i] = std::conj(samples[i] * std::conj(chirp_conj[i]));
+                }
+            }
+
+            /**
+             *  The squared magnitude has the same maximum and avoids a square root per bin.
+             */
+            uint32_t argmax_magnitude(const complex_t *samples, float *scratch, const uint32_t len) {
+                // VOLK only offers a 16 bit index on older versions
+                if (len > 0xFFFFu) {
+                    return argmax_magnitude_generic(samples, scratch, len);
+                }
+
+                uint16_t idx = 0u;
+
+                volk_32fc_magnitude_squared_32f(scratch, samples, len);
+                volk_32f_index_max_16u(&idx, scratch, len);
+
+                return idx;
+            }
+
+            uint32_t argmax_magnitude_generic(const complex_t *samples, float *scratch, const uint32_t len) {
+                for (uint32_t i = 0u; i < len; i++) {
+                    scratch[i] = std::abs(samples[i]);
+                }
+
+                return std::max_element(scratch, scratch + len) - scratch;
+            }
+
+        } // namespace kernels
+    } // namespace lora
+} // namespace gr
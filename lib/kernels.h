@@ -0,0 +1,125 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <complex>
+#include <cstdint>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Kernels** : The vectorized inner loops of the decoder.
+         *          <BR>Each kernel is backed by VOLK, which selects the fastest implementation
+         *          <BR>(AVX2, SSE, NEON, ...) for the running machine at runtime and falls back to a generic one.
+         *          <BR>The `*_generic` variants contain the original scalar code and serve as reference in `qa_kernels`.
+         */
+        namespace kernels {
+
+            typedef std::complex<float> complex_t;
+
+            /**
+             *  \brief  Calculate the instantaneous frequency for the given complex symbol.
+             *          <BR>The phase difference between consecutive samples is wrapped to `[-pi, pi]`,
+             *          <BR>the last value is copied from the one before.
+             *
+             *  \param  in_samples
+             *          The complex array to calculate the instantaneous frequency for.
+             *  \param  out_ifreq
+             *          The output `float` array containing the instantaneous frequency.
+             *  \param  window
+             *          The size of said arrays, at least 2.
+             */
+            void instantaneous_frequency(const complex_t *in_samples, float *out_ifreq, const uint32_t window);
+            void instantaneous_frequency_generic(const complex_t *in_samples, float *out_ifreq, const uint32_t window);
+
+            /**
+             *  \brief  Return the standard deviation for the given array.
+             *
+             *  \param  values
+             *          The array to calculate the standard deviation for.
+             *  \param  len
+             *          Length of said array.
+             *  \param  mean
+             *          The mean (average) of the values in the array.
+             */
+            float stddev(const float *values, const uint32_t len, const float mean);
+            float stddev_generic(const float *values, const uint32_t len, const float mean);
+
+            /**
+             *  \brief  Returns the normalized cross correlation coefficient of two real arrays.
+             *          <BR>See https://en.wikipedia.org/wiki/Cross-correlation#Normalized_cross-correlation.
+             *
+             *  \param  samples_ifreq
+             *          The instantaneous frequency of the symbol to correlate with.
+             *  \param  ideal_chirp
+             *          The instantaneous frequency of the ideal chirp to correlate with.
+             *  \param  len
+             *          The amount of values to correlate.
+             */
+            float cross_correlate_ifreq(const float *samples_ifreq, const float *ideal_chirp, const uint32_t len);
+            float cross_correlate_ifreq_generic(const float *samples_ifreq, const float *ideal_chirp, const uint32_t len);
+
+            /**
+             *  \brief  Returns the average energy (`|x|^2`) of the given samples.
+             *
+             *  \param  samples
+             *          The complex samples.
+             *  \param  len
+             *          Length of said array.
+             */
+            float energy(const complex_t *samples, const uint32_t len);
+            float energy_generic(const complex_t *samples, const uint32_t len);
+
+            /**
+             *  \brief  Dechirp the given samples: `out[i] = conj(samples[i] * chirp[i])`.
+             *
+             *  \param  out
+             *          The output array.
+             *  \param  samples
+             *          The complex symbol to dechirp.
+             *  \param  chirp_conj
+             *          The **conjugate** of the ideal chirp to dechirp with, so only one complex multiply is needed.
+             *  \param  len
+             *          Length of said arrays.
+             */
+            void dechirp(complex_t *out, const complex_t *samples, const complex_t *chirp_conj, const uint32_t len);
+            void dechirp_generic(complex_t *out, const complex_t *samples, const complex_t *chirp_conj, const uint32_t len);
+
+            /**
+             *  \brief  Return the index of the sample with the highest magnitude.
+             *
+             *  \param  samples
+             *          The complex samples, e.g. FFT bins.
+             *  \param  scratch
+             *          A buffer of at least `len` floats to store the magnitudes in.
+             *  \param  len
+             *          Length of said array.
+             */
+            uint32_t argmax_magnitude(const complex_t *samples, float *scratch, const uint32_t len);
+            uint32_t argmax_magnitude_generic(const complex_t *samples, float *scratch, const uint32_t len);
+
+        } // namespace kernels
+    } // namespace lora
+} // namespace gr
+
+#endif /* KERNELS_H */
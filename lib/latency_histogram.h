@@ -0,0 +1,101 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Latency histogram** : Counts latencies in logarithmic buckets, 10 per decade from 1 us to 100 s.
+         *          <BR>Constant memory and time per sample, percentiles are accurate to one bucket (about 26%).
+         */
+        class latency_histogram {
+            private:
+                static const int min_exponent = -6;         ///< Lowest bucket edge: 10^-6 s.
+                static const int decades      = 8;
+                static const int per_decade   = 10;
+
+                std::vector<uint64_t> d_buckets;            ///< Underflow, the decades, overflow.
+                uint64_t              d_count;
+
+                /**
+                 *  \brief  Return the upper edge of the given bucket in seconds.
+                 */
+                static double upper_edge(const size_t bucket) {
+                    return std::pow(10.0, min_exponent + (double)bucket / per_decade);
+                }
+
+            public:
+                latency_histogram() : d_buckets(decades * per_decade + 2u, 0u), d_count(0u) {}
+
+                /**
+                 *  \brief  Count the given latency.
+                 *
+                 *  \param  seconds
+                 *          The latency, negative values (clock adjustments) count as the lowest bucket.
+                 */
+                void add(const double seconds) {
+                    size_t bucket = 0u;
+
+                    if (seconds > upper_edge(0u)) {
+                        const double position = std::ceil((std::log10(seconds) - min_exponent) * per_decade);
+                        bucket = (size_t)std::min(position, (double)(this->d_buckets.size() - 1u));
+                    }
+
+                    this->d_buckets[bucket]++;
+                    this->d_count++;
+                }
+
+                /**
+                 *  \brief  Return the upper edge of the bucket holding the given percentile, or 0 without samples.
+                 *
+                 *  \param  p
+                 *          The percentile, between 0 and 100.
+                 */
+                double percentile(const double p) const {
+                    if (this->d_count == 0u)
+                        return 0.0;
+
+                    const uint64_t rank = (uint64_t)std::ceil(p / 100.0 * this->d_count);
+                    uint64_t seen       = 0u;
+
+                    for (size_t i = 0u; i < this->d_buckets.size(); i++) {
+                        seen += this->d_buckets[i];
+
+                        if (seen >= std::max<uint64_t>(rank, 1u))
+                            return upper_edge(i);
+                    }
+
+                    return upper_edge(this->d_buckets.size() - 1u);
+                }
+
+                uint64_t count() const { return this->d_count; }
+        };
+
+    } // namespace lora
+} // namespace gr
+
+#endif /* LATENCY_HISTOGRAM_H */
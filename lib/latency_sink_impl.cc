@@ -0,0 +1,127 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include <boost/bind.hpp>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "latency_sink_impl.h"
+#include "utilities.h"
+
+namespace gr {
+    namespace lora {
+
+        latency_sink::sptr latency_sink::make() {
+            return gnuradio::get_initial_sptr(new latency_sink_impl());
+        }
+
+        latency_sink_impl::latency_sink_impl()
+            : gr::block("latency_sink",
+                        gr::io_signature::make(0, 0, 0),
+                        gr::io_signature::make(0, 0, 0)),
+              d_decode(max_sf + 1),
+              d_delivery(max_sf + 1),
+              d_ignored(0u) {
+            this->message_port_register_in(pmt::mp("in"));
+            this->set_msg_handler(pmt::mp("in"), boost::bind(&latency_sink_impl::handle, this, _1));
+        }
+
+        latency_sink_impl::~latency_sink_impl() {
+        }
+
+        void latency_sink_impl::handle(pmt::pmt_t msg) {
+            const double arrival = gr::lora::wall_clock_ns() * 1e-9;
+
+            if (!pmt::is_pair(msg) || !pmt::is_dict(pmt::car(msg))) {
+                std::lock_guard<std::mutex> lock(this->d_mutex);
+                this->d_ignored++;
+                return;
+            }
+
+            const pmt::pmt_t meta    = pmt::car(msg);
+            const pmt::pmt_t missing = pmt::PMT_NIL;
+            const pmt::pmt_t sf      = pmt::dict_ref(meta, pmt::mp("sf"),           missing);
+            const pmt::pmt_t end     = pmt::dict_ref(meta, pmt::mp("end_time"),     missing);
+            const pmt::pmt_t publish = pmt::dict_ref(meta, pmt::mp("publish_time"), missing);
+
+            std::lock_guard<std::mutex> lock(this->d_mutex);
+
+            if (pmt::eq(sf, missing) || pmt::eq(end, missing) || pmt::eq(publish, missing)
+                || pmt::to_long(sf) < 0 || pmt::to_long(sf) > max_sf) {
+                this->d_ignored++;
+                return;
+            }
+
+            const long   index    = pmt::to_long(sf);
+            const double end_time = pmt::to_double(end);
+
+            this->d_decode[index].add(pmt::to_double(publish) - end_time);
+            this->d_delivery[index].add(arrival - end_time);
+        }
+
+        bool latency_sink_impl::stop() {
+            std::cout << this->report();
+            return true;
+        }
+
+        double latency_sink_impl::percentile(int sf, double p) const {
+            std::lock_guard<std::mutex> lock(this->d_mutex);
+            return sf < 0 || sf > max_sf ? 0.0 : this->d_delivery[sf].percentile(p);
+        }
+
+        uint64_t latency_sink_impl::count(int sf) const {
+            std::lock_guard<std::mutex> lock(this->d_mutex);
+            return sf < 0 || sf > max_sf ? 0u : this->d_delivery[sf].count();
+        }
+
+        std::string latency_sink_impl::report() const {
+            std::lock_guard<std::mutex> lock(this->d_mutex);
+            std::ostringstream out;
+
+            out << "[LoRa Latency Sink] SF  frames   decode p50 / p99 (ms)   delivery p50 / p99 (ms)" << std::endl;
+
+            for (int sf = 0; sf <= max_sf; sf++) {
+                const latency_histogram &decode   = this->d_decode[sf];
+                const latency_histogram &delivery = this->d_delivery[sf];
+
+                if (delivery.count() == 0u)
+                    continue;
+
+                out << "[LoRa Latency Sink] " << std::setw(2) << sf << std::setw(8) << delivery.count()
+                    << std::fixed << std::setprecision(3)
+                    << std::setw(13) << decode.percentile(50.0)   * 1e3 << " / " << std::setw(8) << decode.percentile(99.0)   * 1e3
+                    << std::setw(15) << delivery.percentile(50.0) * 1e3 << " / " << std::setw(8) << delivery.percentile(99.0) * 1e3
+                    << std::endl;
+            }
+
+            if (this->d_ignored) {
+                out << "[LoRa Latency Sink] Ignored " << this->d_ignored << " messages without frame metadata." << std::endl;
+            }
+
+            return out.str();
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,67 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_LORA_LATENCY_SINK_IMPL_H
+#define INCLUDED_LORA_LATENCY_SINK_IMPL_H
+
+#include "lora/latency_sink.h"
+#include "latency_histogram.h"
+#include <mutex>
+#include <vector>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **LoRa Latency Sink**
+         *          <BR>Keeps a decode and a delivery `latency_histogram` per spreading factor, filled from the
+         *          `end_time` and `publish_time` in the metadata of each frame PDU.
+         */
+        class latency_sink_impl : public latency_sink {
+            private:
+                static const int max_sf = 12;
+
+                std::vector<latency_histogram> d_decode;    ///< Publish time - end time, per SF.
+                std::vector<latency_histogram> d_delivery;  ///< Arrival here - end time, per SF.
+                uint64_t                       d_ignored;   ///< Messages without the metadata, e.g. blobs.
+                mutable std::mutex             d_mutex;     ///< The handler runs on the scheduler's thread, getters on any.
+
+                /**
+                 *  \brief  Add the latencies of the given frame PDU.
+                 */
+                void handle(pmt::pmt_t msg);
+
+            public:
+                latency_sink_impl();
+                ~latency_sink_impl();
+
+                /**
+                 *  \brief  Print the `report`.
+                 */
+                bool stop();
+
+                double percentile(int sf, double p) const;
+                uint64_t count(int sf) const;
+                std::string report() const;
+        };
+    } // namespace lora
+} // namespace gr
+
+#endif /* INCLUDED_LORA_LATENCY_SINK_IMPL_H */
@@ -0,0 +1,33 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LORA_COMPLEX_H
+#define LORA_COMPLEX_H
+
+#include <complex>
+
+/**
+ *  The PHY only needs `gr_complex` from GNU Radio, which is a plain `std::complex<float>`.
+ *  <BR>Declared the same way as in `<gnuradio/gr_complex.h>`, so the PHY builds without GNU Radio
+ *  and the GNU Radio blocks can include both.
+ */
+typedef std::complex<float> gr_complex;
+
+#endif /* LORA_COMPLEX_H */
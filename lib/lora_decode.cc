@@ -0,0 +1,387 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ *  \brief  Decode a `.cfile` capture without GNU Radio, driving `phy_decoder` straight from the memory-mapped file.
+ *
+ *  Usage: lora-decode [options] capture.cfile
+ *
+ *      -s sf           Spreading factor (7)
+ *      -r samp_rate    Sample rate of the capture (1e6)
+ *      -f offset       Channel offset in Hz, e.g. 100e3 for the captures in `examples/` (0, already centered)
+ *      -j threads      Amount of segments to decode in parallel (1)
+ *      -m method       Demodulation: "gradient", "fft" or "auto" (auto)
+ *      -c check        Payload CRC: "off", "flag" or "drop" (flag)
+ *      -H              Keep decoding frames whose HDR checksum does not match
+ *      -o file         Write the frames to this file instead of stdout
+ *      -q              Only print the summary (to stderr)
+ *
+ *  Every frame is one line: its preamble and end sample indices, SF, CR, payload length, CRC status ("ok", "bad" or "-"),
+ *  SNR and CFO, then the HDR and payload bytes in hex.
+ *  <BR>With several threads, the capture is split into equal segments. Each segment is decoded up to a whole frame past its
+ *  end, so the frames crossing a boundary are decoded by both neighbours and only kept once (the copy that passed its CRC).
+ *  As every segment starts looking for a preamble afresh, a segment can also find a frame the single-threaded run missed
+ *  while it was still synchronizing on something else.
+ *  <BR>Without an offset the samples are decoded in place, otherwise each segment is channelized like in
+ *  `qa_BasicTest_XML.py` (moved to 0 Hz and low-passed at 86 kHz) a chunk at a time, into a window of a few symbols.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <volk/volk.h>
+#include "phy_decoder.h"
+#include "thread_pool.h"
+
+/**
+ *  A decoded frame, with its metadata.
+ */
+struct decoded_frame {
+    gr::lora::frame_info info;
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ *  Settings from the command line.
+ */
+struct options {
+    uint8_t     sf        = 7u;
+    float       samp_rate = 1e6f;
+    double      offset    = 0.0;
+    uint32_t    threads   = 1u;
+    std::string demodulation = "auto";
+    gr::lora::CrcCheck crc_check = gr::lora::CrcCheck::FLAG;
+    bool        header_check = true;
+    const char *output    = nullptr;
+    bool        quiet     = false;
+};
+
+static const uint32_t channel_taps  = 101u;
+static const uint32_t channel_chunk = 16384u;
+
+static void usage(const char *name) {
+    std::fprintf(stderr, "Usage: %s [-s sf] [-r samp_rate] [-f offset] [-j threads] [-m gradient|fft|auto] "
+                         "[-c off|flag|drop] [-H] [-o file] [-q] capture.cfile\n", name);
+}
+
+/**
+ *  Upper bound on the length of a frame in symbols: the preamble, the HDR block and 255 payload bytes plus their CRC,
+ *  at CR 4/8 and with the reduced rate of the HDR.
+ */
+static uint64_t max_frame_symbols(const uint8_t sf) {
+    return 8u + 4u + 8u + (8u * (255u + 2u) * 2u + (sf - 2u) - 1u) / (sf - 2u);
+}
+
+/**
+ *  Like the channelizer in `qa_BasicTest_XML.py`: move the channel at `offset` to 0 Hz and low-pass (86 kHz).
+ *  The mixer runs on absolute indices, so every segment sees the same phase.
+ *  <BR>The samples are channelized `channel_chunk` at a time into a window that also holds the ones the decoder has
+ *  not consumed yet, and the last `channel_taps - 1` mixed samples are kept in front of the next chunk as the state
+ *  of the filter. So a segment only ever takes a few symbols of memory, however long it is.
+ */
+class channelizer {
+    private:
+        const gr_complex       *d_capture;
+        const double            d_samp_rate;
+        const double            d_offset;
+        const uint64_t          d_limit;        ///< Absolute index past the last sample to channelize.
+        std::vector<float>      d_taps;         ///< The low-pass filter, reversed for the dot product.
+        std::vector<gr_complex> d_mixed;        ///< The filter state, then the mixed samples of the current chunk.
+        std::vector<gr_complex> d_window;       ///< The channelized samples of `[d_start, d_end)`.
+        uint64_t                d_start;
+        uint64_t                d_end;
+
+        /**
+         *  Channelize the `count` samples from `d_end` behind the window.
+         */
+        void run(const uint32_t count) {
+            gr_complex *mixed = &this->d_mixed[channel_taps - 1u];
+            gr_complex *out   = &this->d_window[this->d_end - this->d_start];
+
+            for (uint32_t i = 0u; i < count; i++) {
+                const uint64_t index = this->d_end + i;
+                mixed[i] = this->d_capture[index] * std::polar(1.0f, (float)(-2.0 * M_PI * std::fmod(this->d_offset * index / this->d_samp_rate, 1.0)));
+            }
+
+            for (uint32_t i = 0u; i < count; i++)
+                volk_32fc_32f_dot_prod_32fc(&out[i], &this->d_mixed[i], &this->d_taps[0], channel_taps);
+
+            std::copy(this->d_mixed.begin() + count, this->d_mixed.begin() + count + (channel_taps - 1u), this->d_mixed.begin());
+            this->d_end += count;
+        }
+
+    public:
+        /**
+         *  \param  capture
+         *          The whole capture.
+         *  \param  from
+         *          Absolute index of the first sample to output, the filter starts `channel_taps` earlier when it can.
+         *  \param  limit
+         *          Absolute index just after the last sample to output.
+         *  \param  span
+         *          The most samples asked for at once.
+         */
+        channelizer(const gr_complex *capture, const uint64_t from, const uint64_t limit,
+                    const double samp_rate, const double offset, const uint32_t span)
+            : d_capture(capture),
+              d_samp_rate(samp_rate),
+              d_offset(offset),
+              d_limit(limit),
+              d_taps(channel_taps),
+              d_mixed(channel_taps - 1u + span + channel_chunk),
+              d_window(span + channel_chunk),
+              d_start(from),
+              d_end(from) {
+            const double fc = 86e3 / samp_rate;
+
+            for (uint32_t i = 0u; i < channel_taps; i++) {
+                const double n = (double)i - (channel_taps - 1u) / 2.0;
+                const double w = 0.54 - 0.46 * std::cos(2.0 * M_PI * i / (channel_taps - 1u));
+                this->d_taps[channel_taps - 1u - i] = (float)(w * (n == 0.0 ? 2.0 * fc : std::sin(2.0 * M_PI * fc * n) / (M_PI * n)));
+            }
+
+            // Warm the filter up on the samples before the segment, zeroes at the start of the capture
+            const uint32_t warmup = (uint32_t)std::min<uint64_t>(from, channel_taps - 1u);
+            for (uint32_t i = 0u; i < warmup; i++) {
+                const uint64_t index = from - warmup + i;
+                this->d_mixed[channel_taps - 1u - warmup + i] = capture[index] * std::polar(1.0f, (float)(-2.0 * M_PI * std::fmod(offset * index / samp_rate, 1.0)));
+            }
+        }
+
+        /**
+         *  \brief  Return the channelized samples `[pos, pos + count)`, `pos` never going back and `count` at most the span.
+         */
+        const gr_complex *samples(const uint64_t pos, const uint32_t count) {
+            if (pos + count > this->d_end) {
+                // Drop what was consumed and fill the rest of the window
+                std::copy(this->d_window.begin() + (pos - this->d_start), this->d_window.begin() + (this->d_end - this->d_start),
+                          this->d_window.begin());
+                this->d_start = pos;
+
+                this->run((uint32_t)std::min<uint64_t>(this->d_window.size() - (this->d_end - this->d_start),
+                                                       this->d_limit - this->d_end));
+            }
+
+            return &this->d_window[pos - this->d_start];
+        }
+};
+
+/**
+ *  Decode the frames whose preamble is detected in `[from, to)`, looking up to `limit` to finish them.
+ */
+static void decode_segment(const options &opts, const gr_complex *capture, const uint64_t from, const uint64_t to,
+                           const uint64_t limit, std::vector<decoded_frame> &frames) {
+    gr::lora::phy_decoder decoder(opts.samp_rate, opts.sf, opts.demodulation, false);
+
+    decoder.set_crc_check(opts.crc_check);
+    decoder.set_header_check(opts.header_check);
+    decoder.set_position(from);
+    decoder.set_frame_callback([&](const uint8_t *bytes, const uint32_t len, const gr::lora::frame_info &info) {
+        decoded_frame frame;
+        frame.info  = info;
+        frame.bytes.assign(bytes, bytes + len);
+        frames.push_back(frame);
+    });
+
+    // DETECT needs the most samples at once
+    std::unique_ptr<channelizer> channel;
+    if (opts.offset != 0.0)
+        channel.reset(new channelizer(capture, from, limit, opts.samp_rate, opts.offset, 3u * decoder.samples_per_symbol()));
+
+    uint64_t pos = from;
+    while (pos + decoder.samples_needed() <= limit) {
+        // Past the segment, only a frame that is still being decoded is of any interest
+        if (pos >= to && decoder.state() == gr::lora::DecoderState::DETECT)
+            break;
+
+        const gr_complex *samples = channel ? channel->samples(pos, decoder.samples_needed()) : &capture[pos];
+        pos += decoder.process(samples, samples);
+    }
+
+    decoder.flush();
+
+    // A frame detected past the segment belongs to the next one
+    frames.erase(std::remove_if(frames.begin(), frames.end(), [&](const decoded_frame &frame) {
+        return frame.info.preamble_index >= to;
+    }), frames.end());
+}
+
+static bool parse(int argc, char **argv, options &opts, const char *&capture) {
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:r:f:j:m:c:Ho:q")) != -1) {
+        switch (opt) {
+            case 's': opts.sf        = (uint8_t)std::atoi(optarg);                  break;
+            case 'r': opts.samp_rate = std::atof(optarg);                           break;
+            case 'f': opts.offset    = std::atof(optarg);                           break;
+            case 'j': opts.threads   = (uint32_t)std::max(1, std::atoi(optarg));    break;
+            case 'm': opts.demodulation = optarg;                                   break;
+            case 'o': opts.output    = optarg;                                      break;
+            case 'q': opts.quiet     = true;                                        break;
+            case 'H': opts.header_check = false;                                    break;
+            case 'c':
+                if (!gr::lora::frame_decoder::parse_crc_check(optarg, opts.crc_check)) {
+                    std::fprintf(stderr, "Unknown CRC check \"%s\", expected off, flag or drop.\n", optarg);
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (optind != argc - 1 || opts.sf < 6u || opts.sf > 12u || opts.samp_rate <= 0.0f)
+        return false;
+
+    capture = argv[optind];
+    return true;
+}
+
+int main(int argc, char **argv) {
+    options     opts;
+    const char *path = nullptr;
+
+    if (!parse(argc, argv, opts, path)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const int fd = open(path, O_RDONLY);
+    struct stat st;
+
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::perror(path);
+        return 1;
+    }
+
+    const uint64_t total = (uint64_t)st.st_size / sizeof(gr_complex);
+    if (total == 0u) {
+        std::fprintf(stderr, "%s holds no samples\n", path);
+        return 1;
+    }
+
+    void *mapped = mmap(nullptr, total * sizeof(gr_complex), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapped == MAP_FAILED) {
+        std::perror("mmap");
+        return 1;
+    }
+
+    const gr_complex *capture = static_cast<const gr_complex *>(mapped);
+
+    // Every segment reads its samples once, front to back
+    madvise(mapped, total * sizeof(gr_complex), MADV_SEQUENTIAL);
+
+    const uint64_t sps     = (uint64_t)(opts.samp_rate * (1u << opts.sf) / 125e3);
+    const uint64_t overlap = max_frame_symbols(opts.sf) * sps;
+    const uint64_t length  = (total + opts.threads - 1u) / opts.threads;
+
+    std::vector<std::vector<decoded_frame>> segments(opts.threads);
+    std::vector<std::function<void()>>      tasks;
+
+    for (uint32_t i = 0u; i < opts.threads; i++) {
+        const uint64_t from  = std::min(total, i * length);
+        const uint64_t to    = std::min(total, from + length);
+        const uint64_t limit = std::min(total, to + overlap);
+
+        tasks.push_back([&, i, from, to, limit] { decode_segment(opts, capture, from, to, limit, segments[i]); });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        gr::lora::thread_pool pool(opts.threads);
+        pool.run(tasks);
+    }
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    munmap(mapped, total * sizeof(gr_complex));
+
+    // Both neighbours decode a frame that crosses a boundary, no two frames end within a symbol of each other
+    std::vector<decoded_frame> frames;
+    uint64_t duplicates = 0u;
+
+    for (const std::vector<decoded_frame> &segment : segments) {
+        for (const decoded_frame &frame : segment) {
+            if (!frames.empty()) {
+                decoded_frame &last = frames.back();
+                const uint64_t gap  = std::max(frame.info.end_index, last.info.end_index)
+                                    - std::min(frame.info.end_index, last.info.end_index);
+
+                if (gap < sps) {
+                    // Keep the copy that passed its CRC, if only one did
+                    if (frame.info.crc_ok && !last.info.crc_ok)
+                        last = frame;
+
+                    duplicates++;
+                    continue;
+                }
+            }
+
+            frames.push_back(frame);
+        }
+    }
+
+    FILE *out = opts.output ? std::fopen(opts.output, "w") : stdout;
+    if (!out) {
+        std::perror(opts.output);
+        return 1;
+    }
+
+    uint64_t crc_failures = 0u;
+
+    for (const decoded_frame &frame : frames) {
+        const gr::lora::frame_info &info = frame.info;
+        crc_failures += info.crc_checked && !info.crc_ok;
+
+        if (opts.quiet)
+            continue;
+
+        std::fprintf(out, "%llu %llu SF%u CR4/%u len %u crc %s snr %.1f cfo %.0f :",
+                     (unsigned long long)info.preamble_index, (unsigned long long)info.end_index,
+                     info.sf, 4u + info.cr, info.length, !info.crc_checked ? "-" : info.crc_ok ? "ok" : "bad",
+                     info.snr, info.cfo);
+
+        for (const uint8_t byte : frame.bytes)
+            std::fprintf(out, " %02x", byte);
+
+        std::fputc('\n', out);
+    }
+
+    if (out != stdout)
+        std::fclose(out);
+
+    std::fprintf(stderr, "%zu frames (%llu failed their CRC, %llu duplicates dropped) in %.2f s of signal, decoded in %.2f s with %u threads\n",
+                 frames.size(), (unsigned long long)crc_failures, (unsigned long long)duplicates,
+                 total / opts.samp_rate, wall, opts.threads);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ *  \brief  The C interface of liblora-phy, over `gr::lora::phy_stream`. No exception crosses it.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <lora/lora_phy.h>
+#include <lora/phy_stream.h>
+#include <complex>
+#include <exception>
+#include <iostream>
+
+struct lora_phy {
+    gr::lora::phy_stream stream;
+    lora_frame_callback  callback;
+    void                *user;
+
+    lora_phy(const float samp_rate, const int sf, const char *demodulation)
+        : stream(samp_rate, sf, demodulation ? demodulation : "auto"),
+          callback(nullptr),
+          user(nullptr) {}
+};
+
+lora_phy *lora_phy_create(float samp_rate, int sf, const char *demodulation) {
+    if (sf < 6 || sf > 12 || samp_rate < 125e3f)
+        return nullptr;
+
+    try {
+        lora_phy *phy = new lora_phy(samp_rate, sf, demodulation);
+
+        phy->stream.set_frame_callback([phy](const uint8_t *bytes, const uint32_t len, const lora_frame_info &info) {
+            if (phy->callback)
+                phy->callback(bytes, len, &info, phy->user);
+        });
+
+        return phy;
+    } catch (const std::exception &e) {
+        std::cerr << "[LoRa Decoder] WARNING : " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+void lora_phy_destroy(lora_phy *phy) {
+    delete phy;
+}
+
+void lora_phy_set_frame_callback(lora_phy *phy, lora_frame_callback callback, void *user) {
+    phy->callback = callback;
+    phy->user     = user;
+}
+
+void lora_phy_push(lora_phy *phy, const float *iq, size_t count) {
+    try {
+        // Interleaved floats have the layout of std::complex<float>
+        phy->stream.push(reinterpret_cast<const std::complex<float> *>(iq), count);
+    } catch (const std::exception &e) {
+        std::cerr << "[LoRa Decoder] WARNING : " << e.what() << std::endl;
+    }
+}
+
+void lora_phy_flush(lora_phy *phy) {
+    phy->stream.flush();
+}
+
+int lora_phy_set_crc_check(lora_phy *phy, const char *check) {
+    return check && phy->stream.set_crc_check(check);
+}
+
+void lora_phy_set_header_check(lora_phy *phy, int check) {
+    phy->stream.set_header_check(check != 0);
+}
+
+void lora_phy_set_abs_threshold(lora_phy *phy, float threshold) {
+    phy->stream.set_abs_threshold(threshold);
+}
+
+void lora_phy_set_threshold_margin(lora_phy *phy, float margin_db) {
+    phy->stream.set_threshold_margin(margin_db);
+}
+
+uint64_t lora_phy_samples_pushed(const lora_phy *phy) {
+    return phy->stream.samples_pushed();
+}
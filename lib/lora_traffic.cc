@@ -0,0 +1,211 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ *  \brief  Generate the LoRa traffic of a simulated network as a `.cfile`, with `traffic_generator`.
+ *
+ *  Usage: lora-traffic [options] output.cfile|-
+ *
+ *      -r samp_rate    Sample rate (1e6)
+ *      -d seconds      Duration (10)
+ *      -N nodes        Amount of nodes (10)
+ *      -p rate         Mean packets per second of every node (0.1)
+ *      -s sfs          Comma separated SFs to draw the SF of every node from, repeat one to weigh it more (7)
+ *      -c cr           Coding rate, 1 to 4 for 4/5 to 4/8 (4)
+ *      -l min[:max]    Payload length (16)
+ *      -n min[:max]    SNR of every node in the 125 kHz channel, in dB (30)
+ *      -F cfo          Largest CFO of a node, in Hz (0)
+ *      -T samples      Largest timing offset of a packet, in (fractional) samples (0)
+ *      -C chance       Probability that a packet is moved to start during another node's packet (0)
+ *      -f offset       Center frequency of the channel, as in the captures in `examples/` (100e3)
+ *      -L level        Noise power in the 125 kHz channel, in dB (-50)
+ *      -S seed         Seed of the schedule and noise (1)
+ *      -g file         Write the ground truth to this file
+ *
+ *  The samples are written as interleaved 32-bit floats, to stdout for "-". Like a capture, the noise is white over the whole
+ *  sample rate, so decode them channelized at the same offset (e.g. `lora-decode -f 100e3`).
+ *  <BR>The ground truth has one packet per line, like the output of `lora-decode`: its first and end sample indices, node,
+ *  SF, CR, payload length, SNR, CFO, timing offset, whether it collided with another packet, and its payload bytes in hex.
+ */
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "traffic_generator.h"
+
+static const uint32_t block_size = 1u << 16;
+
+static void usage(const char *name) {
+    std::fprintf(stderr, "Usage: %s [-r samp_rate] [-d seconds] [-N nodes] [-p rate] [-s sf,sf,...] [-c cr] [-l min[:max]] "
+                         "[-n min[:max]] [-F cfo] [-T samples] [-C chance] [-f offset] [-L level] [-S seed] [-g truth.txt] "
+                         "output.cfile|-\n", name);
+}
+
+/**
+ *  Parse `min[:max]`, a single value sets both.
+ */
+template <typename T>
+static bool parse_range(const char *arg, T &min, T &max) {
+    char *end;
+
+    min = (T)std::strtod(arg, &end);
+    max = min;
+
+    if (end == arg)
+        return false;
+    if (*end == ':') {
+        const char *from = end + 1;
+        max = (T)std::strtod(from, &end);
+        if (end == from)
+            return false;
+    }
+
+    return *end == '\0';
+}
+
+static bool parse_sfs(const char *arg, std::vector<uint8_t> &sfs) {
+    char *end;
+
+    sfs.clear();
+    for (const char *s = arg; ; s = end + 1) {
+        sfs.push_back((uint8_t)std::strtoul(s, &end, 10));
+
+        if (end == s)
+            return false;
+        if (*end != ',')
+            return *end == '\0';
+    }
+}
+
+static bool parse(int argc, char **argv, gr::lora::traffic_config &config, const char *&output, const char *&truth) {
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:d:N:p:s:c:l:n:F:T:C:f:L:S:g:")) != -1) {
+        switch (opt) {
+            case 'r': config.samp_rate   = std::atof(optarg);                           break;
+            case 'd': config.duration    = std::atof(optarg);                           break;
+            case 'N': config.nodes       = (uint32_t)std::strtoul(optarg, nullptr, 0);  break;
+            case 'p': config.packet_rate = std::atof(optarg);                           break;
+            case 'c': config.cr          = (uint8_t)std::atoi(optarg);                  break;
+            case 'F': config.max_cfo     = std::atof(optarg);                           break;
+            case 'T': config.max_timing_offset = std::atof(optarg);                     break;
+            case 'C': config.collision_probability = std::atof(optarg);                 break;
+            case 'f': config.offset      = std::atof(optarg);                           break;
+            case 'L': config.noise_level = std::atof(optarg);                           break;
+            case 'S': config.seed        = std::strtoull(optarg, nullptr, 0);           break;
+            case 'g': truth              = optarg;                                      break;
+            case 's':
+                if (!parse_sfs(optarg, config.sfs))
+                    return false;
+                break;
+            case 'l':
+                if (!parse_range(optarg, config.min_length, config.max_length))
+                    return false;
+                break;
+            case 'n':
+                if (!parse_range(optarg, config.min_snr, config.max_snr))
+                    return false;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (optind != argc - 1)
+        return false;
+
+    output = argv[optind];
+    return true;
+}
+
+static void write_truth(const char *path, const std::vector<gr::lora::traffic_packet> &packets) {
+    FILE *out = std::fopen(path, "w");
+
+    if (!out) {
+        std::perror(path);
+        return;
+    }
+
+    for (const gr::lora::traffic_packet &p : packets) {
+        std::fprintf(out, "%llu %llu node %u SF%u CR4/%u len %zu snr %.1f cfo %.0f offset %.2f %s :",
+                     (unsigned long long)p.start, (unsigned long long)(p.start + p.samples), p.node, p.sf, 4u + p.cr,
+                     p.payload.size(), p.snr, p.cfo, p.timing_offset, p.collided ? "collided" : "clear");
+
+        for (const uint8_t byte : p.payload)
+            std::fprintf(out, " %02x", byte);
+
+        std::fputc('\n', out);
+    }
+
+    std::fclose(out);
+}
+
+int main(int argc, char **argv) {
+    gr::lora::traffic_config config;
+    const char *output = nullptr;
+    const char *truth  = nullptr;
+
+    if (!parse(argc, argv, config, output, truth)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    try {
+        gr::lora::traffic_generator generator(config);
+
+        FILE *out = std::strcmp(output, "-") == 0 ? stdout : std::fopen(output, "wb");
+        if (!out) {
+            std::perror(output);
+            return 1;
+        }
+
+        if (truth)
+            write_truth(truth, generator.packets());
+
+        std::vector<gr_complex> block(block_size);
+        uint32_t n;
+
+        while ((n = generator.generate(&block[0], block_size)) > 0u) {
+            if (std::fwrite(&block[0], sizeof(gr_complex), n, out) != n) {
+                std::perror(output);
+                return 1;
+            }
+        }
+
+        if (out != stdout)
+            std::fclose(out);
+
+        uint32_t collided = 0u;
+        for (const gr::lora::traffic_packet &p : generator.packets())
+            collided += p.collided;
+
+        std::fprintf(stderr, "%zu packets (%u collided) from %u nodes in %.2f s at %.0f S/s\n",
+                     generator.packets().size(), collided, config.nodes, config.duration, config.samp_rate);
+    } catch (const std::invalid_argument &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+
+    return 0;
+}
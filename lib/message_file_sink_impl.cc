@@ -713,9 +713,16 @@ namespace gr {
     }
 
     /*
-     * Incoming message handler
+     * Incoming message handler, for raw chirp PDUs from the decoder's debug port or plain blobs
      */
     void message_file_sink_impl::msg_handler(pmt::pmt_t msg) {
+        if (pmt::is_pair(msg)) {
+            size_t num_samples = 0u;
+            const gr_complex *samples = pmt::c32vector_elements(pmt::cdr(msg), num_samples);
+            d_file.write(reinterpret_cast<const char *>(samples), num_samples * sizeof(gr_complex));
+            return;
+        }
+
         uint32_t length = pmt::length(msg);
         // std::cout << "Writing " << length / sizeof(gr_complex) << " samples" << std::endl;
         gr_complex* raw_samples = (gr_complex *)pmt::blob_data(msg);
@@ -738,10 +738,18 @@ namespace gr {
 
         /**
          *  \brief  Handle a message and send its contents through an UDP packet to the loopback interface.
+         *          <BR>Takes the bytes of a PDU (the decoder's frames), or a blob.
          */
         void message_socket_sink_impl::handle(pmt::pmt_t msg) {
-            uint8_t *data = (uint8_t*) pmt::blob_data(msg);
-            size_t size = pmt::blob_length(msg);
+            const uint8_t *data;
+            size_t size;
+
+            if (pmt::is_pair(msg)) {
+                data = pmt::u8vector_elements(pmt::cdr(msg), size);
+            } else {
+                data = (const uint8_t*) pmt::blob_data(msg);
+                size = pmt::blob_length(msg);
+            }
 
             #ifndef NDEBUG
                 printf("Received message:\n\t");
@@ -0,0 +1,295 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/thread/thread.h>
+#include <algorithm>
+#include <pthread.h>
+#include <time.h>
+#include "multi_sf_decoder_impl.h"
+#include "kernels.h"
+#include "frame_pdu.h"
+
+namespace gr {
+    namespace lora {
+
+        multi_sf_decoder::sptr multi_sf_decoder::make(float samp_rate, const std::vector<int> &sfs, int threads, const std::string &demodulation) {
+            return gnuradio::get_initial_sptr
+                   (new multi_sf_decoder_impl(samp_rate, sfs, threads, demodulation));
+        }
+
+        /**
+         *  Sorted and unique spreading factors, so the first lane always has the shortest symbol.
+         */
+        static std::vector<int> unique_sfs(std::vector<int> sfs) {
+            std::sort(sfs.begin(), sfs.end());
+            sfs.erase(std::unique(sfs.begin(), sfs.end()), sfs.end());
+
+            if (sfs.empty()) {
+                std::cerr << "[LoRa Multi-SF Decoder] WARNING : No spreading factors given, defaulting to SF7." << std::endl;
+                sfs.push_back(7);
+            }
+
+            return sfs;
+        }
+
+        /**
+         * The private constructor
+         */
+        multi_sf_decoder_impl::multi_sf_decoder_impl(float samp_rate, const std::vector<int> &sfs, int threads, const std::string &demodulation)
+            : gr::block("multi_sf_decoder",
+                        gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                        gr::io_signature::make(0, 0, 0)),
+              d_pool(threads > 0 ? (uint32_t)threads : (uint32_t)unique_sfs(sfs).size()),
+              d_input(nullptr),
+              d_input_start(0u),
+              d_input_end(0u),
+              d_gate_pos(0u),
+              d_last_hot(0u),
+              d_threshold_margin(0.0f) {
+            const std::vector<int> lane_sfs = unique_sfs(sfs);
+
+            this->d_lanes.resize(lane_sfs.size());
+
+            for (uint32_t i = 0u; i < lane_sfs.size(); i++) {
+                sf_lane &lane = this->d_lanes[i];
+
+                lane.phy.reset(new phy_decoder(samp_rate, (uint8_t)lane_sfs[i], demodulation));
+                lane.active = false;
+                lane.pos    = 0u;
+                // Published straight from the lane's decode thread
+                lane.phy->set_frame_callback([this](const uint8_t *frame_bytes, const uint32_t frame_len, const frame_info &info) {
+                    // The input starts with the zeroes the history is preloaded with
+                    frame_info stream_info       = info;
+                    stream_info.preamble_index  -= this->history() - 1u;
+                    stream_info.end_index       -= this->history() - 1u;
+
+                    this->message_port_pub(pmt::mp("frames"), make_frame_pdu(frame_bytes, frame_len, stream_info));
+                });
+            }
+
+            // GNU Radio sizes an input buffer to at least twice the history of the block reading it.
+            // The lanes decode straight from that buffer and never hold back more than 3 symbols of the largest SF.
+            this->set_history(2u * this->d_lanes.back().phy->samples_per_symbol());
+
+            this->d_gate_window      = std::max(1u, this->d_lanes[0].phy->samples_per_symbol() / 4u);
+            this->d_energy_threshold = this->d_lanes[0].phy->abs_threshold();
+            this->d_tasks.reserve(this->d_lanes.size());
+
+            // Register gnuradio ports
+            this->message_port_register_out(pmt::mp("frames"));
+        }
+
+        /**
+         * Our virtual destructor.
+         */
+        multi_sf_decoder_impl::~multi_sf_decoder_impl() {
+        }
+
+        void multi_sf_decoder_impl::run_gate() {
+            const uint64_t end   = this->d_input_end;
+            const float    fixed = this->d_energy_threshold * this->d_energy_threshold;
+
+            for (; this->d_gate_pos + this->d_gate_window <= end; this->d_gate_pos += this->d_gate_window) {
+                const float energy = gr::lora::kernels::energy(&this->d_input[this->d_gate_pos - this->d_input_start], this->d_gate_window);
+                float threshold    = fixed;
+
+                if (this->d_threshold_margin > 0.0f) {
+                    this->d_noise_floor.update(energy);
+                    threshold = this->d_noise_floor.threshold(this->d_threshold_margin);
+                    threshold *= threshold;
+                }
+
+                if (energy < threshold)
+                    continue;
+
+                this->d_last_hot = this->d_gate_pos + this->d_gate_window;
+
+                // Start one window early, the preamble could have begun below the threshold
+                const uint64_t start = std::max(this->d_input_start, this->d_gate_pos - std::min<uint64_t>(this->d_gate_pos, this->d_gate_window));
+
+                for (sf_lane &lane : this->d_lanes) {
+                    if (!lane.active) {
+                        lane.active = true;
+                        lane.pos    = start;
+                    }
+                }
+            }
+        }
+
+        bool multi_sf_decoder_impl::lane_idle(const sf_lane &lane) const {
+            return lane.phy->state() == gr::lora::DecoderState::DETECT
+                && lane.pos >= this->d_last_hot;
+        }
+
+        void multi_sf_decoder_impl::run_lane(sf_lane &lane) {
+            const uint64_t end = this->d_input_end;
+
+            // Lanes skip what the gate deems silent, keep their frame indices in stream samples
+            if (lane.phy->position() != lane.pos)
+                lane.phy->set_position(lane.pos);
+
+            while (!this->lane_idle(lane)) {
+                if (lane.pos + lane.phy->samples_needed() > end)
+                    return;
+
+                const gr_complex *input = &this->d_input[lane.pos - this->d_input_start];
+                lane.pos += lane.phy->process(input, input);
+            }
+
+            lane.active = false;
+        }
+
+        void multi_sf_decoder_impl::forecast(int noutput_items, gr_vector_int &ninput_items_required) {
+            (void) noutput_items;
+
+            // The next gate window, or the next step of an active lane, whichever comes first
+            uint64_t needed = this->d_gate_pos + this->d_gate_window;
+
+            for (const sf_lane &lane : this->d_lanes) {
+                if (lane.active) {
+                    needed = std::min(needed, lane.pos + lane.phy->samples_needed());
+                }
+            }
+
+            ninput_items_required[0] = (int)(needed - this->nitems_read(0));
+        }
+
+        int multi_sf_decoder_impl::general_work(int noutput_items,
+                                                gr_vector_int &ninput_items,
+                                                gr_vector_const_void_star& input_items,
+                                                gr_vector_void_star&       output_items) {
+            (void) noutput_items;
+            (void) output_items;
+
+            this->d_input       = (const gr_complex *) input_items[0];
+            this->d_input_start = this->nitems_read(0);
+            this->d_input_end   = this->d_input_start + (uint64_t)ninput_items[0];
+
+            this->run_gate();
+
+            // Only the lanes woken up by the gate cost anything
+            this->d_tasks.clear();
+            for (sf_lane &lane : this->d_lanes) {
+                if (lane.active) {
+                    this->d_tasks.push_back(std::bind(&multi_sf_decoder_impl::run_lane, this, std::ref(lane)));
+                }
+            }
+            this->d_pool.run(this->d_tasks);
+
+            // Keep what the active lanes still need, plus one gate window to start woken lanes from
+            uint64_t keep = this->d_gate_pos - std::min<uint64_t>(this->d_gate_pos - this->d_input_start, this->d_gate_window);
+
+            for (const sf_lane &lane : this->d_lanes) {
+                if (lane.active) {
+                    keep = std::min(keep, lane.pos);
+                }
+            }
+
+            this->consume_each((int)(keep - this->d_input_start));
+
+            // No outputs, only messages
+            return 0;
+        }
+
+        /**
+         *  CPU time of the given thread, 0 if it is not running.
+         */
+        static double thread_cpu_seconds(std::thread &thread) {
+            clockid_t       clock;
+            struct timespec ts;
+
+            if (!thread.joinable() || pthread_getcpuclockid(thread.native_handle(), &clock) != 0 || clock_gettime(clock, &ts) != 0)
+                return 0.0;
+
+            return ts.tv_sec + ts.tv_nsec / 1e9;
+        }
+
+        void multi_sf_decoder_impl::set_processor_affinity(const std::vector<int> &mask) {
+            gr::block::set_processor_affinity(mask);
+
+            for (sf_lane &lane : this->d_lanes) {
+                if (lane.phy->decode_thread().joinable()) {
+                    gr::thread::thread_bind_to_processor(lane.phy->decode_thread().native_handle(), mask);
+                }
+            }
+
+            for (std::thread &worker : this->d_pool.workers()) {
+                gr::thread::thread_bind_to_processor(worker.native_handle(), mask);
+            }
+        }
+
+        double multi_sf_decoder_impl::decode_cpu_seconds() {
+            double total = 0.0;
+
+            for (sf_lane &lane : this->d_lanes) {
+                total += thread_cpu_seconds(lane.phy->decode_thread());
+            }
+
+            for (std::thread &worker : this->d_pool.workers()) {
+                total += thread_cpu_seconds(worker);
+            }
+
+            return total;
+        }
+
+        void multi_sf_decoder_impl::set_abs_threshold(const float threshold) {
+            for (sf_lane &lane : this->d_lanes) {
+                lane.phy->set_abs_threshold(threshold);
+            }
+
+            this->d_energy_threshold = this->d_lanes[0].phy->abs_threshold();
+        }
+
+        void multi_sf_decoder_impl::set_threshold_margin(const float margin_db) {
+            for (sf_lane &lane : this->d_lanes) {
+                lane.phy->set_threshold_margin(margin_db);
+            }
+
+            this->d_threshold_margin = this->d_lanes[0].phy->threshold_margin();
+            this->d_noise_floor.reset();
+        }
+
+        void multi_sf_decoder_impl::set_crc_check(const std::string &check) {
+            CrcCheck parsed;
+
+            if (!frame_decoder::parse_crc_check(check, parsed)) {
+                std::cerr << "[LoRa Decoder] WARNING : Unknown CRC check \"" << check << "\", expected off, flag or drop." << std::endl
+                          << "Nothing set." << std::endl;
+                return;
+            }
+
+            for (sf_lane &lane : this->d_lanes) {
+                lane.phy->set_crc_check(parsed);
+            }
+        }
+
+        void multi_sf_decoder_impl::set_header_check(const bool check) {
+            for (sf_lane &lane : this->d_lanes) {
+                lane.phy->set_header_check(check);
+            }
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,185 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_LORA_MULTI_SF_DECODER_IMPL_H
+#define INCLUDED_LORA_MULTI_SF_DECODER_IMPL_H
+
+#include "lora/multi_sf_decoder.h"
+#include "phy_decoder.h"
+#include "thread_pool.h"
+#include <memory>
+#include <vector>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **LoRa Multi-SF Decoder**
+         *          <BR>Runs one `phy_decoder` per spreading factor on the same input.
+         *          <BR>A shared energy gate keeps every decoder asleep while the channel is idle.
+         *          When the gate fires, the sleeping decoders are woken up at the gated position
+         *          and run concurrently on the thread pool until they are back in `DecoderState::DETECT`
+         *          and have left the signal behind.
+         */
+        class multi_sf_decoder_impl : public multi_sf_decoder {
+            private:
+                /**
+                 *  \brief  State of one spreading factor.
+                 */
+                struct sf_lane {
+                    std::unique_ptr<phy_decoder> phy;
+                    bool                         active;   ///< Whether the decoder is being fed samples.
+                    uint64_t                     pos;      ///< Absolute index of the next sample to process.
+                };
+
+                std::vector<sf_lane>    d_lanes;
+                thread_pool             d_pool;
+                std::vector<std::function<void()>> d_tasks;     ///< Reused task list for `d_pool`.
+
+                const gr_complex       *d_input;                ///< The input of the current `general_work`, only consumed up to what the active lanes still need.
+                uint64_t                d_input_start;          ///< Absolute index of `d_input[0]`.
+                uint64_t                d_input_end;            ///< Absolute index just after the last sample in `d_input`.
+                uint64_t                d_gate_pos;             ///< Absolute index of the next gate window.
+                uint64_t                d_last_hot;             ///< Absolute index just after the last window with energy.
+                uint32_t                d_gate_window;          ///< Size of a gate window (a quarter of the smallest symbol).
+                float                   d_energy_threshold;     ///< Absolute threshold, shared with every lane.
+                float                   d_threshold_margin;     ///< Margin in dB of the gate above `d_noise_floor`, 0 to use `d_energy_threshold`.
+                noise_floor             d_noise_floor;          ///< Average power of the gate windows.
+
+                /**
+                 *  \brief  Move the gate over all new samples and wake up the sleeping lanes on energy.
+                 */
+                void run_gate();
+
+                /**
+                 *  \brief  Feed a lane all samples it can currently process.
+                 *
+                 *  \param  lane
+                 *          The lane to run.
+                 */
+                void run_lane(sf_lane &lane);
+
+                /**
+                 *  \brief  Whether a lane in `DecoderState::DETECT` has nothing left to look at.
+                 *
+                 *  \param  lane
+                 *          The lane to check.
+                 */
+                bool lane_idle(const sf_lane &lane) const;
+
+            public:
+                /**
+                 *  \brief  Default ctor.
+                 *
+                 *  \param  samp_rate
+                 *          The sample rate of the input signal given to `work` later.
+                 *  \param  sfs
+                 *          The spreading factors to decode.
+                 *  \param  threads
+                 *          Amount of decoding threads, 0 for one per spreading factor.
+                 *  \param  demodulation
+                 *          The demodulation strategy of every lane, see `demodulator::make`.
+                 */
+                multi_sf_decoder_impl(float samp_rate, const std::vector<int> &sfs, int threads, const std::string &demodulation);
+
+                /**
+                 *  Default dtor.
+                 */
+                ~multi_sf_decoder_impl();
+
+                /**
+                 *  \brief  Tell GNU Radio how many samples the gate or an active lane needs for its next step.
+                 *
+                 *  \param  noutput_items
+                 *          Unused, the decoder has no outputs.
+                 *  \param  ninput_items_required
+                 *          The required amount of samples on each input.
+                 */
+                void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+
+                /**
+                *   \brief  The main method called by GNU Radio to perform tasks on the given input.
+                *           <BR>Only consumes the samples every active lane is done with, the rest stays in the input buffer.
+                *
+                *   \param  noutput_items
+                *           Unused, the decoder has no outputs.
+                *   \param  ninput_items
+                *           The amount of samples available on each input.
+                *   \param  input_items
+                *           An array with samples to process.
+                *   \param  output_items
+                *           Unused, the decoder has no outputs.
+                *   \return Returns the amount of output items generated, always 0.
+                */
+                int general_work(int noutput_items,
+                                 gr_vector_int &ninput_items,
+                                 gr_vector_const_void_star& input_items,
+                                 gr_vector_void_star& output_items);
+
+                /**
+                 *  \brief  Pin the block thread, and with it every thread decoding for it: the payload thread of each lane
+                 *          and the workers of the pool.
+                 *
+                 *  \param  mask
+                 *          The CPU cores to run on.
+                 */
+                void set_processor_affinity(const std::vector<int> &mask);
+
+                /**
+                 *  \brief  Return the CPU time of the threads decoding for the block, which its performance counters miss.
+                 */
+                double decode_cpu_seconds();
+
+                /**
+                 *  \brief  Set the absolute threshold of the gate and of every decoder.
+                 *
+                 *  \param  threshold
+                 *          The new threshold value.
+                 */
+                virtual void set_abs_threshold(const float threshold);
+
+                /**
+                 *  \brief  Keep the gate and every decoder the given margin above their tracked noise floor.
+                 *
+                 *  \param  margin_db
+                 *          The margin in dB, 0 to use the absolute threshold.
+                 */
+                virtual void set_threshold_margin(const float margin_db);
+
+                /**
+                 *  \brief  Set what to do with the payload CRC of each frame, for every decoder.
+                 *
+                 *  \param  check
+                 *          `"off"`, `"flag"` or `"drop"`, see `CrcCheck`.
+                 */
+                virtual void set_crc_check(const std::string &check);
+
+                /**
+                 *  \brief  Set whether every decoder checks the HDR checksum.
+                 *
+                 *  \param  check
+                 *          Whether to check, on by default.
+                 */
+                virtual void set_header_check(const bool check);
+        };
+    } // namespace lora
+} // namespace gr
+
+#endif /* INCLUDED_LORA_MULTI_SF_DECODER_IMPL_H */
@@ -0,0 +1,203 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/blocks/stream_to_streams.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/filter/pfb_channelizer_ccf.h>
+#include <gnuradio/filter/freq_xlating_fir_filter_ccf.h>
+#include <gnuradio/filter/fractional_resampler_cc.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "multichannel_receiver_impl.h"
+
+namespace gr {
+    namespace lora {
+
+        multichannel_receiver::sptr multichannel_receiver::make(float samp_rate,
+                                                                double center_freq,
+                                                                double channel_spacing,
+                                                                const std::vector<double> &channel_freqs,
+                                                                const std::vector<int> &sfs,
+                                                                float out_samp_rate,
+                                                                const std::vector<int> &cores,
+                                                                const std::string &demodulation) {
+            return gnuradio::get_initial_sptr
+                   (new multichannel_receiver_impl(samp_rate, center_freq, channel_spacing, channel_freqs, sfs, out_samp_rate, cores, demodulation));
+        }
+
+        /**
+         * The private constructor
+         */
+        multichannel_receiver_impl::multichannel_receiver_impl(float samp_rate,
+                                                               double center_freq,
+                                                               double channel_spacing,
+                                                               const std::vector<double> &channel_freqs,
+                                                               const std::vector<int> &sfs,
+                                                               float out_samp_rate,
+                                                               const std::vector<int> &cores,
+                                                               const std::string &demodulation)
+            : gr::hier_block2("multichannel_receiver",
+                              gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                              gr::io_signature::make(0, 0, 0)) {
+            const double   bw          = 125000.0;
+            const uint32_t bins        = std::max(1u, (uint32_t)std::lround(samp_rate / channel_spacing));
+            const double   bin_spacing = (double)samp_rate / bins;
+            // The channelizer can only oversample by a divisor of the amount of bins
+            const uint32_t oversample  = (bins % 2u == 0u) ? 2u : 1u;
+            const double   chan_rate   = bin_spacing * oversample;
+
+            if (std::abs(bin_spacing - channel_spacing) > 1.0) {
+                std::cerr << "[LoRa Multichannel Receiver] WARNING : Sample rate is not a multiple of the channel spacing, using "
+                          << bins << " bins of " << bin_spacing << " Hz." << std::endl;
+            }
+
+            // Map every requested channel on a bin, the remainder is shifted out per channel
+            std::vector<int>    bin_map;
+            std::vector<double> residuals;
+            std::vector<double> freqs = channel_freqs;
+
+            if (freqs.empty()) {
+                for (uint32_t i = 0u; i < bins; i++) {
+                    const int32_t bin = (int32_t)i - (int32_t)(i > bins / 2u ? bins : 0u);
+                    freqs.push_back(center_freq + bin * bin_spacing);
+                }
+            }
+
+            for (const double freq : freqs) {
+                const int32_t bin = (int32_t)std::lround((freq - center_freq) / bin_spacing);
+
+                if (2u * (uint32_t)std::abs(bin) > bins) {
+                    std::cerr << "[LoRa Multichannel Receiver] WARNING : Channel at " << freq << " Hz is outside of the captured band, skipped." << std::endl;
+                    continue;
+                }
+
+                const int pfb_bin = (int)((bin + (int32_t)bins) % (int32_t)bins);
+
+                if (std::find(bin_map.begin(), bin_map.end(), pfb_bin) != bin_map.end()) {
+                    std::cerr << "[LoRa Multichannel Receiver] WARNING : Channel at " << freq << " Hz shares a bin with another channel, skipped." << std::endl;
+                    continue;
+                }
+
+                bin_map.push_back(pfb_bin);
+                residuals.push_back(freq - center_freq - bin * bin_spacing);
+                this->d_channel_freqs.push_back(freq);
+            }
+
+            if (bin_map.empty()) {
+                throw std::invalid_argument("[LoRa Multichannel Receiver] ERROR : None of the requested channels lie within the captured band!");
+            }
+
+            // Keep the 125 kHz channel, stop where the neighbouring channel's signal starts
+            const double transition = std::max(bin_spacing - bw, 0.1 * bw);
+            const std::vector<float> taps = gr::filter::firdes::low_pass_2(1.0, samp_rate, bw / 2.0 + transition / 2.0, transition,
+                                                                           60.0, gr::filter::firdes::WIN_BLACKMAN_hARRIS);
+
+            gr::blocks::stream_to_streams::sptr    s2ss        = gr::blocks::stream_to_streams::make(sizeof(gr_complex), bins);
+            gr::filter::pfb_channelizer_ccf::sptr  channelizer = gr::filter::pfb_channelizer_ccf::make(bins, taps, oversample);
+            channelizer->set_channel_map(bin_map);
+
+            this->d_front_end.push_back(s2ss);
+            this->d_front_end.push_back(channelizer);
+
+            this->connect(this->self(), 0, s2ss, 0);
+            for (uint32_t i = 0u; i < bins; i++) {
+                this->connect(s2ss, i, channelizer, i);
+            }
+
+            this->message_port_register_hier_out(pmt::mp("frames"));
+
+            for (uint32_t ch = 0u; ch < bin_map.size(); ch++) {
+                std::vector<gr::block_sptr> chain;
+
+                if (std::abs(residuals[ch]) > 1.0) {
+                    chain.push_back(gr::filter::freq_xlating_fir_filter_ccf::make(1, std::vector<float>(1, 1.0f), residuals[ch], chan_rate));
+                }
+
+                chain.push_back(gr::filter::fractional_resampler_cc::make(0.0f, (float)(chan_rate / out_samp_rate)));
+
+                // A single demodulating thread: the channel's own block thread, which gets pinned below with the payload threads
+                multi_sf_decoder::sptr decoder = multi_sf_decoder::make(out_samp_rate, sfs, 1, demodulation);
+                chain.push_back(decoder);
+
+                this->connect(channelizer, ch, chain[0], 0);
+                for (uint32_t i = 1u; i < chain.size(); i++) {
+                    this->connect(chain[i - 1u], 0, chain[i], 0);
+                }
+                this->msg_connect(decoder, "frames", this->self(), "frames");
+
+                if (!cores.empty()) {
+                    const std::vector<int> core(1, cores[ch % cores.size()]);
+
+                    for (gr::block_sptr &block : chain) {
+                        block->set_processor_affinity(core);
+                    }
+                }
+
+                this->d_decoders.push_back(decoder);
+                this->d_chains.push_back(chain);
+            }
+        }
+
+        /**
+         * Our virtual destructor.
+         */
+        multichannel_receiver_impl::~multichannel_receiver_impl() {
+        }
+
+        size_t multichannel_receiver_impl::num_channels() const {
+            return this->d_channel_freqs.size();
+        }
+
+        double multichannel_receiver_impl::channel_freq(size_t channel) const {
+            return this->d_channel_freqs.at(channel);
+        }
+
+        void multichannel_receiver_impl::set_abs_threshold(float threshold) {
+            for (multi_sf_decoder::sptr &decoder : this->d_decoders) {
+                decoder->set_abs_threshold(threshold);
+            }
+        }
+
+        void multichannel_receiver_impl::set_threshold_margin(float margin_db) {
+            for (multi_sf_decoder::sptr &decoder : this->d_decoders) {
+                decoder->set_threshold_margin(margin_db);
+            }
+        }
+
+        void multichannel_receiver_impl::set_crc_check(const std::string &check) {
+            for (multi_sf_decoder::sptr &decoder : this->d_decoders) {
+                decoder->set_crc_check(check);
+            }
+        }
+
+        void multichannel_receiver_impl::set_header_check(bool check) {
+            for (multi_sf_decoder::sptr &decoder : this->d_decoders) {
+                decoder->set_header_check(check);
+            }
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
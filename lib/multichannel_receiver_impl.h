@@ -0,0 +1,113 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_LORA_MULTICHANNEL_RECEIVER_IMPL_H
+#define INCLUDED_LORA_MULTICHANNEL_RECEIVER_IMPL_H
+
+#include "lora/multichannel_receiver.h"
+#include "lora/multi_sf_decoder.h"
+#include <gnuradio/block.h>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **LoRa Multichannel Receiver**
+         *          <BR>`stream_to_streams` -> `pfb_channelizer_ccf` -> per channel:
+         *          <BR>(`freq_xlating_fir_filter_ccf` for an off-grid channel) -> `fractional_resampler_cc` -> `multi_sf_decoder`.
+         */
+        class multichannel_receiver_impl : public multichannel_receiver {
+            private:
+                std::vector<double>                      d_channel_freqs;   ///< Frequency of each decoded channel.
+                std::vector<multi_sf_decoder::sptr>      d_decoders;        ///< Decoder of each channel.
+                std::vector<std::vector<gr::block_sptr>> d_chains;          ///< All blocks working on a single channel, per channel.
+                std::vector<gr::block_sptr>              d_front_end;       ///< The blocks shared by every channel.
+
+            public:
+                /**
+                 *  \brief  Default ctor, see `multichannel_receiver::make`.
+                 */
+                multichannel_receiver_impl(float samp_rate,
+                                           double center_freq,
+                                           double channel_spacing,
+                                           const std::vector<double> &channel_freqs,
+                                           const std::vector<int> &sfs,
+                                           float out_samp_rate,
+                                           const std::vector<int> &cores,
+                                           const std::string &demodulation);
+
+                /**
+                 *  Default dtor.
+                 */
+                ~multichannel_receiver_impl();
+
+                size_t num_channels() const;
+                double channel_freq(size_t channel) const;
+
+                /**
+                 *  \brief  Set the absolute threshold of every channel's decoder.
+                 *
+                 *  \param  threshold
+                 *          The new threshold value.
+                 */
+                void set_abs_threshold(float threshold);
+                void set_threshold_margin(float margin_db);
+
+                /**
+                 *  \brief  Set what to do with the payload CRC of each frame, on every channel.
+                 *
+                 *  \param  check
+                 *          `"off"`, `"flag"` or `"drop"`.
+                 */
+                void set_crc_check(const std::string &check);
+
+                /**
+                 *  \brief  Set whether every channel checks the HDR checksum.
+                 *
+                 *  \param  check
+                 *          Whether to check, on by default.
+                 */
+                void set_header_check(bool check);
+
+                /**
+                 *  \brief  Return the decoder of the given channel.
+                 *
+                 *  \param  channel
+                 *          The index of the channel.
+                 */
+                const multi_sf_decoder::sptr& channel_decoder(size_t channel) const { return this->d_decoders[channel]; }
+
+                /**
+                 *  \brief  Return the blocks working on only the given channel, e.g. to read their performance counters.
+                 *
+                 *  \param  channel
+                 *          The index of the channel.
+                 */
+                const std::vector<gr::block_sptr>& channel_blocks(size_t channel) const { return this->d_chains[channel]; }
+
+                /**
+                 *  \brief  Return the blocks shared by all channels (the channelizer).
+                 */
+                const std::vector<gr::block_sptr>& front_end_blocks() const { return this->d_front_end; }
+        };
+    } // namespace lora
+} // namespace gr
+
+#endif /* INCLUDED_LORA_MULTICHANNEL_RECEIVER_IMPL_H */
@@ -0,0 +1,85 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef NOISE_FLOOR_H
+#define NOISE_FLOOR_H
+
+#include <algorithm>
+#include <cmath>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Noise floor** : Tracks the average sample power of the noise with an asymmetric EWMA of window energies.
+         *          <BR>It follows quieter windows quickly, but only creeps up on louder ones, each capped at `rise_cap`
+         *          times the floor. A burst or a frame hardly moves it, while a band that really got noisier
+         *          doubles the floor in some 50 windows.
+         */
+        class noise_floor {
+            private:
+                float d_floor;      ///< Current estimate, 0 before the first window.
+
+            public:
+                static constexpr float fall     = 1.0f / 8.0f;     ///< Weight of a window below the floor.
+                static constexpr float rise     = 1.0f / 64.0f;    ///< Weight of a window above the floor.
+                static constexpr float rise_cap = 2.0f;            ///< A louder window counts as at most this times the floor.
+
+                noise_floor() : d_floor(0.0f) {}
+
+                /**
+                 *  \brief  Add the energy of the next window, the first one seeds the floor.
+                 *
+                 *  \param  energy
+                 *          Average sample power of the window.
+                 */
+                void update(const float energy) {
+                    if (this->d_floor <= 0.0f) {
+                        this->d_floor = energy;
+                    } else if (energy < this->d_floor) {
+                        this->d_floor += fall * (energy - this->d_floor);
+                    } else {
+                        this->d_floor += rise * (std::min(energy, rise_cap * this->d_floor) - this->d_floor);
+                    }
+                }
+
+                /**
+                 *  \brief  Forget the estimate, the next window seeds it again.
+                 */
+                void reset() { this->d_floor = 0.0f; }
+
+                /**
+                 *  \brief  Return the absolute (amplitude) threshold the given margin above the floor.
+                 *
+                 *  \param  margin_db
+                 *          The margin in dB, on the power.
+                 */
+                float threshold(const float margin_db) const {
+                    return std::sqrt(this->d_floor * std::pow(10.0f, margin_db / 10.0f));
+                }
+
+                float power()    const { return this->d_floor; }
+                float power_db() const { return 10.0f * std::log10(std::max(this->d_floor, 1e-20f)); }
+        };
+
+    } // namespace lora
+} // namespace gr
+
+#endif /* NOISE_FLOOR_H */
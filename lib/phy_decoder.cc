@@ -0,0 +1,827 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <liquid/liquid.h>
+#include <numeric>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <stdexcept>
+#include "phy_decoder.h"
+#include "frame_decoder.h"
+#include "demodulator.h"
+#include "tables.h"
+#include "utilities.h"
+#include "kernels.h"
+#include "trace.h"
+
+//#define CFO_CORRECT   1   /// Correct shift fft estimation
+
+#include "dbugr.hpp"
+
+namespace gr {
+    namespace lora {
+
+        phy_decoder::phy_decoder(float samp_rate, uint8_t sf, const std::string &demodulation, bool decode_thread) {
+            this->d_state = gr::lora::DecoderState::DETECT;
+
+            if (sf < 6 || sf > 12)
+                throw std::invalid_argument("[LoRa Decoder] ERROR : Spreading factor should be between 6 and 12 (inclusive)!");
+
+            // Set whitening sequence
+            this->d_whitening_sequence = gr::lora::payload_whitening_sequence(sf, &this->d_whitening_length, true);
+
+            if (sf == 6) {
+                std::cerr << "[LoRa Decoder] WARNING : Spreading factor wrapped around to 12 due to incompatibility in hardware!" << std::endl;
+                sf = 12;
+            }
+
+            this->d_bw                 = 125000u;
+            this->d_cr                 = 4;
+            this->d_samples_per_second = samp_rate;
+            this->d_corr_decim_factor  = 8u; // samples_per_symbol / corr_decim_factor = correlation window. Also serves as preamble decimation factor
+            this->d_payload_symbols    = 0;
+            this->d_cfo_estimation     = 0.0f;
+            this->d_dt                 = 1.0f / this->d_samples_per_second;
+
+            this->d_sf                 = sf;  // Only affects PHY send
+            this->d_bits_per_second    = (double)this->d_sf * (double)(1u + this->d_cr) / (1u << this->d_sf) * this->d_bw;
+            this->d_symbols_per_second = (double)this->d_bw / (1u << this->d_sf);
+            this->d_bits_per_symbol    = (uint32_t)(this->d_bits_per_second    / this->d_symbols_per_second);
+            this->d_samples_per_symbol = (uint32_t)(this->d_samples_per_second / this->d_symbols_per_second);
+            this->d_delay_after_sync   = this->d_samples_per_symbol / 4u;
+            this->d_number_of_bins     = (uint32_t)(1u << this->d_sf);
+            this->d_number_of_bins_hdr = this->d_number_of_bins / 4u;
+            this->d_decim_factor       = this->d_samples_per_symbol / this->d_number_of_bins;
+
+            this->d_energy_threshold   = 0.01f;
+            this->d_abs_threshold      = this->d_energy_threshold;
+            this->d_threshold_margin   = 0.0f;
+            this->d_threshold_changed  = false;
+            this->d_applied_margin     = 0.0f;
+            this->d_detect_symbols     = 0u;
+            this->d_correlations       = 0u;
+            this->d_header_check       = true;
+            this->d_header_failures    = 0u;
+            this->d_symbols_saved      = 0u;
+
+            // Some preparations
+            LORA_TRACE(DEMOD, INFO, "Bits per symbol: "        << this->d_bits_per_symbol);
+            LORA_TRACE(DEMOD, INFO, "Bins per symbol: "        << this->d_number_of_bins);
+            LORA_TRACE(DEMOD, INFO, "Header bins per symbol: " << this->d_number_of_bins_hdr);
+            LORA_TRACE(DEMOD, INFO, "Samples per symbol: "     << this->d_samples_per_symbol);
+            LORA_TRACE(DEMOD, INFO, "Decimation: "             << this->d_decim_factor);
+
+            this->build_ideal_chirps();
+
+            // All per-symbol scratch memory, so processing a symbol never allocates or grows the stack
+            const uint32_t sps = this->d_samples_per_symbol;
+
+            this->d_workspace.allocate(workspace::bytes_for<gr_complex>(sps)                      // d_ws_symbol
+                                     + workspace::bytes_for<float>(2u * sps)                      // d_ws_ifreq
+                                     + workspace::bytes_for<uint8_t>(this->d_sf));                // d_ws_words
+
+            this->d_ws_symbol  = this->d_workspace.take<gr_complex>(sps);
+            this->d_ws_ifreq   = this->d_workspace.take<float>(2u * sps);
+            this->d_ws_words   = this->d_workspace.take<uint8_t>(this->d_sf);
+
+            this->d_demodulator = demodulator::make(demodulation, sps, this->d_number_of_bins,
+                                                    &this->d_downchirp_conj[0], &this->d_upchirp[0]);
+
+            // Four windows per symbol, or one if the symbol does not split evenly
+            this->d_preamble_detector.reset(new preamble_detector(sps, this->d_number_of_bins, &this->d_downchirp_conj[0],
+                                                                  sps % 4u == 0u ? sps / 4u : sps));
+            this->d_preamble_detector->set_energy_threshold(this->d_energy_threshold);
+            this->d_preamble_detection = PreambleDetection::STREAMING;
+            this->d_position           = 0u;
+            this->d_preamble_index     = 0u;
+            this->d_snr                = 0.0f;
+
+            this->d_frame_decoder.reset(new frame_decoder(this->d_sf, this->d_whitening_sequence, decode_thread));
+
+            LORA_TRACE(DEMOD, INFO, "Memory footprint: " << this->memory_footprint() << " bytes");
+
+            // Decimation filter
+            const int delay             = 2;
+            const int decim_filter_size = (2 * this->d_decim_factor * delay + 1);
+            float g[decim_filter_size];
+            float d_decim_h[decim_filter_size]; ///< The reversed decimation filter for LiquidDSP.
+            liquid_firdes_rrcos(this->d_decim_factor, delay, 0.5f, 0.3f, g); // Filter for interpolating
+
+            for (uint32_t i = 0u; i < decim_filter_size; i++) // Reverse it to get decimation filter
+                d_decim_h[i] = g[decim_filter_size - i - 1u];
+
+            this->d_decim = firdecim_crcf_create(this->d_decim_factor, d_decim_h, decim_filter_size);
+
+            // Whitening empty file
+//            DBGR_QUICK_TO_FILE("/tmp/whitening_out", false, g, -1, "");
+        }
+
+        phy_decoder::~phy_decoder() {
+            firdecim_crcf_destroy(this->d_decim);
+        }
+
+        void phy_decoder::build_ideal_chirps(void) {
+            this->d_downchirp.resize(this->d_samples_per_symbol);
+            this->d_downchirp_conj.resize(this->d_samples_per_symbol);
+            this->d_upchirp.resize(this->d_samples_per_symbol);
+            this->d_downchirp_ifreq.resize(this->d_samples_per_symbol);
+            this->d_upchirp_ifreq.resize(this->d_samples_per_symbol);
+
+            const double T       = -0.5 * this->d_bw * this->d_symbols_per_second;
+            const double f0      = (this->d_bw / 2.0);
+            const double pre_dir = 2.0 * M_PI;
+            double t;
+            gr_complex cmx       = gr_complex(1.0f, 1.0f);
+
+            for (uint32_t i = 0u; i < this->d_samples_per_symbol; i++) {
+                // Width in number of samples = samples_per_symbol
+                // See https://en.wikipedia.org/wiki/Chirp#Linear
+                t = this->d_dt * i;
+                this->d_downchirp[i] = cmx * std::polar(1.0f, (float)(pre_dir * t * (f0 + T * t)));
+                this->d_upchirp[i]   = cmx * std::polar(1.0f, (float)(pre_dir * t * (f0 + T * t) * -1.0f));
+                this->d_downchirp_conj[i] = std::conj(this->d_downchirp[i]);
+            }
+
+            // Store instant. frequency
+            this->instantaneous_frequency(&this->d_downchirp[0], &this->d_downchirp_ifreq[0], this->d_samples_per_symbol);
+            this->instantaneous_frequency(&this->d_upchirp[0],   &this->d_upchirp_ifreq[0],   this->d_samples_per_symbol);
+
+            this->d_upchirp_correlator.set_ideal(&this->d_upchirp_ifreq[0], this->d_samples_per_symbol - 1u);
+
+            LORA_TRACE_SAMPLES("downchirp", &this->d_downchirp[0], this->d_samples_per_symbol);
+            LORA_TRACE_SAMPLES("upchirp",   &this->d_upchirp[0],   this->d_samples_per_symbol);
+        }
+
+        /**
+         *  Currently unused.
+         */
+        bool phy_decoder::calc_energy_threshold(const gr_complex *samples, const uint32_t window_size, const float threshold) {
+            const float result = gr::lora::kernels::energy(samples, window_size);
+
+            LORA_TRACE(DETECT, VERBOSE, "T: " << result);
+
+            return result > threshold;
+        }
+
+        inline void phy_decoder::instantaneous_frequency(const gr_complex *in_samples, float *out_ifreq, const uint32_t window) {
+            if (window < 2u) {
+                std::cerr << "[LoRa Decoder] WARNING : window size < 2 !" << std::endl;
+                return;
+            }
+
+            gr::lora::kernels::instantaneous_frequency(in_samples, out_ifreq, window);
+        }
+
+        /**
+         *  Currently unused.
+         */
+        inline void phy_decoder::instantaneous_phase(const gr_complex *in_samples, float *out_iphase, const uint32_t window) {
+            out_iphase[0] = std::arg(in_samples[0]);
+
+            for (uint32_t i = 1u; i < window; i++) {
+                out_iphase[i] = std::arg(in_samples[i]);
+                // = the same as atan2(imag(in_samples[i]),real(in_samples[i]));
+
+                // Unwrapped loops from liquid_unwrap_phase
+                while ( (out_iphase[i] - out_iphase[i-1]) >  M_PI ) out_iphase[i] -= 2.0f*M_PI;
+                while ( (out_iphase[i] - out_iphase[i-1]) < -M_PI ) out_iphase[i] += 2.0f*M_PI;
+            }
+        }
+
+        /**
+         *  Currently unused.
+         */
+        float phy_decoder::cross_correlate(const gr_complex *samples_1, const gr_complex *samples_2, const uint32_t window) {
+            float result = 0.0f;
+
+            for (uint32_t i = 0u; i < window; i++) {
+                result += std::real(samples_1[i] * std::conj(samples_2[i]));
+            }
+
+            result /= (float)window;
+
+            return result;
+        }
+
+        /**
+         *  Calculate normalized cross correlation of real values.
+         *  See https://en.wikipedia.org/wiki/Cross-correlation#Normalized_cross-correlation.
+         */
+        float phy_decoder::cross_correlate_ifreq(const float *samples_ifreq, const std::vector<float>& ideal_chirp, const uint32_t to_idx) {
+            return gr::lora::kernels::cross_correlate_ifreq(samples_ifreq, &ideal_chirp[0], to_idx);
+        }
+
+        float phy_decoder::detect_downchirp(const gr_complex *samples, const uint32_t window) {
+            float *samples_ifreq = this->d_ws_ifreq;
+            this->instantaneous_frequency(samples, samples_ifreq, window);
+
+            return this->cross_correlate_ifreq(samples_ifreq, this->d_downchirp_ifreq, window - 1u);
+        }
+
+        /**
+         *  1. Skip through the window and look for a falling edge
+         *  2. Get the upper and lower bound of the upchrip edge, or the local maximum and minimum
+         *  3. Look for the highest cross correlation index between these points and return
+         */
+        float phy_decoder::sliding_norm_cross_correlate_upchirp(const float *samples_ifreq, const uint32_t window, int32_t *index) {
+            bool found_change      = false;
+            uint32_t local_max_idx = 0u, local_min_idx;
+
+            const uint32_t coeff   = (this->d_sf + this->d_sf + this->d_sf / 2u);
+
+            // Approximate local maximum
+            for (uint32_t i = 0u; i < window - coeff - 1u; i += coeff / 2u) {
+                if (samples_ifreq[i] - samples_ifreq[i + coeff]  > 0.2f) { // Goes down
+                    local_max_idx = i;
+                    found_change = true;
+                    break;
+                }
+            }
+
+            if (!found_change) {
+                //printf("No falling edge?\n");
+                return 0.0f;
+            }
+
+            // Find top and bottom of falling edge after first upchirp in window
+            local_max_idx = std::max_element(samples_ifreq + gr::lora::clamp((int)(local_max_idx - 2u * coeff),  0, (int)window),
+                                             samples_ifreq + gr::lora::clamp(local_max_idx +             coeff, 0u,      window)) - samples_ifreq;
+            local_min_idx = std::min_element(samples_ifreq + gr::lora::clamp(local_max_idx +                1u, 0u,      window),
+                                             samples_ifreq + gr::lora::clamp(local_max_idx +        3u * coeff, 0u,      window)) - samples_ifreq;
+
+            // Cross correlate between start and end of falling edge instead of entire window
+            const float max_correlation = this->d_upchirp_correlator.best(samples_ifreq, window, local_max_idx, local_min_idx, index);
+
+            // Signal from local_max_idx vs shifted with *index
+            //DBGR_WRITE_SIGNAL(this->d_upchirp_ifreq, (samples_ifreq + local_max_idx), len, (*index - local_max_idx), 0u, window, false, true, Printed graphs in sliding_norm_cross_correlate_upchirp);
+
+            return max_correlation;
+        }
+
+        /**
+         *  Slide the given chirp perfectly on top of the ideal upchirp (phase shift).
+         *  Currently unused.
+         */
+        int32_t phy_decoder::slide_phase_shift_upchirp_perfect(const float* samples_ifreq, const uint32_t window) {
+            /// Perfect shift to ideal frequency
+            const uint32_t t_low = window / 4u,
+                           t_mid = window / 2u;
+
+            // Average before compare
+            const uint32_t coeff = 20u;
+            float avg = std::accumulate(&samples_ifreq[t_mid] - coeff / 2u, &samples_ifreq[t_mid] + coeff / 2u, 0.0f) / coeff;
+
+            uint32_t idx = std::lower_bound( this->d_upchirp_ifreq.begin() + t_low,
+                                             this->d_upchirp_ifreq.begin() + t_mid,
+                                             avg)
+                           - this->d_upchirp_ifreq.begin();
+
+            return (idx <= t_low || idx >= t_mid) ? -1 : t_mid - idx;
+        }
+
+        float phy_decoder::stddev(const float *values, const uint32_t len, const float mean) {
+            return gr::lora::kernels::stddev(values, len, mean);
+        }
+
+        float phy_decoder::detect_upchirp(const gr_complex *samples, const uint32_t window, int32_t *index) {
+            float *samples_ifreq = this->d_ws_ifreq;
+            this->instantaneous_frequency(samples, samples_ifreq, window);
+
+            return this->sliding_norm_cross_correlate_upchirp(samples_ifreq, window, index);
+        }
+
+        bool phy_decoder::demodulate(const gr_complex *samples, const bool is_header) {
+//            DBGR_TIME_MEASUREMENT_TO_FILE("SFxx_method");
+
+//            DBGR_START_TIME_MEASUREMENT(false, "only");
+
+            #ifdef CFO_CORRECT
+                gr_complex *corrected = this->d_ws_symbol;
+                memcpy(corrected, samples, this->d_samples_per_symbol * sizeof(gr_complex));
+
+                this->determine_cfo(samples);
+                LORA_TRACE(DEMOD, INFO, "CFO: " << this->d_cfo_estimation);
+
+                this->correct_cfo(corrected, this->d_samples_per_symbol);
+                samples = corrected;
+            #endif
+
+            uint32_t bin_idx = this->d_demodulator->demodulate(samples, is_header);
+
+//            DBGR_INTERMEDIATE_TIME_MEASUREMENT();
+
+            // Header has additional redundancy
+            if (is_header) {
+                bin_idx /= 4u;
+            }
+
+            // Decode (actually gray encode) the bin to get the symbol value
+            const uint32_t word = bin_idx ^ (bin_idx >> 1u);
+
+            LORA_TRACE(DEMOD, VERBOSE, gr::lora::to_bin(word, is_header ? this->d_sf - 2u : this->d_sf) << " " << bin_idx);
+            this->d_words.push_back(word);
+
+            // Look for 4+cr symbols and stop
+            if (this->d_words.size() == (4u + this->d_cr)) {
+                if (is_header) {
+                    // Deinterleave here, the HDR is needed to demodulate the payload
+                    frame_decoder::deinterleave(&this->d_words[0], this->d_words.size(), this->d_sf - 2u, this->d_ws_words);
+
+                    if (gr::lora::trace::enabled(gr::lora::trace::HEADER, gr::lora::trace::VERBOSE)) {
+                        gr::lora::trace::line out(gr::lora::trace::HEADER, gr::lora::trace::VERBOSE);
+                        out << "D: ";
+
+                        for (uint32_t j = 0u; j < this->d_sf - 2u; j++)
+                            out << gr::lora::to_bin(this->d_ws_words[j], sizeof(uint8_t) * 8u) << ", ";
+                    }
+                } else {
+                    // The rest of the bit pipeline runs on the frame decoder's worker
+                    this->d_frame_decoder->add_block(&this->d_words[0], this->d_words.size());
+                }
+
+                this->d_words.clear();
+
+                return true; // Signal that a block is ready for decoding
+            }
+
+            return false; // We need more words in order to decode a block
+        }
+
+        void phy_decoder::decode_header(uint8_t *out_data) {
+            frame_decoder::decode_codewords(this->d_ws_words, 5u, gr::lora::header_whitening_sequence(true), 4u, out_data);
+        }
+
+        bool phy_decoder::check_header(const uint8_t *hdr) {
+            // The decoded nibbles of the CR and CRC flag have their MSB flipped (see `lookup_cr`)
+            const uint8_t n0       = hdr[0] & 0x0fu;
+            const uint8_t n1       = hdr[0] >> 4u;
+            const uint8_t n2       = (hdr[1] & 0x0fu) ^ 0x08u;
+            const uint8_t received = (uint8_t)(((hdr[1] >> 4u) & 0x01u) << 4u | (hdr[2] & 0x0fu));
+
+            return received == gr::lora::header_checksum(n0, n1, n2);
+        }
+
+        /**
+         *  Used on every HDR symbol (and on every payload symbol with `CFO_CORRECT`).
+         */
+        void phy_decoder::determine_cfo(const gr_complex *samples) {
+            float *instantaneous_phase = this->d_ws_ifreq;
+//            float instantaneous_freq [this->d_samples_per_symbol];
+            const float div = (float) this->d_samples_per_second / (2.0f * M_PI);
+
+            // Determine instant phase
+            this->instantaneous_phase(samples, instantaneous_phase, this->d_samples_per_symbol);
+
+            // Determine instant freq
+//            for (unsigned int i = 1; i < this->d_samples_per_symbol; i++) {
+//                instantaneous_freq[i - 1] = (float)((instantaneous_phase[i] - instantaneous_phase[i - 1]) * div);
+//            }
+
+            float sum = 0.0f;
+
+            for (uint32_t i = 1u; i < this->d_samples_per_symbol; i++) {
+                sum += (float)((instantaneous_phase[i] - instantaneous_phase[i - 1u]) * div);
+            }
+
+            this->d_cfo_estimation = sum / (float)(this->d_samples_per_symbol - 1u);
+
+            /*d_cfo_estimation = (*std::max_element(instantaneous_freq, instantaneous_freq+d_samples_per_symbol-1) + *std::min_element(instantaneous_freq, instantaneous_freq+d_samples_per_symbol-1)) / 2;*/
+        }
+
+        /**
+         *  Currently unused.
+         */
+        void phy_decoder::correct_cfo(gr_complex *samples, const uint32_t num_samples) {
+            const float mul = 2.0f * M_PI * -this->d_cfo_estimation * this->d_dt;
+
+            for (uint32_t i = 0u; i < num_samples; i++) {
+                samples[i] *= std::polar(1.0f, mul * i);
+            }
+        }
+
+        /**
+         *  Exhaustive, one demodulation per offset: only for comparison (`PreambleDetection::EXACT`).
+         */
+        int phy_decoder::find_preamble_start(const gr_complex *samples) {
+            for (uint32_t i = 0u; i < this->d_samples_per_symbol; i++) {
+                if (this->d_demodulator->demodulate(&samples[i], false) == this->d_number_of_bins)
+                    return i;
+            }
+
+            return -1;
+        }
+
+        /**
+         *  Look for a signal with an absolute value above `this->d_energy_threshold`.
+         */
+        int phy_decoder::find_preamble_start_fast(const gr_complex *samples) {
+            const uint32_t decimation = this->d_corr_decim_factor * 4u;
+            const uint32_t decim_size = this->d_samples_per_symbol / decimation;
+
+            // Absolute value
+            for (uint32_t i = 1u; i < decimation - 1u; i++) {
+                if (    std::abs(samples[ i       * decim_size]) > this->d_energy_threshold
+                    &&  std::abs(samples[(i - 1u) * decim_size]) < std::abs(samples[i * decim_size])
+                    &&  std::abs(samples[(i + 1u) * decim_size]) > std::abs(samples[i * decim_size])
+                   ) {
+                    return i * decim_size;
+                }
+            }
+
+            return -1;
+        }
+
+        /**
+         *  The detector has seen every sample before `samples`, so only the first symbol is pushed.
+         *  Its estimate is accurate to about a bin, `detect_upchirp` refines it to the sample.
+         */
+        int phy_decoder::find_preamble_start_streaming(const gr_complex *samples) {
+            const uint32_t sps = this->d_samples_per_symbol;
+
+            if (this->d_preamble_detector->position() != this->d_position)
+                this->d_preamble_detector->reset(this->d_position);
+
+            if (!this->d_preamble_detector->push(samples, sps))
+                return -1;
+
+            // The start lies before the pushed samples, the next upchirp starts within the first symbol
+            int64_t start = (int64_t)this->d_preamble_detector->preamble_start() - (int64_t)this->d_position;
+            while (start < 0)
+                start += sps;
+
+            // Look for the falling edge half a symbol in, away from the window edges
+            const uint32_t from    = (uint32_t)(start + sps / 2u) % sps;
+            int32_t        index   = 0;
+            this->d_correlations++;
+            const float    c       = this->detect_upchirp(&samples[from], 2u * sps, &index);
+            const int32_t  refined = (int32_t)from + index;
+
+            // Only trust the refinement when it points to (about) the same start
+            int32_t diff = (refined - (int32_t)start) % (int32_t)sps;
+            if (diff >  (int32_t)sps / 2) diff -= sps;
+            if (diff < -(int32_t)sps / 2) diff += sps;
+
+            if (c > 0.9f && std::abs(diff) <= (int32_t)(2u * this->d_decim_factor)) {
+                start = refined;
+            }
+
+            LORA_TRACE(DETECT, INFO, "Cs: " << c << " bin: " << this->d_preamble_detector->preamble_bin() << " diff: " << diff);
+
+            return (int)start;
+        }
+
+        uint8_t phy_decoder::lookup_cr(const uint8_t bytevalue) {
+            switch (bytevalue & 0x0f) {
+                case 0x01:  return 4;
+                case 0x0f:  return 3;
+                case 0x0d:  return 2;
+                case 0x0b:  return 1;
+                default:    return 4;
+            }
+        }
+
+        uint32_t phy_decoder::process(const gr_complex *input, const gr_complex *raw_input) {
+            uint32_t consumed = 0u;
+
+//            DBGR_TIME_MEASUREMENT_TO_FILE("SF7_fft_idx");
+
+            DBGR_START_TIME_MEASUREMENT(false, gr::lora::DecoderStateToString(this->d_state));
+
+            if (this->d_threshold_changed.load(std::memory_order_relaxed))
+                this->apply_threshold_settings();
+
+            switch (this->d_state) {
+                case gr::lora::DecoderState::DETECT: {
+                    this->d_detect_symbols++;
+
+                    const float energy = gr::lora::kernels::energy(input, this->d_samples_per_symbol);
+
+                    if (this->d_applied_margin > 0.0f) {
+                        this->d_noise_floor.update(energy);
+                        this->apply_threshold(this->d_noise_floor.threshold(this->d_applied_margin));
+                    }
+
+                    if (this->d_preamble_detection == PreambleDetection::STREAMING) {
+                        const int i = this->find_preamble_start_streaming(input);
+
+                        if (i != -1) {
+                            LORA_TRACE_SAMPLES("detect", &input[i], this->d_samples_per_symbol);
+                            this->d_preamble_index = this->d_position + i;
+                            this->d_corr_fails = 0u;
+                            this->d_state = gr::lora::DecoderState::SYNC;
+                            consumed = i;
+                        } else {
+                            // Everything pushed to the detector, which keeps what it still needs
+                            consumed = this->d_samples_per_symbol;
+                        }
+                        break;
+                    }
+
+                    // Gate the search on the symbol energy first, so noise never reaches the correlation.
+                    // Only the gate looks at a quiet symbol, which is cheap enough to step a single symbol.
+                    if (energy < this->d_energy_threshold * this->d_energy_threshold) {
+                        consumed = this->d_samples_per_symbol;
+                        break;
+                    }
+
+                    const int i = this->d_preamble_detection == PreambleDetection::EXACT
+                                ? this->find_preamble_start(input)
+                                : this->find_preamble_start_fast(input);
+                    //int i = this->calc_energy_threshold(&input[0], 2u * this->d_samples_per_symbol, this->d_energy_threshold);
+
+                    if (i != -1) {
+                        int32_t index_correction = 0;
+                        this->d_correlations++;
+
+                        const float c = this->detect_upchirp(&input[i],
+                                                             this->d_samples_per_symbol * 2u,
+                                                             &index_correction);
+
+                        if (c > 0.9f) {
+                            LORA_TRACE(DETECT, INFO, "Cu: " << c);
+                            LORA_TRACE_SAMPLES("detectb", &input[i],                    this->d_samples_per_symbol);
+                            LORA_TRACE_SAMPLES("detect",  &input[i + index_correction], this->d_samples_per_symbol);
+                            this->d_preamble_index = this->d_position + i + index_correction;
+                            this->d_corr_fails = 0u;
+                            this->d_state = gr::lora::DecoderState::SYNC;
+                            consumed = i + index_correction;
+                            break;
+                        }
+
+                        // Consume just 1 symbol after preamble to have more chances to sync later
+                        consumed = i + this->d_samples_per_symbol;
+                    } else {
+                        // Consume 2 symbols (usual) to skip noise faster before preamble has been found
+                        consumed = 2u * this->d_samples_per_symbol;
+                    }
+                    break;
+                }
+
+                case gr::lora::DecoderState::SYNC: {
+                    const float c = this->detect_downchirp(input, this->d_samples_per_symbol);
+
+                    LORA_TRACE(SYNC, VERBOSE, "Cd: " << c);
+
+                    if (c > 0.99f) {
+                        LORA_TRACE(SYNC, INFO, "SYNC: " << c);
+                        LORA_TRACE_SAMPLES("sync", input, this->d_samples_per_symbol);
+
+                        //printf("---------------------- SYNC!  with %f\n", c);
+
+                        this->d_state = gr::lora::DecoderState::PAUSE;
+                    } else {
+                        this->d_corr_fails++;
+
+                        if (this->d_corr_fails > 32u) {
+                            this->d_state = gr::lora::DecoderState::DETECT;
+                            LORA_TRACE(SYNC, WARNING, "Lost sync");
+                        }
+                    }
+
+                    consumed = this->d_samples_per_symbol;
+                    break;
+                }
+
+                case gr::lora::DecoderState::PAUSE: {
+                    this->d_state = gr::lora::DecoderState::DECODE_HEADER;
+                    consumed = this->d_samples_per_symbol + this->d_delay_after_sync;
+                    break;
+                }
+
+                case gr::lora::DecoderState::DECODE_HEADER: {
+                    this->d_cr = 4u;
+
+                    // Every (shifted) chirp sweeps the whole band once, so its mean frequency is the CFO.
+                    // Both estimates are averaged over the HDR block, as a symbol that is slightly off straddles two chirps.
+                    const uint32_t hdr_symbols = this->d_words.size();
+                    const float    cfo_so_far  = this->d_cfo_estimation;
+
+                    this->determine_cfo(input);
+                    this->d_cfo_estimation = (cfo_so_far * hdr_symbols + this->d_cfo_estimation) / (hdr_symbols + 1u);
+                    this->d_snr            = (this->d_snr * hdr_symbols + this->d_preamble_detector->symbol_snr(input)) / (hdr_symbols + 1u);
+
+                    if (this->demodulate(input, true)) {
+                        uint8_t decoded[3];
+
+                        this->decode_header(decoded);
+
+                        const uint8_t length_byte = decoded[0];
+                        frame_decoder::nibble_reverse(&decoded[0], 1u); // TODO: Why? Endianess?
+                        this->d_payload_length = decoded[0];
+                        this->d_cr             = this->lookup_cr(decoded[1]);
+                        decoded[0]             = length_byte;
+
+                        const int symbols_per_block = this->d_cr + 4u;
+                        const float bits_needed     = float(this->d_payload_length) * 8.0f + ((decoded[1] & 0x01u) ? 16.0f : 0.0f);
+                        const float symbols_needed  = bits_needed * (symbols_per_block / 4.0f) / float(this->d_sf);
+                        const int blocks_needed     = (int)std::ceil(symbols_needed / symbols_per_block);
+                        this->d_payload_symbols     = blocks_needed * symbols_per_block;
+
+                        // The HDR block's words after the first 5 and every payload block are dewhitened
+                        const int words_needed = (int)this->d_sf - 7 + this->d_payload_symbols / symbols_per_block * (int)this->d_sf;
+
+                        if (this->d_header_check.load(std::memory_order_relaxed) && !phy_decoder::check_header(decoded)) {
+                            // A corrupt HDR announces a random length, don't demodulate noise for it
+                            this->d_header_failures++;
+                            this->d_symbols_saved += this->d_payload_symbols;
+
+                            LORA_TRACE(HEADER, INFO, "Checksum mismatch, skipped " << this->d_payload_symbols << " symbols");
+
+                            this->d_payload_symbols = 0;
+                            this->d_state = gr::lora::DecoderState::DETECT;
+                        } else if (words_needed > (int)this->d_whitening_length) {
+                            // Only known for as long as it was captured (see `payload_whitening_sequence`), don't guess past it
+                            this->d_symbols_saved += this->d_payload_symbols;
+
+                            LORA_TRACE(HEADER, WARNING, "LEN: " << this->d_payload_length << " outruns the whitening sequence ("
+                                                        << words_needed << " > " << this->d_whitening_length << " words), skipped");
+
+                            this->d_payload_symbols = 0;
+                            this->d_state = gr::lora::DecoderState::DETECT;
+                        } else {
+                            frame_info info     = frame_info();
+                            info.sf             = this->d_sf;
+                            info.cr             = this->d_cr;
+                            info.length         = (uint8_t)this->d_payload_length;
+                            info.has_crc        = decoded[1] & 0x01u;
+                            info.cfo            = this->d_cfo_estimation;
+                            info.snr            = this->d_snr;
+                            info.preamble_index = this->d_preamble_index;
+
+                            // The HDR block's words after the first 5 already belong to the payload
+                            this->d_frame_decoder->start_frame(decoded, this->d_ws_words + 5u, this->d_sf - 2u - 5u, info);
+
+                            LORA_TRACE(HEADER, INFO, "LEN: " << this->d_payload_length << " (" << this->d_payload_symbols << " symbols)");
+
+                            this->d_state = gr::lora::DecoderState::DECODE_PAYLOAD;
+                        }
+                    }
+
+                    if (this->d_chirp_callback) {
+                        this->d_chirp_callback(raw_input, this->d_samples_per_symbol);
+                    }
+                    consumed = this->d_samples_per_symbol;
+                    break;
+                }
+
+                case gr::lora::DecoderState::DECODE_PAYLOAD: {
+                    // Failsafe if decoding length reaches end of actual data == noise reached?
+                    // Ends the frame early instead of demodulating noise for up to 255 bytes,
+                    // the truncated frame then fails its CRC in the frame_decoder (see `CrcCheck`).
+                    if (std::abs(input[0]) < this->d_energy_threshold) {
+                        this->d_payload_symbols = 0;
+                    }
+
+                    if (this->demodulate(input, false)) {
+                        this->d_payload_symbols -= (4u + this->d_cr);
+
+                        if (this->d_payload_symbols <= 0) {
+                            this->d_frame_decoder->end_frame(this->d_position + this->d_samples_per_symbol, gr::lora::wall_clock_ns());
+
+                            this->d_state = gr::lora::DecoderState::DETECT;
+
+                            DBGR_STOP_TIME_MEASUREMENT(true);
+//                            DBGR_PAUSE();
+
+                            //---- Whitening rejecter ----
+//                            bool all_zero = true;
+//                            for (uint32_t i = 0u; i < this->d_payload_length; i++) {
+//                                if (decoded[i]) {
+//                                    all_zero = false;
+//                                    break;
+//                                }
+//                            }
+
+//                            // Remove last line in whitening output file if decoded values were not all zero
+//                            if (!all_zero) {
+//                                system("sed -i '$ d' /tmp/whitening_out");
+//                            }
+                            //----------------------------
+                        }
+                    }
+
+                    if (this->d_chirp_callback) {
+                        this->d_chirp_callback(raw_input, this->d_samples_per_symbol);
+                    }
+                    consumed = this->d_samples_per_symbol;
+
+                    break;
+                }
+
+                case gr::lora::DecoderState::STOP: {
+                    consumed = this->d_samples_per_symbol;
+                    break;
+                }
+
+                default: {
+                    std::cerr << "[LoRa Decoder] WARNING : No state! Shouldn't happen\n";
+                    break;
+                }
+            }
+
+            DBGR_INTERMEDIATE_TIME_MEASUREMENT();
+
+            this->d_position += consumed;
+
+            return consumed;
+        }
+
+        uint32_t phy_decoder::samples_needed() const {
+            switch (this->d_state) {
+                // Every method can return an index up to one symbol in,
+                // after which detect_upchirp looks at two more symbols
+                case gr::lora::DecoderState::DETECT: return 3u * this->d_samples_per_symbol;
+                case gr::lora::DecoderState::PAUSE:  return this->d_samples_per_symbol + this->d_delay_after_sync;
+                default:                             return this->d_samples_per_symbol;
+            }
+        }
+
+        size_t phy_decoder::memory_footprint() const {
+            // Not counted: the liquid-dsp decimator
+            return sizeof(*this)
+                 + this->d_workspace.size()
+                 + this->d_demodulator->memory_footprint()
+                 + this->d_preamble_detector->memory_footprint()
+                 + this->d_frame_decoder->memory_footprint()
+                 + sizeof(gr_complex) * (this->d_downchirp.capacity() + this->d_downchirp_conj.capacity() + this->d_upchirp.capacity())
+                 + sizeof(float)      * (this->d_downchirp_ifreq.capacity() + this->d_upchirp_ifreq.capacity());
+        }
+
+        void phy_decoder::reset() {
+            this->d_state = gr::lora::DecoderState::DETECT;
+            this->d_words.clear();
+            this->d_frame_decoder->abort_frame();
+        }
+
+        void phy_decoder::set_frame_callback(const frame_callback& callback) {
+            this->d_frame_decoder->set_frame_callback(callback);
+        }
+
+        void phy_decoder::flush() {
+            this->d_frame_decoder->flush();
+        }
+
+        void phy_decoder::set_chirp_callback(const chirp_callback& callback) {
+            this->d_chirp_callback = callback;
+        }
+
+        void phy_decoder::set_abs_threshold(const float threshold) {
+            this->d_abs_threshold.store(gr::lora::clamp(threshold, 0.0f, 20.0f), std::memory_order_relaxed);
+            this->d_threshold_changed.store(true, std::memory_order_release);
+        }
+
+        void phy_decoder::set_threshold_margin(const float margin_db) {
+            this->d_threshold_margin.store(gr::lora::clamp(margin_db, 0.0f, 30.0f), std::memory_order_relaxed);
+            this->d_threshold_changed.store(true, std::memory_order_release);
+        }
+
+        void phy_decoder::apply_threshold_settings() {
+            // A setter that runs after this sees the flag cleared, and sets it again
+            this->d_threshold_changed.exchange(false, std::memory_order_acquire);
+
+            const float margin = this->d_threshold_margin.load(std::memory_order_relaxed);
+
+            if (margin != this->d_applied_margin) {
+                this->d_applied_margin = margin;
+                this->d_noise_floor.reset();
+            }
+
+            if (margin <= 0.0f)
+                this->apply_threshold(this->d_abs_threshold.load(std::memory_order_relaxed));
+        }
+
+        void phy_decoder::apply_threshold(const float threshold) {
+            this->d_energy_threshold = threshold;
+            this->d_preamble_detector->set_energy_threshold(threshold);
+        }
+
+        void phy_decoder::set_preamble_detection(const PreambleDetection detection) {
+            this->d_preamble_detection = detection;
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,561 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef PHY_DECODER_H
+#define PHY_DECODER_H
+
+#include <liquid/liquid.h>
+#include "lora_complex.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include "workspace.h"
+#include "upchirp_correlator.h"
+#include "frame_decoder.h"
+#include "demodulator.h"
+#include "preamble_detector.h"
+#include "noise_floor.h"
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **DecoderState** : Each state the LoRa decoder can be in.
+         */
+        enum class DecoderState {
+            DETECT,
+            SYNC,
+            PAUSE,
+            DECODE_HEADER,
+            DECODE_PAYLOAD,
+            STOP
+        };
+
+        /**
+         *  \brief  Return the DecoderState as string for debugging purposes.
+         *
+         *  \param  s
+         *          The state to return to string.
+         */
+        static std::string DecoderStateToString(DecoderState s) {
+            static std::string DecoderStateLUT[] = { "DETECT", "SYNC", "PAUSE", "DECODE_HEADER", "DECODE_PAYLOAD", "STOP" };
+            return DecoderStateLUT[ (size_t)s ];
+        }
+
+        /**
+         *  \brief  **PreambleDetection** : How `DecoderState::DETECT` looks for a preamble.
+         *          <BR>FAST: Look for a rising amplitude (`find_preamble_start_fast`).
+         *          <BR>EXACT: Demodulate the symbol at every offset (`find_preamble_start`).
+         *          <BR>STREAMING: Track the dechirped FFT peak over overlapping windows (`preamble_detector`).
+         */
+        enum class PreambleDetection {
+            FAST,
+            EXACT,
+            STREAMING
+        };
+
+        /**
+         *  \brief  **LoRa PHY Decoder**
+         *          <BR>Contains all variables and methods necessary for succesfully decoding LoRa PHY,
+         *          <BR>without depending on the GNU Radio scheduler.
+         *          <BR>Only the sample rate and spreading factor are needed.
+         *          The other settings, like packet length and coding rate, are extracted from the (explicit) HDR.
+         *          <BR>The owner feeds it samples symbol by symbol with `process` and
+         *          <BR>receives the decoded frames through a callback (see `decoder_impl` and `multi_sf_decoder_impl`).
+         *          <BR>Only demodulation happens in `process`, the payload's bit pipeline runs in a `frame_decoder`.
+         */
+        class phy_decoder {
+            public:
+                /**
+                 *  \brief  Called with the HDR and payload bytes of each decoded frame.
+                 */
+                typedef frame_decoder::frame_callback frame_callback;
+
+                /**
+                 *  \brief  Called with the raw samples of each HDR and payload symbol.
+                 */
+                typedef std::function<void (const gr_complex *raw_samples, const uint32_t num_samples)> chirp_callback;
+
+            private:
+                DecoderState            d_state;            ///< Holds the current state of the decoder (state machine).
+
+                std::vector<gr_complex> d_downchirp;        ///< The complex ideal downchirp.
+                std::vector<gr_complex> d_downchirp_conj;   ///< The complex conjugate of the ideal downchirp, used for dechirping.
+                std::vector<float>      d_downchirp_ifreq;  ///< The instantaneous frequency of the ideal downchirp.
+
+                std::vector<gr_complex> d_upchirp;          ///< The complex ideal upchirp.
+                std::vector<float>      d_upchirp_ifreq;    ///< The instantaneous frequency of the ideal upchirp.
+                upchirp_correlator      d_upchirp_correlator; ///< Slides the ideal upchirp over a window in `sliding_norm_cross_correlate_upchirp`.
+
+                workspace    d_workspace;                   ///< Holds every buffer below, sized once in the ctor.
+                gr_complex  *d_ws_symbol;                   ///< Copy of the symbol being demodulated, when correcting the CFO.
+                float       *d_ws_ifreq;                    ///< Instantaneous frequency (or phase) of up to 2 symbols.
+                uint8_t     *d_ws_words;                    ///< Output of `deinterleave` for the HDR, one word per bit of the SF.
+
+                std::unique_ptr<demodulator> d_demodulator; ///< Finds the bin of each HDR and payload symbol.
+                std::unique_ptr<preamble_detector> d_preamble_detector; ///< Looks for preambles in `PreambleDetection::STREAMING`.
+                PreambleDetection d_preamble_detection;     ///< How `DecoderState::DETECT` looks for a preamble.
+                uint64_t       d_position;                  ///< Absolute index of the next sample given to `process`.
+                uint64_t       d_preamble_index;            ///< Absolute index of the preamble of the current frame.
+                float          d_snr;                       ///< SNR of the current frame in dB, averaged over its HDR symbols.
+
+                uint8_t        d_sf;                        ///< The Spreading Factor.
+                uint32_t       d_bw;                        ///< The receiver bandwidth (fixed to `125kHz`).
+                uint8_t        d_cr;                        ///< The Coding Rate.
+                double         d_bits_per_second;           ///< Indicator of how many bits are transferred each second.
+                uint32_t       d_delay_after_sync;          ///< The amount of samples to skip in `DecoderState::PAUSE`.
+                uint32_t       d_samples_per_second;        ///< The amount of samples taken per second by GNU Radio.
+                double         d_symbols_per_second;        ///< Indicator of how many symbols (read: chirps) are transferred each second.
+                uint32_t       d_bits_per_symbol;           ///< The amount of bits each of the symbols contain.
+                uint32_t       d_samples_per_symbol;        ///< The amount of samples in one symbol.
+                uint32_t       d_number_of_bins;            ///< Indicates in how many parts or bins a symbol is decimated, i.e. the max value to decode out of one payload symbol.
+                uint32_t       d_number_of_bins_hdr;        ///< Indicates in how many parts or bins a HDR symbol is decimated, i.e. the max value to decode out of one HDR symbol.
+                 int32_t       d_payload_symbols;           ///< The amount of symbols needed to decode the payload. Calculated from an indicator in the HDR.
+                uint32_t       d_payload_length;            ///< The amount of words after decoding the HDR or payload. Calculated from an indicator in the HDR.
+                uint32_t       d_corr_fails;                ///< Indicates how many times the correlation failed. After some tries, the state will revert to `DecoderState::DETECT`.
+                std::atomic<bool> d_header_check;           ///< Whether to return to `DecoderState::DETECT` when the HDR checksum does not match.
+                uint64_t       d_header_failures;           ///< Amount of HDRs rejected by their checksum.
+                uint64_t       d_symbols_saved;             ///< Amount of payload symbols not demodulated because their HDR was rejected.
+                float          d_energy_threshold;          ///< The absolute threshold to distinguish signal from noise, as applied.
+                std::atomic<float> d_abs_threshold;         ///< The absolute threshold set by the user, applied when not tracking the noise floor.
+                std::atomic<float> d_threshold_margin;      ///< Margin in dB of the threshold above `d_noise_floor`, 0 to use `d_abs_threshold`.
+                std::atomic<bool>  d_threshold_changed;     ///< Whether either of the above was set since `process` last applied them.
+                float          d_applied_margin;            ///< The margin `process` tracks the noise floor with.
+                noise_floor    d_noise_floor;               ///< Average power of the symbols seen in `DecoderState::DETECT`.
+                uint64_t       d_detect_symbols;            ///< Amount of symbols looked at in `DecoderState::DETECT`.
+                uint64_t       d_correlations;              ///< Amount of times `detect_upchirp` ran in `DecoderState::DETECT`.
+                const uint8_t *d_whitening_sequence;        ///< A pointer to the (shuffled) whitening sequence to be used in decoding. Determined by the SF in the ctor.
+                uint32_t       d_whitening_length;          ///< Length of said sequence: frames needing more words are skipped.
+
+                std::vector<uint32_t> d_words;              ///< Vector containing the demodulated words of the current block.
+                std::unique_ptr<frame_decoder> d_frame_decoder; ///< Decodes the payload blocks into frames.
+
+                uint32_t      d_corr_decim_factor;          ///< The decimation factor used in finding the preamble start.
+                uint32_t      d_decim_factor;               ///< The amount of samples (data points) in each bin.
+                firdecim_crcf d_decim = nullptr;            ///< The LiquidDSP FIR decimation filter used to decimate the FFT imput.
+                float         d_cfo_estimation;             ///< An estimation for the current Center Frequency Offset.
+                double        d_dt;                         ///< Indicates how fast the frequency changes in a symbol (chirp).
+
+                /**
+                 *  \brief  Calculates the average energy from the given samples and returns whether its higher than the given threshold.
+                 *
+                 *  \param  samples
+                 *          The samples to calculate and compare the energy to.
+                 *  \param  window_size
+                 *          The length of the samples array.
+                 *  \param  threshold
+                 *          The threshold to compare to.
+                 */
+                bool calc_energy_threshold(const gr_complex *samples, const uint32_t window_size, const float threshold);
+
+                /**
+                 *  \brief  Apply the given absolute threshold to the preamble search and the end of frame failsafe.
+                 *
+                 *  \param  threshold
+                 *          The threshold, as an amplitude.
+                 */
+                void apply_threshold(const float threshold);
+
+                /**
+                 *  \brief  Apply the absolute threshold or margin set since the last call, on the thread that runs `process`.
+                 *          <BR>The noise floor starts over when the margin changed.
+                 */
+                void apply_threshold_settings();
+
+                /**
+                 *  \brief  Generate the ideal up- and downchirps.
+                 */
+                void build_ideal_chirps(void);
+
+                /**
+                 *  \brief  Correct the shift of the given symbol to match the ideal upchirp by sliding cross correlating.
+                 *
+                 *  \param  samples_ifreq
+                 *          The symbol to shift.
+                 *  \param  window
+                 *          The window in which the symbol can be shifted (length of given sample array).
+                 *  \param  index
+                 *          The new start index in the window for the found upchirp.
+                 *  \return Also return the correlation coefficient.
+                 */
+                float sliding_norm_cross_correlate_upchirp(const float *samples_ifreq, const uint32_t window, int32_t *index);
+
+                /**
+                 *  \brief Base method to start downchirp correlation and return the correlation coefficient.
+                 *
+                 *  \param  samples
+                 *          The complex array of samples to detect a downchirp in.
+                 *  \param  window
+                 *          Length of said sample.
+                 */
+                float detect_downchirp(const gr_complex *samples, const uint32_t window);
+
+                /**
+                 *  \brief  Base method to start upchirp detection by calling `sliding_norm_cross_correlate_upchirp`.
+                 *          <BR>Sets up the instantaneous frequency of the given complex symbol.
+                 *
+                 *  \param  samples
+                 *          The complex array of samples to detect an upchirp in.
+                 *  \param  window
+                 *          Length of said sample.
+                 *  \param  index
+                 *          The index to shift with so the upchirp is correctly synced inside its window.
+                 *  \return Also return the correlation coefficient.
+                 */
+                float detect_upchirp(const gr_complex *samples, const uint32_t window, int32_t *index);
+
+                /**
+                 *  \brief  Returns the correlation coefficient when correlating the given complex symbols in the given window.
+                 *
+                 *  \param  samples_1
+                 *          The first complex symbol to correlate with.
+                 *  \param  samples_2
+                 *          The second complex symbol to correlate with.
+                 *  \param  window
+                 *          The window in which to perform correlation.
+                 */
+                float cross_correlate(const gr_complex *samples_1, const gr_complex *samples_2, const uint32_t window);
+
+                /**
+                 *  \brief  Returns the correlation coefficient when correlating the given symbols in the given range.
+                 *
+                 *  \param  samples_ifreq
+                 *          The instantaneous frequency of the symbol to correlate with.
+                 *  \param  ideal_chirp
+                 *          The vector containing the ideal chirp to correlate with.
+                 *  \param  to_idx
+                 *          Correlation end index.
+                 */
+                float cross_correlate_ifreq(const float *samples_ifreq, const std::vector<float>& ideal_chirp, const uint32_t to_idx);
+
+                /**
+                 *  \brief  Returns the index to shift the given symbol so that it overlaps the ideal upchirp.
+                 *
+                 *  \param  samples_ifreq
+                 *          The instantaneous frequency of the symbol to analyse.
+                 *  \param  window
+                 *          Length of said symbol.
+                 */
+                int32_t slide_phase_shift_upchirp_perfect(const float* samples_ifreq, const uint32_t window);
+
+                /**
+                 *  \brief  Determine the center frequency offset in the given symbol.
+                 *
+                 *  \param  samples
+                 *          The complex symbol to analyse.
+                 */
+                void determine_cfo(const gr_complex *samples);
+
+                /**
+                 *  \brief  Correct the center frequency offset in the given symbol.
+                 *
+                 *  \param  samples
+                 *          The complex symbol to analyse.
+                 *  \param  num_samples
+                 *          Length of said symbol.
+                 */
+                void correct_cfo(gr_complex *samples, const uint32_t num_samples);
+
+                /**
+                 *  \brief  Find a valid signal that identifies the start of the preamble.
+                 *
+                 *  \param  samples
+                 *          The complex symbol to analyse.
+                 */
+                int find_preamble_start(const gr_complex *samples);
+
+                /**
+                 *  \brief  Skip through the given symbol to find a signal.
+                 *
+                 *  \param  samples
+                 *          The complex symbol to analyse.
+                 */
+                int find_preamble_start_fast(const gr_complex *samples);
+
+                /**
+                 *  \brief  Push the next symbol to the streaming preamble detector,
+                 *          and return the start of an upchirp of a detected preamble, refined with `detect_upchirp`.
+                 *
+                 *  \param  samples
+                 *          The complex samples to analyse, 3 symbols long. Only the first one is new to the detector.
+                 */
+                int find_preamble_start_streaming(const gr_complex *samples);
+
+                /**
+                 *  \brief  Demodulate the given symbol and return true if all expected symbols have been parsed.
+                 *          <BR>A complete HDR block is deinterleaved into `d_ws_words`,
+                 *          a complete payload block is handed to the frame decoder.
+                 *
+                 *  \param  samples
+                 *          The complex symbol to demodulate.
+                 *  \param  is_header
+                 *          Whether the demodulated words were from the HDR.
+                 */
+                bool demodulate(const gr_complex *samples, const bool is_header);
+
+                /**
+                 *  \brief  Decode the deinterleaved HDR block in `d_ws_words` (deshuffle, dewhiten, Hamming decode).
+                 *
+                 *  \param  out_data
+                 *          The 3 decoded HDR bytes.
+                 */
+                void decode_header(uint8_t *out_data);
+
+                /**
+                 *  \brief  Return whether the checksum in the given decoded HDR matches its length, CR and CRC flag.
+                 *
+                 *  \param  hdr
+                 *          The 3 HDR bytes from `decode_header`, before reversing the length's nibbles.
+                 */
+                static bool check_header(const uint8_t *hdr);
+
+                /**
+                 *  \brief  Return the standard deviation for the given array.
+                 *          <BR>Used for cross correlating.
+                 *
+                 *  \param  values
+                 *          The array to calculate the standard deviation for.
+                 *  \param  len
+                 *          Length of said array.
+                 *  \param  mean
+                 *          The mean (average) of the values in the array.
+                 */
+                float stddev(const float *values, const uint32_t len, const float mean);
+
+                /**
+                 *  \brief  Calculate the instantaneous phase for the given complex symbol.
+                 *
+                 *  \param  in_samples
+                 *          The complex array to calculate the instantaneous phase for.
+                 *  \param  out_iphase
+                 *          The output `float` array containing the instantaneous phase.
+                 *  \param  window
+                 *          The size of said arrays.
+                 */
+                inline void instantaneous_phase(const gr_complex *in_samples, float *out_iphase, const uint32_t window);
+
+                /**
+                 *  \brief  Calculate the instantaneous frequency for the given complex symbol.
+                 *
+                 *  \param  in_samples
+                 *          The complex array to calculate the instantaneous frequency for.
+                 *  \param  out_ifreq
+                 *          The output `float` array containing the instantaneous frequency.
+                 *  \param  window
+                 *          The size of said arrays.
+                 */
+                inline void instantaneous_frequency(const gr_complex *in_samples, float *out_ifreq, const uint32_t window);
+
+                /**
+                 *  \brief  Return the coding rate from the given HDR byte from a LUT.
+                 *
+                 *  \param  bytevalue
+                 *          The LSB nibble to decode.
+                 */
+                uint8_t lookup_cr(const uint8_t bytevalue);
+
+                chirp_callback d_chirp_callback;            ///< Receiver of the raw symbols, if any.
+
+            public:
+                /**
+                 *  \brief  Default ctor.
+                 *
+                 *  \param  samp_rate
+                 *          The sample rate of the input signal given to `process` later.
+                 *  \param  sf
+                 *          The expected spreqding factor.
+                 *  \param  demodulation
+                 *          The demodulation strategy: "gradient", "fft" or "auto" (see `demodulator::make`).
+                 *  \param  decode_thread
+                 *          Whether to decode payloads on a worker thread, or inline in `process`.
+                 *          <BR>Throws `std::invalid_argument` for an unsupported SF or demodulation.
+                 */
+                phy_decoder(float samp_rate, uint8_t sf, const std::string &demodulation = "auto", bool decode_thread = true);
+
+                phy_decoder(const phy_decoder&)            = delete;
+                phy_decoder& operator=(const phy_decoder&) = delete;
+
+                /**
+                 *  Default dtor.
+                 */
+                ~phy_decoder();
+
+                /**
+                 *  \brief  Run the state machine for one step (usually one symbol) on the given input.
+                 *
+                 *  \param  input
+                 *          The (channelized) samples to decode, at least `samples_needed()` long.
+                 *  \param  raw_input
+                 *          The same samples before filtering, forwarded to the `chirp_callback`.
+                 *  \return Returns the amount of samples that were consumed.
+                 */
+                uint32_t process(const gr_complex *input, const gr_complex *raw_input);
+
+                /**
+                 *  \brief  Return the amount of samples the next call to `process` will look at.
+                 */
+                uint32_t samples_needed() const;
+
+                /**
+                 *  \brief  Return to `DecoderState::DETECT` and drop any partially decoded frame.
+                 */
+                void reset();
+
+                /**
+                 *  \brief  Wait until every frame that ended in `process` so far has been published.
+                 */
+                void flush();
+
+                /**
+                 *  \brief  Set the receiver of the decoded frames.
+                 *          <BR>Called from the decode thread, unless disabled in the ctor.
+                 */
+                void set_frame_callback(const frame_callback& callback);
+
+                /**
+                 *  \brief  Set the receiver of the raw HDR and payload symbols.
+                 */
+                void set_chirp_callback(const chirp_callback& callback);
+
+                /**
+                 *  \brief  Set the absolute threshold to distinguish signal from noise.
+                 *          <BR>Should be around 0.01f (default) for normal environments,
+                 *          <BR>or as low as 0.001f for the very noise-resistant USRP.
+                 *          <BR>May be called while another thread runs `process`, which applies it before its next symbol.
+                 *
+                 *  \param  threshold
+                 *          The new threshold value.
+                 */
+                void set_abs_threshold(const float threshold);
+
+                /**
+                 *  \brief  Track the noise floor in `DecoderState::DETECT` and keep the threshold the given margin above it,
+                 *          instead of the absolute threshold.
+                 *          <BR>The floor starts over from the next symbol, which applies it on the thread that runs `process`.
+                 *
+                 *  \param  margin_db
+                 *          The margin in dB on the power, 0 to go back to the absolute threshold.
+                 */
+                void set_threshold_margin(const float margin_db);
+
+                /**
+                 *  \brief  Set how `DecoderState::DETECT` looks for a preamble.
+                 *
+                 *  \param  detection
+                 *          The new method, `PreambleDetection::STREAMING` by default.
+                 */
+                void set_preamble_detection(const PreambleDetection detection);
+
+                /**
+                 *  \brief  Set what to do with the payload CRC of the frames decoded from now on.
+                 *
+                 *  \param  check
+                 *          The new setting, `CrcCheck::FLAG` by default.
+                 */
+                void set_crc_check(const CrcCheck check) { this->d_frame_decoder->set_crc_check(check); }
+
+                /**
+                 *  \brief  Return the amount of frames whose payload CRC did not match, dropped or not.
+                 */
+                uint64_t crc_failures() const { return this->d_frame_decoder->crc_failures(); }
+
+                /**
+                 *  \brief  Return the thread decoding the payloads, not joinable when they are decoded inline.
+                 */
+                std::thread &decode_thread() { return this->d_frame_decoder->worker(); }
+
+                /**
+                 *  \brief  Start or stop the payload decoding thread, see `frame_decoder::set_threaded`.
+                 *          <BR>Only from the thread calling `process`, or before it runs.
+                 */
+                void set_decode_thread(const bool decode_thread) { this->d_frame_decoder->set_threaded(decode_thread); }
+
+                /**
+                 *  \brief  Set whether to check the HDR checksum, and go back to `DecoderState::DETECT` right away on a mismatch.
+                 *          <BR>May be called while another thread runs `process`, the next HDR uses it.
+                 *
+                 *  \param  check
+                 *          Whether to check, on by default.
+                 */
+                void set_header_check(const bool check) { this->d_header_check.store(check, std::memory_order_relaxed); }
+
+                /**
+                 *  \brief  Return the amount of HDRs rejected by their checksum.
+                 */
+                uint64_t header_failures() const { return this->d_header_failures; }
+
+                /**
+                 *  \brief  Return the amount of payload symbols the rejected HDRs announced, which were not demodulated.
+                 */
+                uint64_t symbols_saved() const { return this->d_symbols_saved; }
+
+                /**
+                 *  \brief  Return the amount of symbols looked at for a preamble in `DecoderState::DETECT`.
+                 */
+                uint64_t detect_symbols() const { return this->d_detect_symbols; }
+
+                /**
+                 *  \brief  Return how often the expensive upchirp correlation ran in `DecoderState::DETECT`.
+                 */
+                uint64_t correlations() const { return this->d_correlations; }
+
+                /**
+                 *  \brief  Return how many windows the streaming preamble detector dechirped, past the energy threshold.
+                 */
+                uint64_t fft_windows() const { return this->d_preamble_detector->fft_windows(); }
+
+                /**
+                 *  \brief  Return the tracked noise floor in dB, only meaningful with a threshold margin.
+                 */
+                float noise_floor_db() const { return this->d_noise_floor.power_db(); }
+
+                float threshold_margin() const { return this->d_threshold_margin.load(std::memory_order_relaxed); }
+
+                DecoderState state()              const { return this->d_state; }
+                uint8_t      sf()                 const { return this->d_sf; }
+                float        samp_rate()          const { return this->d_samples_per_second; }
+                uint32_t     samples_per_symbol() const { return this->d_samples_per_symbol; }
+                float        abs_threshold()      const { return this->d_abs_threshold.load(std::memory_order_relaxed); }
+                const char  *demodulation()       const { return this->d_demodulator->name(); }
+                PreambleDetection preamble_detection() const { return this->d_preamble_detection; }
+
+                /**
+                 *  \brief  Set the stream index of the next sample given to `process`, after skipping samples.
+                 *          <BR>Frames are published with indices counted from here.
+                 *
+                 *  \param  position
+                 *          The new stream index.
+                 */
+                void set_position(const uint64_t position) { this->d_position = position; }
+
+                uint64_t position() const { return this->d_position; }
+
+                /**
+                 *  \brief  Return the memory used by this instance in bytes, including its workspace and ideal chirps.
+                 */
+                size_t memory_footprint() const;
+        };
+    } // namespace lora
+} // namespace gr
+
+#endif /* PHY_DECODER_H */
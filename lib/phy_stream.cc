@@ -0,0 +1,144 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <lora/phy_stream.h>
+#include <algorithm>
+#include <vector>
+#include "phy_decoder.h"
+
+namespace gr {
+    namespace lora {
+
+        struct phy_stream::impl {
+            phy_decoder             phy;
+            std::vector<gr_complex> pending;    ///< The tail of the pushed samples, too short for the next step.
+            uint64_t                pushed;     ///< Amount of samples pushed.
+            frame_callback          callback;
+
+            impl(const float samp_rate, const int sf, const std::string &demodulation, const bool decode_thread)
+                : phy(samp_rate, (uint8_t)sf, demodulation, decode_thread),
+                  pushed(0u) {
+                this->pending.reserve(8u * this->phy.samples_per_symbol());
+            }
+        };
+
+        phy_stream::phy_stream(const float samp_rate, const int sf, const std::string &demodulation, const bool decode_thread)
+            : d_impl(new impl(samp_rate, sf, demodulation, decode_thread)) {
+            impl *d = this->d_impl.get();
+
+            d->phy.set_frame_callback([d](const uint8_t *bytes, const uint32_t len, const frame_info &info) {
+                if (!d->callback)
+                    return;
+
+                lora_frame_info out;
+                out.sf             = info.sf;
+                out.cr             = info.cr;
+                out.length         = info.length;
+                out.crc_checked    = info.crc_checked;
+                out.crc_ok         = info.crc_ok;
+                out.cfo            = info.cfo;
+                out.snr            = info.snr;
+                out.preamble_index = info.preamble_index;
+                out.end_index      = info.end_index;
+                out.end_time       = info.end_time;
+
+                d->callback(bytes, len, out);
+            });
+        }
+
+        phy_stream::~phy_stream() {
+        }
+
+        /**
+         *  Steps that fit in `samples` run on them in place. Only the tail of a push is copied, and bridged
+         *  with the start of the next push until the steps are past it.
+         */
+        void phy_stream::push(const std::complex<float> *samples, const size_t count) {
+            impl  *d    = this->d_impl.get();
+            size_t used = 0u;
+
+            d->pushed += count;
+
+            if (!d->pending.empty()) {
+                // A step looks at most 3 symbols ahead, so this many new samples always step past the tail
+                const size_t tail = d->pending.size();
+                const size_t take = std::min(count, tail + 3u * d->phy.samples_per_symbol());
+                size_t       pos  = 0u;
+
+                d->pending.insert(d->pending.end(), samples, samples + take);
+
+                while (pos < tail && pos + d->phy.samples_needed() <= d->pending.size())
+                    pos += d->phy.process(&d->pending[pos], &d->pending[pos]);
+
+                if (pos < tail) {
+                    d->pending.erase(d->pending.begin(), d->pending.begin() + pos);
+                    return;
+                }
+
+                used = pos - tail;
+                d->pending.clear();
+            }
+
+            while (used + d->phy.samples_needed() <= count)
+                used += d->phy.process(&samples[used], &samples[used]);
+
+            d->pending.assign(samples + used, samples + count);
+        }
+
+        void phy_stream::flush() {
+            this->d_impl->phy.flush();
+        }
+
+        void phy_stream::set_frame_callback(const frame_callback &callback) {
+            this->d_impl->callback = callback;
+        }
+
+        bool phy_stream::set_crc_check(const std::string &check) {
+            CrcCheck parsed;
+
+            if (!frame_decoder::parse_crc_check(check, parsed))
+                return false;
+
+            this->d_impl->phy.set_crc_check(parsed);
+            return true;
+        }
+
+        void phy_stream::set_header_check(const bool check) {
+            this->d_impl->phy.set_header_check(check);
+        }
+
+        void phy_stream::set_abs_threshold(const float threshold) {
+            this->d_impl->phy.set_abs_threshold(threshold);
+        }
+
+        void phy_stream::set_threshold_margin(const float margin_db) {
+            this->d_impl->phy.set_threshold_margin(margin_db);
+        }
+
+        uint64_t phy_stream::samples_pushed() const {
+            return this->d_impl->pushed;
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
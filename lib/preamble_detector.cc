@@ -0,0 +1,233 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include "preamble_detector.h"
+#include "kernels.h"
+#include "utilities.h"
+
+namespace gr {
+    namespace lora {
+
+        preamble_detector::preamble_detector(const uint32_t samples_per_symbol, const uint32_t number_of_bins,
+                                             const gr_complex *downchirp_conj, const uint32_t hop, const uint32_t symbols)
+            : d_samples_per_symbol(samples_per_symbol),
+              d_number_of_bins(number_of_bins),
+              d_decim_factor(samples_per_symbol / number_of_bins),
+              d_hop(hop),
+              d_symbols(std::max(symbols, 2u)),
+              d_peak_ratio(10.0f),
+              d_energy_threshold(0.01f * 0.01f),
+              d_downchirp_conj(downchirp_conj),
+              d_fft_windows(0u) {
+            if (hop == 0u || samples_per_symbol % hop != 0u) {
+                throw std::invalid_argument("[LoRa Decoder] ERROR : Preamble detector hop should divide the samples per symbol!");
+            }
+
+            this->d_windows_per_symbol = samples_per_symbol / hop;
+            this->d_buffer_size        = 2u * samples_per_symbol;
+
+            this->d_workspace.allocate(workspace::bytes_for<gr_complex>(this->d_buffer_size)    // d_buffer
+                                     + workspace::bytes_for<gr_complex>(samples_per_symbol)     // d_dechirped
+                                     + workspace::bytes_for<gr_complex>(number_of_bins)         // d_fft_in
+                                     + workspace::bytes_for<gr_complex>(number_of_bins));       // d_fft_out
+
+            this->d_buffer    = this->d_workspace.take<gr_complex>(this->d_buffer_size);
+            this->d_dechirped = this->d_workspace.take<gr_complex>(samples_per_symbol);
+            this->d_fft_in    = this->d_workspace.take<gr_complex>(number_of_bins);
+            this->d_fft_out   = this->d_workspace.take<gr_complex>(number_of_bins);
+
+            this->d_plan = fft_create_plan(number_of_bins, this->d_fft_in, this->d_fft_out, LIQUID_FFT_FORWARD, 0);
+
+            // Enough windows to look `d_symbols - 1` symbols back from the newest one
+            this->d_peaks.resize((this->d_symbols - 1u) * this->d_windows_per_symbol + 1u);
+            this->d_power.resize(number_of_bins);
+
+            this->reset(0u);
+        }
+
+        preamble_detector::~preamble_detector() {
+            fft_destroy_plan(this->d_plan);
+        }
+
+        void preamble_detector::reset(const uint64_t position) {
+            this->d_buffer_len   = 0u;
+            this->d_buffer_start = position;
+            this->d_next_window  = position;
+            this->d_windows      = 0u;
+            this->d_start        = 0u;
+            this->d_bin          = 0u;
+            std::fill(this->d_peaks.begin(), this->d_peaks.end(), -1);
+        }
+
+        bool preamble_detector::push(const gr_complex *samples, const uint32_t len) {
+            const uint32_t sps = this->d_samples_per_symbol;
+            uint32_t pushed    = 0u;
+
+            while (pushed < len) {
+                // Drop the samples no window needs anymore
+                if (this->d_buffer_len == this->d_buffer_size) {
+                    const uint32_t drop = (uint32_t)(this->d_next_window - this->d_buffer_start);
+
+                    memmove(this->d_buffer, this->d_buffer + drop, (this->d_buffer_len - drop) * sizeof(gr_complex));
+                    this->d_buffer_len   -= drop;
+                    this->d_buffer_start += drop;
+                }
+
+                const uint32_t n = std::min(len - pushed, this->d_buffer_size - this->d_buffer_len);
+                memcpy(this->d_buffer + this->d_buffer_len, samples + pushed, n * sizeof(gr_complex));
+                this->d_buffer_len += n;
+                pushed             += n;
+
+                while (this->d_next_window + sps <= this->position()) {
+                    uint64_t start;
+                    const int32_t bin = this->peak(this->d_next_window, &start);
+
+                    this->d_peaks[this->d_windows % this->d_peaks.size()] = bin;
+                    this->d_windows++;
+
+                    if (bin >= 0 && this->agree()) {
+                        this->d_start = start;
+                        this->d_bin   = (uint32_t)bin;
+                        return true;
+                    }
+
+                    this->d_next_window += this->d_hop;
+                }
+            }
+
+            return false;
+        }
+
+        void preamble_detector::spectrum(const gr_complex *symbol) {
+            gr::lora::kernels::dechirp(this->d_dechirped, symbol, this->d_downchirp_conj, this->d_samples_per_symbol);
+
+            // Integrate and dump, so the FFT only needs one point per bin
+            for (uint32_t i = 0u; i < this->d_number_of_bins; i++) {
+                const gr_complex *bin = this->d_dechirped + i * this->d_decim_factor;
+                this->d_fft_in[i] = std::accumulate(bin, bin + this->d_decim_factor, gr_complex(0.0f, 0.0f));
+            }
+
+            fft_execute(this->d_plan);
+        }
+
+        float preamble_detector::symbol_snr(const gr_complex *symbol) {
+            const uint32_t N = this->d_number_of_bins;
+
+            this->spectrum(symbol);
+
+            uint32_t best = 0u;
+
+            for (uint32_t i = 0u; i < N; i++) {
+                this->d_power[i] = std::norm(this->d_fft_out[i]);
+
+                if (this->d_power[i] > this->d_power[best])
+                    best = i;
+            }
+
+            // The peak leaks into its neighbours when the symbol is off by a fraction of a bin
+            const float signal = this->d_power[best] + this->d_power[(best + N - 1u) % N] + this->d_power[(best + 1u) % N];
+
+            // The power of a noise bin is exponentially distributed, with its median at ln(2) times its mean
+            std::nth_element(this->d_power.begin(), this->d_power.begin() + N / 2u, this->d_power.end());
+            const float noise = std::max(this->d_power[N / 2u] / std::log(2.0f), 1e-20f);
+
+            return 10.0f * std::log10(std::max(signal - 3.0f * noise, 1e-20f) / (noise * N));
+        }
+
+        int32_t preamble_detector::peak(const uint64_t window, uint64_t *start) {
+            const uint32_t N      = this->d_number_of_bins;
+            const gr_complex *in  = this->d_buffer + (window - this->d_buffer_start);
+
+            if (gr::lora::kernels::energy(in, this->d_samples_per_symbol) < this->d_energy_threshold)
+                return -1;
+
+            this->d_fft_windows++;
+            this->spectrum(in);
+
+            uint32_t best  = 0u;
+            float    peak  = 0.0f,
+                     total = 0.0f;
+
+            for (uint32_t i = 0u; i < N; i++) {
+                const float power = std::norm(this->d_fft_out[i]);
+                total += power;
+
+                if (power > peak) {
+                    peak = power;
+                    best = i;
+                }
+            }
+
+            if (peak * N < this->d_peak_ratio * total)
+                return -1;
+
+            // Interpolate between the neighbouring bins for a start within the bin
+            const float prev  = std::abs(this->d_fft_out[(best + N - 1u) % N]),
+                        mid   = std::abs(this->d_fft_out[best]),
+                        next  = std::abs(this->d_fft_out[(best + 1u) % N]),
+                        denom = prev - 2.0f * mid + next;
+            const float delta = denom < 0.0f ? gr::lora::clamp(0.5f * (prev - next) / denom, -0.5f, 0.5f) : 0.0f;
+
+            // A window starting `t` samples into an upchirp peaks in bin `N - t / decim`
+            const float shift = std::fmod(2.0f * N - (best + delta), (float)N) * this->d_decim_factor;
+            *start            = window - (uint64_t)std::lround(shift) % this->d_samples_per_symbol;
+
+            return (int32_t)best;
+        }
+
+        bool preamble_detector::agree() const {
+            const uint32_t N      = this->d_number_of_bins;
+            const uint64_t newest = this->d_windows - 1u;
+
+            if (newest < (uint64_t)(this->d_symbols - 1u) * this->d_windows_per_symbol)
+                return false;
+
+            const int32_t bin = this->d_peaks[newest % this->d_peaks.size()];
+
+            for (uint32_t k = 1u; k < this->d_symbols; k++) {
+                const int32_t  other = this->d_peaks[(newest - k * this->d_windows_per_symbol) % this->d_peaks.size()];
+                const uint32_t diff  = (uint32_t)(other - bin + (int32_t)N) % N;
+
+                // Same bin, or a neighbour when the start lies near a bin edge
+                if (other < 0 || (diff > 1u && diff < N - 1u))
+                    return false;
+            }
+
+            return true;
+        }
+
+        size_t preamble_detector::memory_footprint() const {
+            // Not counted: the liquid-dsp FFT plan
+            return sizeof(*this)
+                 + this->d_workspace.size()
+                 + this->d_peaks.capacity() * sizeof(int32_t);
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,179 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef PREAMBLE_DETECTOR_H
+#define PREAMBLE_DETECTOR_H
+
+#include <liquid/liquid.h>
+#include "lora_complex.h"
+#include <cstdint>
+#include <vector>
+#include "workspace.h"
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Preamble detector** : Streaming search for the repeated upchirps of a preamble.
+         *          <BR>Every `hop` samples, the last symbol's worth of samples is dechirped, integrated
+         *          down to one sample per bin and transformed with an FFT of `number_of_bins` points.
+         *          A window counts as a hit when its strongest bin stands out of the noise floor.
+         *          <BR>Inside a preamble, windows one symbol apart land in the same bin. Once `symbols`
+         *          such windows agree, the preamble is reported with the start of its upchirps
+         *          (from the bin and the window position) and the bin itself.
+         *          <BR>Each sample is pushed once, and costs about `samples_per_symbol / hop` short FFTs per symbol.
+         */
+        class preamble_detector {
+            private:
+                uint32_t          d_samples_per_symbol;     ///< The amount of samples in one symbol.
+                uint32_t          d_number_of_bins;         ///< The amount of bins in a symbol, `2^SF`.
+                uint32_t          d_decim_factor;           ///< The amount of samples in each bin.
+                uint32_t          d_hop;                    ///< Distance between consecutive windows.
+                uint32_t          d_windows_per_symbol;     ///< `samples_per_symbol / hop`.
+                uint32_t          d_symbols;                ///< Amount of agreeing windows needed, one symbol apart.
+                float             d_peak_ratio;             ///< Minimal ratio of the peak bin to the average bin power.
+                float             d_energy_threshold;       ///< Minimal average sample power of a window.
+                const gr_complex *d_downchirp_conj;         ///< The complex conjugate of the ideal downchirp.
+
+                workspace         d_workspace;              ///< Holds every buffer below.
+                gr_complex       *d_buffer;                 ///< Pushed samples, the oldest one at `d_buffer_start`.
+                gr_complex       *d_dechirped;              ///< The dechirped window.
+                gr_complex       *d_fft_in;                 ///< The dechirped window, integrated per bin.
+                gr_complex       *d_fft_out;                ///< Its FFT.
+                fftplan           d_plan;                   ///< The LiquidDSP::FFT_Plan.
+
+                uint32_t          d_buffer_size;            ///< Capacity of `d_buffer`.
+                uint32_t          d_buffer_len;             ///< Samples in `d_buffer`.
+                uint64_t          d_buffer_start;           ///< Absolute index of `d_buffer[0]`.
+                uint64_t          d_next_window;            ///< Absolute index of the next window to look at.
+
+                std::vector<int32_t> d_peaks;               ///< Ring of the peak bin of the last windows, -1 for none.
+                std::vector<float>   d_power;               ///< Power of each bin, for `symbol_snr`.
+                uint64_t          d_windows;                ///< Amount of windows looked at since `reset`.
+                uint64_t          d_fft_windows;            ///< Amount of windows past the energy threshold, ever.
+
+                uint64_t          d_start;                  ///< Absolute index of an upchirp of the detected preamble.
+                uint32_t          d_bin;                    ///< The bin of the detected preamble.
+
+                /**
+                 *  \brief  Dechirp the given symbol and take the FFT of its bins into `d_fft_out`.
+                 */
+                void spectrum(const gr_complex *symbol);
+
+                /**
+                 *  \brief  Return the peak bin of the window at the given absolute index, or -1 if there is none.
+                 *
+                 *  \param  window
+                 *          Absolute index of the first sample of the window.
+                 *  \param  start
+                 *          Absolute index of the upchirp start the peak points to, within one symbol before `window`.
+                 */
+                int32_t peak(const uint64_t window, uint64_t *start);
+
+                /**
+                 *  \brief  Whether the last `d_symbols` windows one symbol apart all peak in (about) the same bin.
+                 */
+                bool agree() const;
+
+            public:
+                /**
+                 *  \brief  Default ctor.
+                 *
+                 *  \param  samples_per_symbol
+                 *          The amount of samples in one symbol.
+                 *  \param  number_of_bins
+                 *          The amount of bins in a symbol, `2^SF`.
+                 *  \param  downchirp_conj
+                 *          The complex conjugate of the ideal downchirp, kept by pointer.
+                 *  \param  hop
+                 *          Distance between consecutive windows, a divisor of `samples_per_symbol`.
+                 *  \param  symbols
+                 *          Amount of preamble symbols that have to agree.
+                 */
+                preamble_detector(const uint32_t samples_per_symbol, const uint32_t number_of_bins,
+                                  const gr_complex *downchirp_conj, const uint32_t hop, const uint32_t symbols = 3u);
+
+                ~preamble_detector();
+
+                preamble_detector(const preamble_detector&)            = delete;
+                preamble_detector& operator=(const preamble_detector&) = delete;
+
+                /**
+                 *  \brief  Look at the given samples, which follow the ones pushed before.
+                 *          <BR>Stops at the first preamble found, see `preamble_start` and `preamble_bin`.
+                 *
+                 *  \param  samples
+                 *          The samples to push.
+                 *  \param  len
+                 *          Length of said array.
+                 *  \return Whether a preamble was found.
+                 */
+                bool push(const gr_complex *samples, const uint32_t len);
+
+                /**
+                 *  \brief  Forget everything pushed and continue at the given absolute index.
+                 */
+                void reset(const uint64_t position);
+
+                /**
+                 *  \brief  Set the minimal average sample power of a window, as an amplitude.
+                 */
+                void set_energy_threshold(const float threshold) { this->d_energy_threshold = threshold * threshold; }
+
+                /**
+                 *  \brief  Return the absolute index of the next sample to push.
+                 */
+                uint64_t position()       const { return this->d_buffer_start + this->d_buffer_len; }
+
+                /**
+                 *  \brief  Return the absolute index of the start of an upchirp of the last preamble found.
+                 *          <BR>It lies at most one symbol before the end of the window that detected it.
+                 */
+                uint64_t preamble_start() const { return this->d_start; }
+
+                /**
+                 *  \brief  Return the bin of the last preamble found, relative to the window that detected it.
+                 */
+                uint32_t preamble_bin()   const { return this->d_bin; }
+
+                /**
+                 *  \brief  Return the amount of windows that passed the energy threshold and were dechirped, since construction.
+                 */
+                uint64_t fft_windows()    const { return this->d_fft_windows; }
+
+                /**
+                 *  \brief  Return the SNR of the given (aligned) symbol in dB, from its peak bin against the noise floor.
+                 *          <BR>The floor is taken from the median bin, as the leakage of a fractional CFO would dominate the mean.
+                 *          The FFT gains `10 log10(2^SF)` dB on the peak, which is taken off again.
+                 *
+                 *  \param  symbol
+                 *          The symbol, `samples_per_symbol` long.
+                 */
+                float symbol_snr(const gr_complex *symbol);
+
+                /**
+                 *  \brief  Return the memory used by this instance in bytes.
+                 */
+                size_t memory_footprint() const;
+        };
+    } // namespace lora
+} // namespace gr
+
+#endif /* PREAMBLE_DETECTOR_H */
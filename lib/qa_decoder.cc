@@ -0,0 +1,197 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/message_debug.h>
+#include <cppunit/TestAssert.h>
+#include <lora/decoder.h>
+#include <lora/multi_sf_decoder.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "qa_decoder.h"
+#include "qa_utilities.h"
+
+namespace gr {
+    namespace lora {
+
+        static const float samp_rate = 1e6f;
+
+        /**
+         *  \brief  Streams the given samples into a block over and over, and stores what it publishes on `"frames"`.
+         *          <BR>Repeating keeps the flowgraph running until every frame of the first pass is delivered,
+         *          so only the first ones are checked.
+         */
+        class frame_flowgraph {
+            private:
+                gr::top_block_sptr             d_tb;
+                blocks::message_debug::sptr    d_frames;
+
+            public:
+                frame_flowgraph(const gr::basic_block_sptr &block, const std::vector<gr_complex> &samples)
+                    : d_tb(gr::make_top_block("qa_decoder")),
+                      d_frames(blocks::message_debug::make()) {
+                    this->d_tb->connect(blocks::vector_source_c::make(samples, true), 0, block, 0);
+                    this->d_tb->msg_connect(block, "frames", this->d_frames, "store");
+                    this->d_tb->start();
+                }
+
+                ~frame_flowgraph() {
+                    this->d_tb->stop();
+                    this->d_tb->wait();
+                }
+
+                /**
+                 *  \brief  Wait up to 10 s for `count` frames, and return whether they all arrived.
+                 */
+                bool wait_for(const int count) {
+                    for (int i = 0; i < 1000 && this->d_frames->num_messages() < count; i++)
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+                    return this->d_frames->num_messages() >= count;
+                }
+
+                pmt::pmt_t frame(const int i) { return this->d_frames->get_message(i); }
+        };
+
+        static uint64_t meta_uint64(const pmt::pmt_t &pdu, const char *key) {
+            return pmt::to_uint64(pmt::dict_ref(pmt::car(pdu), pmt::mp(key), pmt::PMT_NIL));
+        }
+
+        static long meta_long(const pmt::pmt_t &pdu, const char *key) {
+            return pmt::to_long(pmt::dict_ref(pmt::car(pdu), pmt::mp(key), pmt::PMT_NIL));
+        }
+
+        /**
+         *  The payload of a frame PDU, after its 3 HDR bytes.
+         */
+        static std::vector<uint8_t> payload_of(const pmt::pmt_t &pdu) {
+            const std::vector<uint8_t> bytes = pmt::u8vector_elements(pmt::cdr(pdu));
+            return std::vector<uint8_t>(bytes.begin() + 3u, bytes.end());
+        }
+
+        /**
+         *  Whether the frame was found within the preamble starting at `start`.
+         */
+        static bool found_at(const pmt::pmt_t &pdu, const uint64_t start, const frame_encoder &encoder) {
+            const uint64_t index = meta_uint64(pdu, "preamble_index");
+            return index >= start && index < start + 8u * encoder.samples_per_symbol();
+        }
+
+        void qa_decoder::t_header_reject() {
+            const std::vector<uint8_t> a = { 0x01, 0x23, 0x45, 0x67 }, b = { 0x89, 0xab, 0xcd, 0xef };
+            frame_encoder encoder(samp_rate, 7u, 4u);
+            std::vector<gr_complex> samples(4096u);
+
+            append_test_frame(encoder, a, Corruption::HEADER, samples);
+            const uint64_t start = samples.size();
+            append_test_frame(encoder, b, Corruption::NONE,   samples);
+
+            decoder::sptr block = decoder::make(samp_rate, 7, "fft");
+            frame_flowgraph fg(block, samples);
+
+            // Only the intact frame, the corrupt HDR is not published with a random length
+            CPPUNIT_ASSERT(fg.wait_for(1));
+            CPPUNIT_ASSERT(payload_of(fg.frame(0)) == b);
+            CPPUNIT_ASSERT(found_at(fg.frame(0), start, encoder));
+        }
+
+        void qa_decoder::t_crc_drop() {
+            const std::vector<uint8_t> a = { 0x01, 0x23, 0x45, 0x67 }, b = { 0x89, 0xab, 0xcd, 0xef };
+            frame_encoder encoder(samp_rate, 7u, 4u);
+            std::vector<gr_complex> samples(4096u);
+
+            append_test_frame(encoder, a, Corruption::PAYLOAD, samples);
+            const uint64_t start = samples.size();
+            append_test_frame(encoder, b, Corruption::NONE,    samples);
+
+            decoder::sptr block = decoder::make(samp_rate, 7, "fft");
+            block->set_crc_check("drop");
+            frame_flowgraph fg(block, samples);
+
+            CPPUNIT_ASSERT(fg.wait_for(1));
+            CPPUNIT_ASSERT(payload_of(fg.frame(0)) == b);
+            CPPUNIT_ASSERT(found_at(fg.frame(0), start, encoder));
+            CPPUNIT_ASSERT(pmt::to_bool(pmt::dict_ref(pmt::car(fg.frame(0)), pmt::mp("crc_ok"), pmt::PMT_F)));
+        }
+
+        void qa_decoder::t_hot_swap() {
+            const std::vector<uint8_t> a = { 0x01, 0x23, 0x45, 0x67 }, b = { 0x89, 0xab, 0xcd, 0xef };
+            frame_encoder sf7(samp_rate, 7u, 4u), sf8(samp_rate, 8u, 4u);
+            std::vector<gr_complex> samples(4096u);
+
+            append_test_frame(sf7, a, Corruption::NONE, samples);
+            const uint64_t start = samples.size();
+            append_test_frame(sf8, b, Corruption::NONE, samples);
+            const uint64_t period = samples.size();
+
+            // Built and sized for before the start, swapped in once the first SF 7 frame is out
+            decoder::sptr block = decoder::make(samp_rate, 7, "fft");
+            block->prepare(8u, samp_rate);
+            frame_flowgraph fg(block, samples);
+
+            CPPUNIT_ASSERT(fg.wait_for(1));
+            CPPUNIT_ASSERT_EQUAL(7L, meta_long(fg.frame(0), "sf"));
+            CPPUNIT_ASSERT(block->set_sf(8u));
+
+            // The next SF 8 frame, counted on in the same stream indices: each period has one frame per SF, so the
+            // swap is due within the SF 7 frames of a few periods
+            const int max_sf7_frames = 4;
+            int i = 1;
+            while (i <= max_sf7_frames && fg.wait_for(i + 1) && meta_long(fg.frame(i), "sf") != 8L)
+                i++;
+
+            CPPUNIT_ASSERT(i <= max_sf7_frames && fg.wait_for(i + 1));
+            CPPUNIT_ASSERT(payload_of(fg.frame(i)) == b);
+            CPPUNIT_ASSERT(found_at(fg.frame(i), start + meta_uint64(fg.frame(i), "preamble_index") / period * period, sf8));
+        }
+
+        void qa_decoder::t_multi_sf() {
+            const std::vector<uint8_t> a = { 0x01, 0x23, 0x45, 0x67 }, b = { 0x89, 0xab, 0xcd, 0xef };
+            frame_encoder sf7(samp_rate, 7u, 4u), sf8(samp_rate, 8u, 4u);
+            std::vector<gr_complex> samples(4096u);
+
+            // Both SFs through the same gate, each with a corrupt and an intact frame
+            append_test_frame(sf7, a, Corruption::HEADER,  samples);
+            const uint64_t start7 = samples.size();
+            append_test_frame(sf7, a, Corruption::NONE,    samples);
+            append_test_frame(sf8, b, Corruption::PAYLOAD, samples);
+            const uint64_t start8 = samples.size();
+            append_test_frame(sf8, b, Corruption::NONE,    samples);
+
+            multi_sf_decoder::sptr block = multi_sf_decoder::make(samp_rate, std::vector<int>{ 7, 8 }, 0, "fft");
+            block->set_crc_check("drop");
+            frame_flowgraph fg(block, samples);
+
+            // The lanes publish from their own threads, in any order
+            CPPUNIT_ASSERT(fg.wait_for(2));
+            for (int i = 0; i < 2; i++) {
+                const bool is_sf7 = meta_long(fg.frame(i), "sf") == 7L;
+
+                CPPUNIT_ASSERT(payload_of(fg.frame(i)) == (is_sf7 ? a : b));
+                CPPUNIT_ASSERT(found_at(fg.frame(i), is_sf7 ? start7 : start8, is_sf7 ? sf7 : sf8));
+            }
+            CPPUNIT_ASSERT(meta_long(fg.frame(0), "sf") != meta_long(fg.frame(1), "sf"));
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,72 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include "qa_demodulator.h"
+#include "qa_utilities.h"
+#include "kernels.h"
+#include "demodulator.h"
+
+namespace gr {
+    namespace lora {
+
+        typedef kernels::complex_t complex_t;
+
+        void qa_demodulator::t_demodulators() {
+            const uint32_t sps = 1024u, bins = 128u, decim = sps / bins;
+            const std::vector<complex_t> upchirp = test_chirp(sps, 0.0f);
+            std::vector<complex_t> downchirp_conj(sps), symbol(sps);
+
+            for (uint32_t i = 0u; i < sps; i++) {
+                downchirp_conj[i] = std::conj(std::conj(upchirp[i]));
+            }
+
+            gradient_demodulator gradient(sps, bins);
+            fft_demodulator      fft(sps, bins, &downchirp_conj[0]);
+
+            for (uint32_t v = 0u; v < bins; v++) {
+                for (uint32_t i = 0u; i < sps; i++) {
+                    symbol[i] = upchirp[(i + v * decim) % sps];
+                }
+
+                // Symbol `v` lands in bin `bins - v`, symbol 0 in the last bin
+                const uint32_t expected = v ? bins - v : bins;
+                CPPUNIT_ASSERT_EQUAL(expected, fft.demodulate(&symbol[0], false));
+                CPPUNIT_ASSERT_EQUAL(expected - 1u, fft.demodulate(&symbol[0], true));
+
+                // Misses the edge of symbol 1, which falls in the first bin
+                if (v != 1u) {
+                    CPPUNIT_ASSERT_EQUAL(expected, gradient.demodulate(&symbol[0], false));
+                }
+            }
+
+
+            // "auto" keeps one of the two, anything else is rejected
+            const std::string chosen = demodulator::make("auto", sps, bins, &downchirp_conj[0], &upchirp[0])->name();
+            CPPUNIT_ASSERT(chosen == "gradient" || chosen == "fft");
+            CPPUNIT_ASSERT_THROW(demodulator::make("fastest", sps, bins, &downchirp_conj[0], &upchirp[0]), std::invalid_argument);
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
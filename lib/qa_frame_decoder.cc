@@ -0,0 +1,118 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include <algorithm>
+#include <vector>
+#include "qa_frame_decoder.h"
+#include "frame_decoder.h"
+#include "frame_encoder.h"
+#include "tables.h"
+#include "utilities.h"
+
+namespace gr {
+    namespace lora {
+
+        void qa_frame_decoder::t_payload_crc() {
+            const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+            CPPUNIT_ASSERT_EQUAL((uint16_t)0x31c3u, gr::lora::crc16_ccitt(check, sizeof(check)));
+
+            uint8_t payload[] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+            const uint16_t crc = gr::lora::payload_crc(payload, sizeof(payload));
+            CPPUNIT_ASSERT_EQUAL((uint16_t)(gr::lora::crc16_ccitt(payload, 6u) ^ 0xcdefu), crc);
+
+            for (uint32_t bit = 0u; bit < 8u * sizeof(payload); bit++) {
+                payload[bit / 8u] ^= 1u << (bit % 8u);
+                CPPUNIT_ASSERT(gr::lora::payload_crc(payload, sizeof(payload)) != crc);
+                payload[bit / 8u] ^= 1u << (bit % 8u);
+            }
+        }
+
+        void qa_frame_decoder::t_bit_pipeline() {
+            uint32_t lcg = 12345u;
+
+            // Every block size, of the payload (`SF` bits) and of the HDR (`SF - 2` bits)
+            for (uint32_t sf = 7u; sf <= 12u; sf++) {
+                for (uint32_t ppm = sf - 2u; ppm <= sf; ppm += 2u) {
+                    for (uint32_t count = 5u; count <= 8u; count++) {
+                        for (uint32_t trial = 0u; trial < 64u; trial++) {
+                            uint32_t words[8];
+                            uint8_t  fast[12], generic[12];
+
+                            for (uint32_t &w : words) {
+                                lcg = lcg * 1103515245u + 12345u;
+                                w   = (lcg >> 8) & ((1u << ppm) - 1u);
+                            }
+
+                            frame_decoder::deinterleave(words, count, ppm, fast);
+                            frame_decoder::deinterleave_generic(words, count, ppm, generic);
+
+                            CPPUNIT_ASSERT(std::equal(fast, fast + ppm, generic));
+                        }
+                    }
+                }
+            }
+
+            // Every codeword against several whitening bytes, and an odd length
+            std::vector<uint8_t> words(1023u);
+            for (uint32_t i = 0u; i < words.size(); i++)
+                words[i] = (uint8_t)(i * 7u);
+
+            for (uint8_t sf = 7u; sf <= 12u; sf++) {
+                uint32_t       length;
+                const uint8_t *prng     = gr::lora::payload_whitening_sequence(sf, &length);
+                const uint8_t *shuffled = gr::lora::payload_whitening_sequence(sf, nullptr, true);
+
+                // The sequence covers the longest payload but at SF 7, whose capture is shorter
+                const uint32_t max_length = frame_encoder(1e6f, sf, 4u).max_payload_length();
+                CPPUNIT_ASSERT(sf == 7u ? max_length < 255u : max_length == 255u);
+
+                // Whitening undoes dewhitening
+                std::vector<uint8_t> white(length), undone(length);
+                frame_decoder::dewhiten(&words[0], length - 3u, prng, &white[0]);
+                frame_encoder::whiten(&white[0], length - 3u, prng, &undone[0]);
+                CPPUNIT_ASSERT(std::equal(undone.begin(), undone.end() - 3u, words.begin()));
+
+                const uint32_t count = (length - 2u) | 1u;
+                for (uint8_t cr = 1u; cr <= 4u; cr++) {
+                    std::vector<uint8_t> deshuffled(count), dewhitened(count);
+                    std::vector<uint8_t> chain(count / 2u + 1u), fused(count / 2u + 1u);
+
+                    frame_decoder::deshuffle(&words[0], count, &deshuffled[0]);
+                    frame_decoder::dewhiten(&deshuffled[0], count, prng, &dewhitened[0]);
+                    frame_decoder::hamming_decode(&dewhitened[0], count, cr, &chain[0]);
+                    frame_decoder::decode_codewords(&words[0], count, shuffled, cr, &fused[0]);
+
+                    CPPUNIT_ASSERT(chain == fused);
+                }
+            }
+
+            // The captured words are used as found
+            static const uint8_t found_sf7[] = { 0xdc, 0xec, 0xb0, 0xf4, 0x9c, 0xfc, 0xc4, 0xdc, 0x10, 0xf8, 0x40, 0x34 };
+            static const uint8_t found_sf8[] = { 0xbd, 0xdf, 0xa4, 0xfb, 0x16, 0x7f, 0x85, 0xfe, 0x40, 0xdf, 0x5b, 0xb0 };
+            uint32_t sf7_length;
+            CPPUNIT_ASSERT(std::equal(found_sf7, found_sf7 + 12u, gr::lora::payload_whitening_sequence(7u, &sf7_length)));
+            CPPUNIT_ASSERT(std::equal(found_sf8, found_sf8 + 12u, gr::lora::payload_whitening_sequence(8u)));
+            CPPUNIT_ASSERT_EQUAL(343u, sf7_length);
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,116 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include <vector>
+#include <cmath>
+#include "qa_kernels.h"
+#include "qa_utilities.h"
+#include "kernels.h"
+
+namespace gr {
+    namespace lora {
+
+        typedef kernels::complex_t complex_t;
+
+        void qa_kernels::t_instantaneous_frequency() {
+            const std::vector<complex_t> in = test_chirp();
+            std::vector<float> expected(in.size()), result(in.size());
+
+            kernels::instantaneous_frequency_generic(&in[0], &expected[0], in.size());
+            kernels::instantaneous_frequency        (&in[0], &result[0],   in.size());
+
+            for (uint32_t i = 0u; i < in.size(); i++) {
+                // An approximated atan2 may land on the other side of +-pi, compare modulo 2pi
+                float d = result[i] - expected[i];
+                d -= 2.0f * M_PI * std::round(d / (2.0f * M_PI));
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, d, 1e-3);
+            }
+        }
+
+        void qa_kernels::t_stddev() {
+            const std::vector<complex_t> in = test_chirp();
+            std::vector<float> ifreq(in.size());
+            kernels::instantaneous_frequency_generic(&in[0], &ifreq[0], in.size());
+
+            float mean = 0.0f;
+            for (uint32_t i = 0u; i < ifreq.size(); i++) mean += ifreq[i];
+            mean /= ifreq.size();
+
+            const float expected = kernels::stddev_generic(&ifreq[0], ifreq.size(), mean);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, kernels::stddev(&ifreq[0], ifreq.size(), mean), 1e-4 * expected);
+        }
+
+        void qa_kernels::t_cross_correlate_ifreq() {
+            const std::vector<complex_t> ideal = test_chirp(1024u, 0.0f);
+            const std::vector<complex_t> noisy = test_chirp(1024u, 0.3f);
+            std::vector<float> ideal_ifreq(ideal.size()), noisy_ifreq(noisy.size());
+
+            kernels::instantaneous_frequency_generic(&ideal[0], &ideal_ifreq[0], ideal.size());
+            kernels::instantaneous_frequency_generic(&noisy[0], &noisy_ifreq[0], noisy.size());
+
+            for (uint32_t shift = 0u; shift < 64u; shift += 8u) {
+                const uint32_t len      = ideal.size() - 1u - shift;
+                const float    expected = kernels::cross_correlate_ifreq_generic(&noisy_ifreq[shift], &ideal_ifreq[0], len);
+
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, kernels::cross_correlate_ifreq(&noisy_ifreq[shift], &ideal_ifreq[0], len), 1e-3);
+            }
+
+            // Correlating with itself is the upper bound
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, kernels::cross_correlate_ifreq(&ideal_ifreq[0], &ideal_ifreq[0], ideal.size() - 1u), 2e-3);
+        }
+
+        void qa_kernels::t_energy() {
+            const std::vector<complex_t> in = test_chirp();
+            const float expected = kernels::energy_generic(&in[0], in.size());
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, kernels::energy(&in[0], in.size()), 1e-4 * expected);
+        }
+
+        void qa_kernels::t_dechirp() {
+            const std::vector<complex_t> in    = test_chirp(1024u, 0.3f);
+            const std::vector<complex_t> chirp = test_chirp(1024u, 0.0f);
+            std::vector<complex_t> expected(in.size()), result(in.size());
+
+            kernels::dechirp_generic(&expected[0], &in[0], &chirp[0], in.size());
+            kernels::dechirp        (&result[0],   &in[0], &chirp[0], in.size());
+
+            for (uint32_t i = 0u; i < in.size(); i++) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, std::abs(expected[i] - result[i]), 1e-5);
+            }
+        }
+
+        void qa_kernels::t_argmax_magnitude() {
+            std::vector<complex_t> in = test_chirp(4096u, 0.3f);
+            std::vector<float> scratch(in.size());
+
+            for (uint32_t peak = 1u; peak < in.size(); peak *= 3u) {
+                in[peak] = complex_t(10.0f, -10.0f);
+
+                CPPUNIT_ASSERT_EQUAL(peak, kernels::argmax_magnitude_generic(&in[0], &scratch[0], in.size()));
+                CPPUNIT_ASSERT_EQUAL(peak, kernels::argmax_magnitude        (&in[0], &scratch[0], in.size()));
+
+                in[peak] = complex_t(0.0f, 0.0f);
+            }
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
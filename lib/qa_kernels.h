@@ -0,0 +1,56 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _QA_KERNELS_H_
+#define _QA_KERNELS_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCase.h>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  Compare the VOLK kernels against the original scalar implementations.
+         */
+        class qa_kernels : public CppUnit::TestCase {
+            public:
+                CPPUNIT_TEST_SUITE(qa_kernels);
+                CPPUNIT_TEST(t_instantaneous_frequency);
+                CPPUNIT_TEST(t_stddev);
+                CPPUNIT_TEST(t_cross_correlate_ifreq);
+                CPPUNIT_TEST(t_energy);
+                CPPUNIT_TEST(t_dechirp);
+                CPPUNIT_TEST(t_argmax_magnitude);
+                CPPUNIT_TEST_SUITE_END();
+
+            private:
+                void t_instantaneous_frequency();
+                void t_stddev();
+                void t_cross_correlate_ifreq();
+                void t_energy();
+                void t_dechirp();
+                void t_argmax_magnitude();
+        };
+
+    } /* namespace lora */
+} /* namespace gr */
+
+#endif /* _QA_KERNELS_H_ */
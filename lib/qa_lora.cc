@@ -26,11 +26,27 @@
  */
 
 #include "qa_lora.h"
+#include "qa_kernels.h"
+#include "qa_upchirp_correlator.h"
+#include "qa_demodulator.h"
+#include "qa_preamble_detector.h"
+#include "qa_frame_decoder.h"
+#include "qa_phy_decoder.h"
+#include "qa_traffic_generator.h"
+#include "qa_decoder.h"
 
 CppUnit::TestSuite *
 qa_lora::suite()
 {
   CppUnit::TestSuite *s = new CppUnit::TestSuite("lora");
+  s->addTest(gr::lora::qa_kernels::suite());
+  s->addTest(gr::lora::qa_upchirp_correlator::suite());
+  s->addTest(gr::lora::qa_demodulator::suite());
+  s->addTest(gr::lora::qa_preamble_detector::suite());
+  s->addTest(gr::lora::qa_frame_decoder::suite());
+  s->addTest(gr::lora::qa_phy_decoder::suite());
+  s->addTest(gr::lora::qa_traffic_generator::suite());
+  s->addTest(gr::lora::qa_decoder::suite());
 
   return s;
 }
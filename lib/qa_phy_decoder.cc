@@ -0,0 +1,152 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "qa_phy_decoder.h"
+#include "qa_utilities.h"
+#include "noise_floor.h"
+#include "phy_decoder.h"
+#include "utilities.h"
+
+namespace gr {
+    namespace lora {
+
+        void qa_phy_decoder::t_header_checksum() {
+            // Length 8, CR 4/8 with payload CRC
+            const uint8_t hdr[3]  = { 0x0u, 0x8u, 0x9u };
+            const uint8_t checksum = gr::lora::header_checksum(hdr[0], hdr[1], hdr[2]);
+
+            for (uint32_t bit = 0u; bit < 12u; bit++) {
+                uint8_t corrupt[3] = { hdr[0], hdr[1], hdr[2] };
+                corrupt[bit / 4u] ^= 1u << (bit % 4u);
+
+                CPPUNIT_ASSERT(gr::lora::header_checksum(corrupt[0], corrupt[1], corrupt[2]) != checksum);
+            }
+        }
+
+        void qa_phy_decoder::t_noise_floor() {
+            gr::lora::noise_floor floor;
+
+            floor.update(1e-2f);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1e-2f, floor.power(), 1e-9f);
+
+            // A frame 30 dB above the floor hardly moves it
+            for (uint32_t i = 0u; i < 20u; i++) floor.update(10.0f);
+            CPPUNIT_ASSERT(floor.power() < 2e-2f);
+
+            // A quieter band is followed within some windows
+            for (uint32_t i = 0u; i < 100u; i++) floor.update(1e-4f);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1e-4f, floor.power(), 1e-5f);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(std::sqrt(2.0f * floor.power()), floor.threshold(10.0f * std::log10(2.0f)), 1e-6f);
+        }
+
+        void qa_phy_decoder::t_header_check() {
+            const std::vector<uint8_t> payload = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+            frame_encoder encoder(1e6f, 7u, 4u);
+            std::vector<gr_complex> samples(4096u);
+
+            append_test_frame(encoder, payload, Corruption::HEADER,  samples);
+            append_test_frame(encoder, payload, Corruption::NONE,    samples);
+            append_test_frame(encoder, payload, Corruption::PAYLOAD, samples);
+
+            std::vector<frame_info> frames;
+            phy_decoder decoder(1e6f, 7u, "fft", false);
+            decoder.set_frame_callback([&](const uint8_t *bytes, const uint32_t len, const frame_info &info) {
+                frames.push_back(info);
+            });
+
+            for (size_t pos = 0u; pos + decoder.samples_needed() <= samples.size(); )
+                pos += decoder.process(&samples[pos], &samples[pos]);
+            decoder.flush();
+
+            // The corrupt HDR is rejected before its payload, the corrupt payload only fails its CRC
+            CPPUNIT_ASSERT_EQUAL((uint64_t)1u, decoder.header_failures());
+            CPPUNIT_ASSERT(decoder.symbols_saved() > 0u);
+            CPPUNIT_ASSERT_EQUAL((size_t)2u, frames.size());
+            CPPUNIT_ASSERT(frames[0].crc_checked && frames[0].crc_ok);
+            CPPUNIT_ASSERT(frames[1].crc_checked && !frames[1].crc_ok);
+        }
+
+        void qa_phy_decoder::t_crc_flag() {
+            const uint8_t payload[] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+            frame_encoder encoder(1e6f, 7u, 4u);
+            std::vector<gr_complex> samples(4096u);
+
+            // Without a CRC, then with one
+            encoder.set_crc(false);
+            encoder.modulate(payload, sizeof(payload), samples);
+            samples.resize(samples.size() + 4096u);
+            encoder.set_crc(true);
+            encoder.modulate(payload, sizeof(payload), samples);
+            samples.resize(samples.size() + 4096u);
+
+            std::vector<frame_info> frames;
+            phy_decoder decoder(1e6f, 7u, "fft", false);
+            decoder.set_crc_check(CrcCheck::DROP);
+            decoder.set_frame_callback([&](const uint8_t *bytes, const uint32_t len, const frame_info &info) {
+                CPPUNIT_ASSERT(std::equal(payload, payload + sizeof(payload), bytes + 3u));
+                CPPUNIT_ASSERT_EQUAL((uint32_t)sizeof(payload) + 3u, len);
+                frames.push_back(info);
+            });
+
+            for (size_t pos = 0u; pos + decoder.samples_needed() <= samples.size(); )
+                pos += decoder.process(&samples[pos], &samples[pos]);
+            decoder.flush();
+
+            // Not dropped for lack of a CRC to match
+            CPPUNIT_ASSERT_EQUAL((size_t)2u, frames.size());
+            CPPUNIT_ASSERT(!frames[0].has_crc && !frames[0].crc_checked);
+            CPPUNIT_ASSERT(frames[1].has_crc && frames[1].crc_checked && frames[1].crc_ok);
+        }
+
+        void qa_phy_decoder::t_decode_thread() {
+            const std::vector<uint8_t> payload = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+            frame_encoder encoder(1e6f, 7u, 4u);
+            std::vector<gr_complex> samples(4096u);
+
+            for (uint32_t i = 0u; i < 3u; i++)
+                append_test_frame(encoder, payload, Corruption::NONE, samples);
+
+            std::vector<frame_info> frames;
+            phy_decoder decoder(1e6f, 7u, "fft", false);
+            decoder.set_frame_callback([&](const uint8_t *bytes, const uint32_t len, const frame_info &info) {
+                frames.push_back(info);
+            });
+
+            // Handed over mid-frame, as `decoder_impl` does when it swaps configurations
+            uint32_t steps = 0u;
+            for (size_t pos = 0u; pos + decoder.samples_needed() <= samples.size(); steps++) {
+                if (steps % 7u == 0u)
+                    decoder.set_decode_thread(steps % 14u == 0u);
+                pos += decoder.process(&samples[pos], &samples[pos]);
+            }
+            decoder.flush();
+
+            CPPUNIT_ASSERT_EQUAL((size_t)3u, frames.size());
+            for (const frame_info &info : frames)
+                CPPUNIT_ASSERT(info.crc_checked && info.crc_ok);
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
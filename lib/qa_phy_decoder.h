@@ -0,0 +1,55 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _QA_PHY_DECODER_H_
+#define _QA_PHY_DECODER_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCase.h>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  Check the HDR checksum and the noise floor, then decode generated frames with a bad HDR or without a CRC,
+         *          and while the decode thread comes and goes.
+         */
+        class qa_phy_decoder : public CppUnit::TestCase {
+            public:
+                CPPUNIT_TEST_SUITE(qa_phy_decoder);
+                CPPUNIT_TEST(t_header_checksum);
+                CPPUNIT_TEST(t_noise_floor);
+                CPPUNIT_TEST(t_header_check);
+                CPPUNIT_TEST(t_crc_flag);
+                CPPUNIT_TEST(t_decode_thread);
+                CPPUNIT_TEST_SUITE_END();
+
+            private:
+                void t_header_checksum();
+                void t_noise_floor();
+                void t_header_check();
+                void t_crc_flag();
+                void t_decode_thread();
+        };
+
+    } /* namespace lora */
+} /* namespace gr */
+
+#endif /* _QA_PHY_DECODER_H_ */
@@ -0,0 +1,70 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include <algorithm>
+#include <vector>
+#include "qa_preamble_detector.h"
+#include "qa_utilities.h"
+#include "kernels.h"
+#include "preamble_detector.h"
+
+namespace gr {
+    namespace lora {
+
+        typedef kernels::complex_t complex_t;
+
+        void qa_preamble_detector::t_preamble_detector() {
+            const uint32_t sps = 1024u, bins = 128u, start = 3000u;
+            const std::vector<complex_t> upchirp = test_chirp(sps, 0.0f);
+            std::vector<complex_t> downchirp_conj(sps), samples(start + 8u * sps, complex_t(0.0f, 0.0f));
+
+            for (uint32_t i = 0u; i < sps; i++) {
+                downchirp_conj[i] = std::conj(std::conj(upchirp[i]));
+            }
+            for (uint32_t i = 0u; i < 8u * sps; i++) {
+                samples[start + i] = upchirp[i % sps];
+            }
+
+            // Pushed in odd-sized pieces, so windows span several pushes
+            preamble_detector detector(sps, bins, &downchirp_conj[0], sps / 4u);
+            bool     found  = false;
+            uint32_t pushed = 0u;
+
+            while (!found && pushed < samples.size()) {
+                const uint32_t len = std::min(333u, (uint32_t)samples.size() - pushed);
+                found   = detector.push(&samples[pushed], len);
+                pushed += len;
+            }
+
+            // Found within the preamble, on an upchirp boundary
+            CPPUNIT_ASSERT(found);
+            CPPUNIT_ASSERT(detector.preamble_start() >= start);
+            CPPUNIT_ASSERT(detector.preamble_start() < start + 8u * sps);
+            CPPUNIT_ASSERT_EQUAL(0u, (uint32_t)(detector.preamble_start() - start) % sps);
+
+            // Nothing in silence
+            detector.reset(0u);
+            CPPUNIT_ASSERT(!detector.push(&samples[0], start));
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include <algorithm>
+#include <vector>
+#include "qa_traffic_generator.h"
+#include "phy_decoder.h"
+#include "traffic_generator.h"
+
+namespace gr {
+    namespace lora {
+
+        void qa_traffic_generator::t_traffic_generator() {
+            traffic_config config;
+            config.duration    = 3.0;
+            config.nodes       = 3u;
+            config.packet_rate = 1.0;
+            config.offset      = 0.0;       // Already channelized
+            config.noise_level = -100.0f;
+            config.min_snr     = config.max_snr = 100.0f;
+            config.seed        = 3u;
+
+            traffic_generator generator(config);
+            const std::vector<traffic_packet> &packets = generator.packets();
+            CPPUNIT_ASSERT(!packets.empty());
+
+            for (size_t i = 0u; i < packets.size(); i++) {
+                bool overlaps = false;
+                for (size_t j = 0u; j < packets.size(); j++)
+                    overlaps |= j != i && packets[j].start < packets[i].start + packets[i].samples && packets[i].start < packets[j].start + packets[j].samples;
+
+                CPPUNIT_ASSERT(packets[i].start + packets[i].samples <= generator.total_samples());
+                CPPUNIT_ASSERT(i == 0u || packets[i - 1u].start <= packets[i].start);
+                CPPUNIT_ASSERT_EQUAL(overlaps, packets[i].collided);
+            }
+
+            // Streamed in blocks, or all at once after a rewind: the same samples
+            std::vector<gr_complex> streamed(generator.total_samples()), whole(generator.total_samples());
+            for (size_t pos = 0u; pos < streamed.size(); )
+                pos += generator.generate(&streamed[pos], 1000u);
+            CPPUNIT_ASSERT_EQUAL(0u, generator.generate(&whole[0], 1000u));
+
+            generator.rewind();
+            CPPUNIT_ASSERT_EQUAL((uint32_t)whole.size(), generator.generate(&whole[0], whole.size()));
+            CPPUNIT_ASSERT(streamed == whole);
+
+            // Every packet that did not collide decodes
+            std::vector<std::vector<uint8_t> > decoded;
+            phy_decoder decoder(config.samp_rate, 7u, "fft", false);
+            decoder.set_frame_callback([&](const uint8_t *bytes, const uint32_t len, const frame_info &info) {
+                if (info.crc_ok)
+                    decoded.push_back(std::vector<uint8_t>(bytes + 3u, bytes + len));
+            });
+
+            for (size_t pos = 0u; pos + decoder.samples_needed() <= whole.size(); )
+                pos += decoder.process(&whole[pos], &whole[pos]);
+            decoder.flush();
+
+            for (const traffic_packet &p : packets)
+                CPPUNIT_ASSERT(p.collided || std::find(decoded.begin(), decoded.end(), p.payload) != decoded.end());
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -0,0 +1,67 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include <vector>
+#include "qa_upchirp_correlator.h"
+#include "qa_utilities.h"
+#include "kernels.h"
+#include "upchirp_correlator.h"
+
+namespace gr {
+    namespace lora {
+
+        typedef kernels::complex_t complex_t;
+
+        void qa_upchirp_correlator::t_upchirp_correlator() {
+            const std::vector<complex_t> ideal = test_chirp(1024u, 0.0f);
+            const std::vector<complex_t> noisy = test_chirp(1024u, 0.1f);
+            std::vector<float> ideal_ifreq(ideal.size()), window_ifreq(2u * noisy.size());
+
+            kernels::instantaneous_frequency(&ideal[0], &ideal_ifreq[0], ideal.size());
+
+            // Two noisy upchirps, the second one starting at 1024 - 100
+            std::vector<complex_t> window(2u * noisy.size());
+            for (uint32_t i = 0u; i < window.size(); i++) {
+                window[i] = noisy[(i + 100u) % noisy.size()];
+            }
+            kernels::instantaneous_frequency(&window[0], &window_ifreq[0], window.size());
+
+            upchirp_correlator correlator;
+            correlator.set_ideal(&ideal_ifreq[0], ideal.size() - 1u);
+            CPPUNIT_ASSERT(correlator.is_linear());
+
+            // Every single offset, and a whole range at once
+            for (uint32_t i = 900u; i < 950u; i++) {
+                int32_t index = -1, index_direct = -1;
+                const float expected = correlator.best_direct(&window_ifreq[0], window.size(), i, i + 1u, &index_direct);
+
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, correlator.best(&window_ifreq[0], window.size(), i, i + 1u, &index), 1e-4);
+                CPPUNIT_ASSERT_EQUAL(index_direct, index);
+            }
+
+            int32_t index = -1;
+            CPPUNIT_ASSERT(correlator.best(&window_ifreq[0], window.size(), 900u, 950u, &index) > 0.9f);
+            CPPUNIT_ASSERT_EQUAL(1024 - 100, index);
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
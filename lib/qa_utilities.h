@@ -0,0 +1,88 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _QA_UTILITIES_H_
+#define _QA_UTILITIES_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "lora_complex.h"
+#include "frame_encoder.h"
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  Noisy upchirp (SF7, 1 MS/s) as test input. Deterministic, so failures are reproducible.
+         */
+        inline std::vector<gr_complex> test_chirp(const uint32_t len = 1024u, const float noise = 0.1f) {
+            std::vector<gr_complex> v(len);
+            uint32_t lcg = 12345u;
+
+            for (uint32_t i = 0u; i < len; i++) {
+                const double t     = i / 1e6;
+                const double phase = -2.0 * M_PI * t * (62500.0 - 0.5 * 125000.0 * (125000.0 / 128.0) * t);
+
+                lcg = lcg * 1103515245u + 12345u;
+                const float n_re = noise * ((lcg >> 16) / 32768.0f - 1.0f);
+                lcg = lcg * 1103515245u + 12345u;
+                const float n_im = noise * ((lcg >> 16) / 32768.0f - 1.0f);
+
+                v[i] = gr_complex(std::cos(phase) + n_re, std::sin(phase) + n_im);
+            }
+
+            return v;
+        }
+
+        /**
+         *  \brief  The part of a generated frame `append_test_frame` corrupts.
+         */
+        enum class Corruption : uint8_t {
+            NONE,
+            HEADER,
+            PAYLOAD
+        };
+
+        /**
+         *  Append a frame of `encoder` and 8 symbols of silence, which is enough for any decoder to finish it.
+         *  <BR>A corruption moves three symbols of the HDR or of the first payload block half a symbol,
+         *  more bit errors per codeword than the Hamming code corrects.
+         */
+        inline void append_test_frame(const frame_encoder &encoder, const std::vector<uint8_t> &payload,
+                                      const Corruption corruption, std::vector<gr_complex> &samples) {
+            const uint32_t N = 1u << encoder.sf();
+            std::vector<uint32_t> symbols;
+
+            encoder.encode(payload.data(), payload.size(), symbols);
+
+            // The HDR block is the first 8 symbols
+            const uint32_t first = corruption == Corruption::HEADER ? 0u : 8u;
+            for (uint32_t i = first; i < first + 3u && corruption != Corruption::NONE; i++)
+                symbols[i] = (symbols[i] + N / 2u) % N;
+
+            encoder.modulate(symbols, samples);
+            samples.resize(samples.size() + 8u * encoder.samples_per_symbol());
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
+
+#endif /* _QA_UTILITIES_H_ */
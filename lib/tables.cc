@@ -0,0 +1,388 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include "tables.h"
+
+namespace gr {
+    namespace lora {
+
+        namespace {
+
+            /**
+             *  The longest payload (255 bytes and its CRC) in codewords, which start in the HDR block (`SF - 7` of them)
+             *  and fill whole blocks of `SF` codewords.
+             */
+            constexpr uint32_t whitening_length(const uint32_t sf) {
+                return (sf - 7u) + (255u * 8u + 16u + 4u * sf - 1u) / (4u * sf) * sf;
+            }
+
+            constexpr uint8_t shuffle_pattern[8] = {7, 6, 3, 4, 2, 1, 0, 5};
+
+            constexpr uint8_t bit(const uint8_t v, const uint32_t i) {
+                return (uint8_t)((v >> i) & 1u);
+            }
+
+            /**
+             *  As `frame_encoder::shuffle` on a single word.
+             */
+            constexpr uint8_t shuffle(const uint8_t w, const uint32_t j = 0u) {
+                return j == 8u ? 0u : (uint8_t)(bit(w, j) << shuffle_pattern[j] | shuffle(w, j + 1u));
+            }
+
+            template <uint32_t N>
+            struct sequence {
+                uint8_t words[N];
+            };
+
+            template <uint32_t... I> struct indices {};
+            template <uint32_t N, uint32_t... I> struct make_indices : make_indices<N - 1u, N - 1u, I...> {};
+            template <uint32_t... I> struct make_indices<0u, I...> { typedef indices<I...> type; };
+
+            template <uint32_t N, uint32_t... I>
+            constexpr sequence<N> shuffle_sequence(const sequence<N> &s, indices<I...>) {
+                return {{ shuffle(s.words[I])... }};
+            }
+
+            /**
+             *  HDR whitening sequence.
+             */
+            constexpr sequence<5> prng_header = {{
+                0x22, 0x11, 0x01, 0x00, 0x00
+            }};
+
+            /**
+             *  Whitening sequence for payload with SF 7, as found in captures (`examples/lora-whitening`).
+             *  <BR>Taken at a lower CR, so without the 2 lowest bits of every word, and only 343 words long: which bounds
+             *  the payload at SF 7 (see `frame_encoder::max_payload_length`).
+             */
+            constexpr uint8_t found_payload_sf7[] = {
+                0xDC, 0xEC, 0xB0, 0xF4, 0x9C, 0xFC, 0xC4, 0xDC, 0x10, 0xF8, 0x40, 0x34, 0xA8, 0x5C, 0xF0, 0x94,
+                0x60, 0x08, 0xF8, 0x48, 0xBC, 0x88, 0xA4, 0xD4, 0x14, 0xE4, 0x84, 0x38, 0x68, 0xEC, 0xE4, 0xBC,
+                0xB0, 0x1C, 0x14, 0xA4, 0x3C, 0x4C, 0x90, 0x60, 0x84, 0x70, 0x20, 0x44, 0x04, 0x24, 0x80, 0x98,
+                0x40, 0xA4, 0x58, 0x04, 0xA0, 0x80, 0x98, 0x40, 0xA4, 0x10, 0x4C, 0x40, 0x60, 0xA8, 0x38, 0xB8,
+                0xA4, 0x80, 0x14, 0xC8, 0x84, 0xA0, 0x68, 0x68, 0xAC, 0xBC, 0x18, 0x1C, 0x8C, 0xA4, 0xB8, 0x4C,
+                0xD8, 0x28, 0x64, 0xD8, 0x58, 0xDC, 0xB0, 0xA0, 0x9C, 0xD0, 0xC4, 0x44, 0x10, 0x7C, 0x08, 0xB4,
+                0x00, 0x5C, 0x68, 0x94, 0xE4, 0x08, 0xB0, 0x00, 0x5C, 0x20, 0xDC, 0x4C, 0xA0, 0x60, 0x98, 0x70,
+                0xEC, 0x0C, 0xAC, 0xC4, 0x18, 0xA8, 0x8C, 0xB8, 0xF0, 0xC8, 0x38, 0x28, 0x54, 0xD8, 0x44, 0xDC,
+                0x7C, 0xE8, 0x34, 0x30, 0x5C, 0x74, 0xDC, 0x60, 0xA0, 0xF8, 0x98, 0xF4, 0xA4, 0x1C, 0x04, 0xC4,
+                0x80, 0xA8, 0x08, 0xB8, 0xB8, 0x80, 0xD8, 0x80, 0x2C, 0x40, 0xF0, 0x58, 0x60, 0xA0, 0xB0, 0xD0,
+                0x14, 0x0C, 0x74, 0xD4, 0x38, 0xE4, 0x54, 0x70, 0x0C, 0x44, 0xD4, 0x6C, 0xE4, 0x30, 0x70, 0x74,
+                0x0C, 0x28, 0xC4, 0x50, 0xA8, 0x24, 0xF0, 0x20, 0x60, 0x14, 0xB0, 0xCC, 0x5C, 0x88, 0x94, 0xD4,
+                0x08, 0xE4, 0x48, 0x70, 0xC0, 0x0C, 0x7C, 0x8C, 0x7C, 0x00, 0xBC, 0x68, 0xA4, 0xE4, 0x5C, 0xF8,
+                0x64, 0xBC, 0x10, 0xEC, 0x50, 0xBC, 0xE4, 0x54, 0x38, 0x44, 0xEC, 0x34, 0xBC, 0xD4, 0x54, 0x24,
+                0x0C, 0x68, 0xD4, 0xF4, 0xE4, 0xB4, 0x38, 0x74, 0xA4, 0x28, 0x5C, 0x50, 0x2C, 0x24, 0xB8, 0x68,
+                0x80, 0xBC, 0xC8, 0x54, 0xE8, 0x0C, 0x88, 0x9C, 0x8C, 0x04, 0x00, 0x08, 0x68, 0xB8, 0xE4, 0x90,
+                0xB0, 0x84, 0x14, 0x20, 0x74, 0x4C, 0x38, 0x60, 0x1C, 0x70, 0xA4, 0x44, 0x4C, 0x6C, 0x60, 0x30,
+                0x38, 0x3C, 0xEC, 0x80, 0xBC, 0xC8, 0x1C, 0xA0, 0xEC, 0x68, 0xE4, 0xF4, 0xF8, 0xB4, 0xF4, 0x3C,
+                0x0C, 0xC8, 0xC4, 0x60, 0xE0, 0x38, 0x10, 0xA4, 0x18, 0x14, 0x04, 0xCC, 0x08, 0xC0, 0xB8, 0x34,
+                0xD8, 0x9C, 0x64, 0xC4, 0x10, 0x58, 0x50, 0xA0, 0xAC, 0xD0, 0xD8, 0x44, 0xDC, 0x34, 0xA0, 0xD4,
+                0x98, 0x6C, 0xA4, 0x88, 0x4C, 0xC4, 0x28, 0xA8, 0x90, 0xB8, 0x3C, 0x80, 0x90, 0xC8, 0xCC, 0xE8,
+                0x88, 0xC0, 0xD4, 0x24, 0xAC, 0x98, 0x90
+            };
+            static_assert(sizeof(found_payload_sf7) <= whitening_length(7), "The SF 7 sequence should not outrun a 255 byte payload");
+
+            template <uint32_t N, uint32_t... I>
+            constexpr sequence<N> to_sequence(const uint8_t (&words)[N], indices<I...>) {
+                return {{ words[I]... }};
+            }
+
+            constexpr sequence<sizeof(found_payload_sf7)> prng_payload_sf7 = to_sequence(found_payload_sf7, make_indices<sizeof(found_payload_sf7)>::type());
+
+            /**
+             *  Whitening sequences for payload with SF 8 to 10, as found in captures.
+             */
+            constexpr uint8_t found_payload_sf8[] = {
+                0xBD, 0xDF, 0xA4, 0xFB, 0x16, 0x7F, 0x85, 0xFE, 0x40, 0xDF, 0x5B, 0xB0, 0xA2, 0x9E, 0xD0, 0x86,
+                0x26, 0x20, 0x68, 0x4F, 0xF7, 0x2A, 0xB6, 0xD3, 0x5E, 0x46, 0x97, 0x7C, 0x43, 0x7F, 0xE3, 0xB5,
+                0x73, 0x3E, 0x45, 0x83, 0x25, 0xCB, 0x9B, 0xE0, 0xC7, 0x13, 0x10, 0x51, 0x08, 0xAD, 0x02, 0x98,
+                0x40, 0xA7, 0x5B, 0x04, 0xA2, 0x80, 0x9B, 0x01, 0xC7, 0x20, 0x5B, 0x4F, 0xE9, 0x2A, 0x7A, 0x98,
+                0xF4, 0xA7, 0x0E, 0x4F, 0x8F, 0x61, 0x49, 0x79, 0xEA, 0x94, 0x89, 0x1A, 0xC4, 0x07, 0xA8, 0x4A,
+                0x92, 0x8A, 0x76, 0x9D, 0x70, 0x4C, 0xB6, 0xAB, 0x5E, 0xF2, 0x97, 0x62, 0x08, 0xF8, 0x02, 0xB5,
+                0x40, 0x3E, 0x5B, 0x83, 0xE9, 0x80, 0x31, 0x01, 0x5E, 0x20, 0xDC, 0x4F, 0xA2, 0x61, 0x9B, 0x32,
+                0x8C, 0x3E, 0x9A, 0xD8, 0x95, 0x22, 0x4E, 0x9A, 0xA0, 0xAC, 0x23, 0x8E, 0x5D, 0x05, 0x64, 0xCF,
+                0xB9, 0xC1, 0xC4, 0x37, 0x02, 0xDD, 0xCE, 0xE7, 0xE9, 0x58, 0xC9, 0xB1, 0xBF, 0x98, 0x0A, 0xCD,
+                0xC0, 0x8B, 0x7B, 0xDD, 0xB2, 0x0F, 0x54, 0x03, 0x6D, 0x60, 0xE2, 0x4F, 0x6E, 0x2E, 0xB9, 0xC3,
+                0x16, 0x50, 0x76, 0xB6, 0x2F, 0xE6, 0xD7, 0x30, 0x6C, 0x37, 0xC3, 0x62, 0x4A, 0xBB, 0xA1, 0x54,
+                0x5E, 0x4D, 0xFD, 0xC6, 0xA2, 0xEE, 0xD4, 0xB2, 0x24, 0x3E, 0x23, 0xE9, 0x56, 0x3E, 0x8D, 0x53,
+                0x42, 0x06, 0x7B, 0x37, 0xF9, 0x9E, 0xF6, 0x86, 0xBC, 0x20, 0xCF, 0x0E, 0xBC, 0x7D, 0xD7, 0x7B,
+                0x26, 0xDF, 0x61, 0xCB, 0x5D, 0x38, 0xE4, 0x54, 0x39, 0x0E, 0xEF, 0x87, 0xB8, 0xD5, 0x57, 0x67,
+                0x6E, 0xD8, 0x82, 0xEB, 0x4B, 0x3C, 0x7A, 0x56, 0xF4, 0x0D, 0x45, 0x96, 0x31, 0xC6, 0x1B, 0x73,
+                0xC6, 0x95, 0x7B, 0x11, 0xB2, 0xA5, 0x1F, 0x9A, 0xC7, 0xE6, 0x30, 0x4F, 0x47, 0x2A, 0xEB, 0x1A,
+                0x63, 0xA7, 0x65, 0x54, 0x6E, 0xCF, 0x39, 0xE2, 0xDF, 0x5B, 0xB6, 0x51, 0x57, 0xE6, 0xE3, 0xB0,
+                0x38, 0x3E, 0xCF, 0xC2, 0xBC, 0xD7, 0x9C, 0xE2, 0x8C, 0x58, 0xB1, 0xCA, 0x74, 0x3C, 0xB6, 0x9D,
+                0x5E, 0xAE, 0xFC, 0xE5, 0xE9, 0xF8, 0xA9, 0xB5, 0x5B, 0x3E, 0xB7, 0xD9, 0x07, 0x61, 0x28, 0x3A,
+                0x90, 0x7E, 0x76, 0xB3, 0x3F, 0xCB, 0x5F, 0xAB, 0xEE, 0xF3, 0xEB, 0x72, 0xC0, 0xB3, 0x28, 0x5C,
+                0xD9, 0x4D, 0xB6, 0x9D, 0x57, 0x4C, 0xA0, 0x29, 0x92, 0xB9, 0x1D, 0x83, 0x95, 0xD3, 0x8E, 0x2B,
+                0xE9, 0xF3, 0xA2, 0x29, 0x25, 0x15, 0x40, 0xCF, 0x6D, 0xCA, 0x89, 0xD6, 0xD4, 0xA1, 0xC3, 0x51,
+                0x39, 0x4D, 0x85, 0x8D, 0x49, 0x44, 0xE8, 0xE2, 0xBB, 0x1A, 0x84, 0x00, 0x49, 0x98, 0xEC, 0x65,
+                0x72, 0x10, 0x6E, 0x80, 0x40, 0xDD, 0x76, 0x65, 0x3B, 0x51, 0x8E, 0x02, 0xB8, 0x70, 0xD7, 0xE2,
+                0xA7, 0x9A, 0x48, 0xAB, 0xC2, 0x38, 0x7D, 0x5E, 0xBE, 0x06, 0x86, 0x4C, 0x09, 0x72, 0xAF, 0xF4,
+                0x58, 0x9E, 0x3C, 0x80, 0xED, 0xDD, 0xA5, 0x2E, 0x55, 0xF8, 0xBC, 0xD8, 0xED, 0x4D, 0xB9, 0xA0,
+                0x16, 0xFE, 0x5F, 0xF9, 0xDE, 0x79, 0xA7, 0x34, 0xD8, 0x37, 0xF6, 0xB9, 0x77, 0x5A, 0x6B, 0x2E,
+                0x76, 0xF8, 0x36, 0xB5, 0x8B, 0xC3, 0xC2, 0xE2, 0xC1, 0x53, 0x38, 0x0A, 0xFD, 0x2B, 0xF2, 0x83,
+                0xF5, 0x64, 0x25, 0x5E, 0x33, 0x49, 0x50, 0xFB, 0x64, 0xD5, 0xA2, 0x41, 0x21, 0x85, 0x5C, 0x41,
+                0x25, 0x4D, 0x09, 0xE6, 0xE3, 0xA5, 0x79, 0xD9, 0x77, 0x06, 0x6E, 0x4C, 0xC0, 0x77, 0x35, 0xFC,
+                0x11, 0xD5, 0x5D, 0x0A, 0x97, 0x50, 0x05, 0xA9, 0xE9, 0xB3, 0x7B, 0x79, 0x96, 0x15, 0x13, 0x04,
+                0x8F, 0x62, 0x91, 0x5E, 0x74, 0x12, 0x75, 0x9E, 0x3E, 0xAD, 0x4B, 0x97, 0xE3, 0xF0, 0x8A, 0x03,
+                0x41, 0x60, 0xD1, 0xD2, 0x4B, 0xBB, 0xDA, 0x3F, 0x3D
+            };
+            static_assert(sizeof(found_payload_sf8) == whitening_length(8), "The SF 8 sequence should cover a 255 byte payload");
+
+            constexpr uint8_t found_payload_sf9[] = {
+                0xFD, 0xBE, 0x94, 0xEF, 0x1A, 0xF7, 0x07, 0xFD, 0x01, 0xFF, 0x0B, 0x94, 0xBA, 0x1A, 0xDA, 0x07,
+                0x64, 0x01, 0x78, 0x0B, 0xDF, 0xBA, 0xB0, 0xDA, 0x9E, 0x64, 0x86, 0x78, 0x0B, 0xDF, 0xF1, 0xB0,
+                0x3B, 0x9E, 0x57, 0x86, 0x2D, 0x0B, 0xB9, 0xF1, 0x83, 0x3B, 0x80, 0x57, 0x01, 0x2D, 0x40, 0xB9,
+                0x10, 0x83, 0x47, 0x80, 0xA8, 0x03, 0x99, 0x41, 0xA3, 0x12, 0x5F, 0x03, 0x69, 0x08, 0x79, 0x98,
+                0xF4, 0xA7, 0x0E, 0x5F, 0xCF, 0x6D, 0xE9, 0x79, 0xAB, 0xF6, 0xB9, 0x2E, 0xD8, 0xCF, 0x2E, 0x41,
+                0xD1, 0x2B, 0x26, 0xB9, 0x68, 0xB8, 0xB8, 0x22, 0x1C, 0xD1, 0x07, 0x27, 0x60, 0x48, 0x14, 0xB8,
+                0x88, 0x9C, 0x48, 0x86, 0xA1, 0x60, 0x03, 0x04, 0x16, 0x94, 0x4E, 0x42, 0xA9, 0xA1, 0xF9, 0x03,
+                0xC8, 0x16, 0x3E, 0x46, 0x98, 0xAB, 0x8E, 0xF9, 0xF1, 0xE8, 0x3B, 0x32, 0x57, 0x9E, 0xE7, 0x8C,
+                0x18, 0xF1, 0x80, 0x3F, 0x9E, 0x5F, 0xCD, 0xE7, 0xE8, 0x58, 0xE9, 0xB1, 0x9F, 0x92, 0x82, 0xCF,
+                0x00, 0xEA, 0x2B, 0x88, 0xBE, 0xAF, 0x56, 0x82, 0x2E, 0x08, 0x92, 0x6B, 0x17, 0xAE, 0x3B, 0x4A,
+                0xD7, 0x2A, 0x66, 0x92, 0x13, 0x76, 0x21, 0x3B, 0xA5, 0xD3, 0xD3, 0x65, 0x26, 0x13, 0x02, 0x41,
+                0x52, 0xAD, 0x46, 0xD3, 0xA8, 0x26, 0xB2, 0x23, 0x52, 0x12, 0xB3, 0xCE, 0x97, 0xA9, 0xC6, 0x33,
+                0x30, 0x72, 0x27, 0xBF, 0x7B, 0x1D, 0x7B, 0xC7, 0x9D, 0x30, 0xEB, 0x27, 0x38, 0x73, 0xD6, 0x79,
+                0x2F, 0x9F, 0x03, 0xEB, 0x39, 0x2C, 0xE8, 0xD6, 0x7B, 0x27, 0x9D, 0x43, 0x80, 0x59, 0xC9, 0xEC,
+                0xAE, 0x79, 0x93, 0x9F, 0x16, 0x80, 0x74, 0xC9, 0x3E, 0xAE, 0x56, 0x93, 0x4D, 0x57, 0xCD, 0x64,
+                0x2B, 0x3E, 0xC8, 0x56, 0xEA, 0x6D, 0xA8, 0x8D, 0x9B, 0x0F, 0x86, 0xC8, 0x02, 0xE8, 0x80, 0xE9,
+                0x27, 0xBB, 0xDD, 0x86, 0xE5, 0x4A, 0x79, 0x80, 0x2E, 0x07, 0x9B, 0xD9, 0x89, 0xED, 0xE2, 0x73,
+                0x18, 0x2E, 0xE9, 0xEB, 0x38, 0xD9, 0x95, 0xE0, 0x8D, 0x98, 0xD1, 0x8A, 0x74, 0x2C, 0x32, 0x1D,
+                0x17, 0x8E, 0x2D, 0x91, 0xF5, 0x44, 0xBF, 0x36, 0x1D, 0x15, 0xC7, 0x2D, 0x7B, 0xB5, 0x96, 0xBB,
+                0x50, 0x1D, 0x6B, 0xC5, 0x53, 0x3B, 0x41, 0xB6, 0x85, 0x54, 0x1A, 0x6D, 0x8D, 0x53, 0xDB, 0x41,
+                0x85, 0xA5, 0x29, 0x9A, 0xCA, 0x8E, 0x8A, 0xFA, 0xD6, 0x91, 0xB8, 0xA5, 0x98, 0xC1, 0x8C, 0xCA,
+                0xDA, 0xE6, 0xAA, 0xA1, 0x27, 0x18, 0xC8, 0x8D, 0x05, 0xFB, 0x8D, 0xCA, 0x40, 0xA7, 0x40, 0x51,
+                0x29, 0x4D, 0xC5, 0xBD, 0x7D, 0x1C, 0xE0, 0x60, 0xFB, 0x31, 0x94, 0x44, 0x71, 0x7D, 0xFE, 0xE8,
+                0xB0, 0x7A, 0x55, 0xD7, 0xBC, 0x21, 0xFD, 0xDA, 0xF6, 0xB8, 0xFC, 0xDF, 0xD4, 0x9C, 0x21, 0xFC,
+                0xF2, 0x76, 0xF9, 0xFC, 0xBE, 0x17, 0xAF, 0x41, 0xE3, 0xCA, 0xBE, 0x6F, 0x5F, 0xBF, 0x0C, 0x87,
+                0x2D, 0xC3, 0x48, 0x36, 0x74, 0x57, 0x73, 0x4D, 0x43, 0xAD, 0xD0, 0x18, 0xE3, 0xE0, 0xB0, 0x72,
+                0x35, 0x6F, 0x49, 0xF4, 0x52, 0x6B, 0xAC, 0xB4, 0xD8, 0x35, 0xF6, 0x59, 0x77, 0x5E, 0x7B, 0xAE,
+                0xBC, 0xDA, 0x3E, 0xF7, 0x32, 0x53, 0x84, 0xEB, 0x23, 0x30, 0x18, 0x7E, 0xB1, 0x52, 0x64, 0xB4,
+                0xBE, 0x05, 0x56, 0x0A, 0x0C, 0x91, 0x76, 0x50, 0xB1, 0x3E, 0x59, 0x57, 0x6E, 0x0D, 0xA3, 0xB6,
+                0x7E, 0x89, 0x76, 0x4B, 0x7D, 0x6E, 0xDE, 0x82, 0x90, 0x5E, 0xCA, 0x72, 0x4D, 0x71, 0xE9, 0xDC,
+                0x82, 0xD0, 0x15, 0x9A, 0x83, 0x4D, 0x09, 0xEB, 0x20, 0x82, 0x6F, 0x74, 0x1E, 0x93, 0x18, 0x8D,
+                0x0B, 0x20, 0xB1, 0x2E, 0x60, 0x1E, 0xF1, 0x10, 0xFD, 0x0F, 0x5E, 0xB7, 0x9B, 0x40, 0x94, 0x0A,
+                0x89, 0x02, 0xA0, 0xB7, 0x66, 0x43, 0x77, 0xB6, 0xC7, 0x3E, 0x3F, 0xDF
+            };
+            static_assert(sizeof(found_payload_sf9) == whitening_length(9), "The SF 9 sequence should cover a 255 byte payload");
+
+            constexpr uint8_t found_payload_sf10[] = {
+                0xFD, 0xFE, 0xF4, 0xDF, 0x0E, 0xFB, 0x8F, 0x7F, 0x02, 0xFE, 0x4B, 0xB4, 0xEA, 0x3E, 0xC2, 0x83,
+                0x6A, 0x88, 0xFA, 0x48, 0xFE, 0xAA, 0xF4, 0xF2, 0x4E, 0x62, 0xAB, 0xF8, 0xD1, 0xFC, 0xE0, 0xB4,
+                0x73, 0x7E, 0x65, 0x83, 0x21, 0xCB, 0x93, 0x72, 0x87, 0x32, 0x40, 0x75, 0x50, 0x29, 0x2C, 0x19,
+                0x9A, 0x84, 0x4A, 0x00, 0xEA, 0x30, 0xA9, 0x04, 0x8B, 0x88, 0x49, 0x0A, 0xE2, 0x2A, 0x38, 0xB9,
+                0xA4, 0xA3, 0x16, 0xDF, 0xCD, 0x60, 0x4B, 0x7B, 0xEA, 0x94, 0x89, 0x1A, 0xD0, 0x47, 0x28, 0x60,
+                0xD3, 0xAA, 0x26, 0xB9, 0x68, 0xB8, 0xB8, 0x22, 0x1C, 0xD1, 0x06, 0x65, 0x40, 0x18, 0x30, 0xA0,
+                0x3C, 0x92, 0xC9, 0x4C, 0xE2, 0x01, 0x73, 0x64, 0x2E, 0x34, 0xD0, 0x83, 0x20, 0xE2, 0x18, 0x32,
+                0x8E, 0x7C, 0x9A, 0xF8, 0xD5, 0x32, 0x46, 0x1E, 0xE0, 0xCD, 0x73, 0xCA, 0x25, 0x8D, 0x7A, 0x64,
+                0xFE, 0x6A, 0xB5, 0x33, 0x5D, 0x35, 0xBD, 0x72, 0x96, 0xF0, 0x1B, 0xBF, 0x02, 0x1C, 0x40, 0xAD,
+                0x30, 0x9E, 0x47, 0x55, 0x30, 0x04, 0xD3, 0x02, 0x6D, 0x62, 0xE2, 0x3F, 0x6A, 0x26, 0xB1, 0x41,
+                0x54, 0x2C, 0x2E, 0xB2, 0x03, 0x52, 0x01, 0xAF, 0xAB, 0xD4, 0xD0, 0xE7, 0x26, 0x13, 0x62, 0x41,
+                0x06, 0xA5, 0x62, 0x53, 0xBB, 0xED, 0x92, 0x13, 0x17, 0x3A, 0x1B, 0x50, 0x94, 0x29, 0x0D, 0xD2,
+                0x42, 0x06, 0x3B, 0x17, 0xC9, 0xDA, 0xEA, 0x0E, 0x7E, 0x03, 0xBE, 0x2B, 0xE4, 0xA5, 0x69, 0xF4,
+                0xE8, 0x76, 0xB3, 0xFD, 0x14, 0x94, 0x36, 0x41, 0x64, 0xCA, 0xF1, 0x28, 0xB6, 0xD6, 0x15, 0x46,
+                0x1F, 0x5C, 0x9A, 0x63, 0xCC, 0x3F, 0xFA, 0x54, 0xF4, 0x0D, 0x05, 0xF6, 0x21, 0xE2, 0x93, 0xE9,
+                0x05, 0xB3, 0x0A, 0x55, 0xFA, 0x29, 0x81, 0x1D, 0x9D, 0x0A, 0x82, 0x4A, 0x48, 0x8B, 0x31, 0xFD,
+                0x2B, 0x23, 0x5F, 0x9D, 0x64, 0x48, 0x73, 0xC9, 0x4E, 0x57, 0xBF, 0xD1, 0x51, 0xE7, 0x67, 0x30,
+                0x39, 0x3E, 0xAF, 0xE3, 0xAC, 0xEF, 0x10, 0x70, 0x4E, 0x73, 0xA0, 0xDE, 0x28, 0x90, 0xAC, 0xBA,
+                0x00, 0x4D, 0x86, 0x62, 0xA1, 0x58, 0x63, 0xD1, 0x26, 0x8A, 0x89, 0x45, 0xC9, 0xE2, 0xEA, 0x13,
+                0x82, 0x7A, 0x5E, 0x03, 0x3D, 0xDA, 0xDF, 0xA9, 0x6C, 0xF3, 0xC9, 0x12, 0xF0, 0x8F, 0xA0, 0x56,
+                0x1F, 0x27, 0xC7, 0xF8, 0x3B, 0xE8, 0xD6, 0x3E, 0xD4, 0x82, 0x2F, 0x85, 0x59, 0x29, 0x9D, 0xCE,
+                0x96, 0x4E, 0x4C, 0xA4, 0x0F, 0x9B, 0x12, 0xEC, 0x1D, 0xCE, 0xA1, 0x4E, 0x42, 0xAA, 0xEB, 0x50,
+                0x29, 0x8D, 0xC5, 0xFD, 0x5D, 0x04, 0xEC, 0x46, 0x7A, 0x63, 0xF5, 0x94, 0x05, 0x21, 0x5E, 0x8E,
+                0xB9, 0xE1, 0x9D, 0xB3, 0x8F, 0x35, 0xB1, 0x32, 0x64, 0x97, 0xE1, 0x17, 0x35, 0xCF, 0x1C, 0x82,
+                0x16, 0x1C, 0x54, 0x7B, 0xED, 0xB3, 0xFE, 0xDD, 0xBF, 0x06, 0xC4, 0x0C, 0x29, 0x46, 0xA7, 0x70,
+                0x08, 0xF5, 0x0C, 0xD5, 0xD1, 0x61, 0x4F, 0x93, 0x80, 0x12, 0x4F, 0xC3, 0x20, 0x80, 0x43, 0x67,
+                0x49, 0xC2, 0xAB, 0x6F, 0x5D, 0xF3, 0xEF, 0x51, 0xE8, 0x81, 0xFB, 0xB5, 0xC9, 0x51, 0x72, 0x2E,
+                0x7E, 0xF8, 0x2E, 0xF7, 0xAB, 0xD7, 0x86, 0x6A, 0xA3, 0xB1, 0x09, 0x7E, 0x91, 0x52, 0x04, 0x98,
+                0x2A, 0x8B, 0xD4, 0x48, 0x64, 0x00, 0xE2, 0x4C, 0x41, 0x28, 0x7C, 0xDA, 0xAC, 0x26, 0x93, 0xB3,
+                0x34, 0x49, 0x14, 0x52, 0x69, 0x0A, 0x76, 0xD0, 0x75, 0x0E, 0x0C, 0x2C, 0xC4, 0x2B, 0x04, 0xF0,
+                0x42, 0x36, 0x6C, 0x3C, 0x89, 0x89, 0xAB, 0x3A, 0x8E, 0xDD, 0xCA, 0xA7, 0xEB, 0xBE, 0xA9, 0xD3,
+                0xE4, 0x94, 0xE7, 0xE0, 0xF9, 0xB8, 0x3E, 0xF9, 0xE7, 0xAC, 0xD3, 0x09, 0x79, 0x61, 0x80, 0x82,
+                0x41, 0x31, 0x48, 0xA0, 0x50, 0x96, 0x02, 0x26, 0x64, 0x85, 0x16
+            };
+            static_assert(sizeof(found_payload_sf10) == whitening_length(10), "The SF 10 sequence should cover a 255 byte payload");
+
+            constexpr sequence<whitening_length(8)>  prng_payload_sf8  = to_sequence(found_payload_sf8,  make_indices<whitening_length(8)>::type());
+            constexpr sequence<whitening_length(9)>  prng_payload_sf9  = to_sequence(found_payload_sf9,  make_indices<whitening_length(9)>::type());
+            constexpr sequence<whitening_length(10)> prng_payload_sf10 = to_sequence(found_payload_sf10, make_indices<whitening_length(10)>::type());
+
+            /**
+             *  Whitening sequence for payload with SF 11, as found in captures (`examples/lora-whitening`).
+             *  <BR>At SF 11 and 12 the payload is sent with the low data rate optimization (2 bits less per symbol), which
+             *  this decoder does not undo: the sequence is that of the words as it reads them.
+             */
+            constexpr uint8_t found_payload_sf11[] = {
+                0xFD, 0xFE, 0xB4, 0xBF, 0x3E, 0x8F, 0xA3, 0xD3, 0xD0, 0x75, 0x04, 0xFE, 0xC1, 0xB5, 0xEA, 0x3E,
+                0xC2, 0xC3, 0x4A, 0x80, 0x6E, 0x2C, 0x7A, 0x59, 0xFE, 0x6A, 0x94, 0x82, 0x2A, 0x7A, 0x47, 0x62,
+                0x84, 0xF8, 0x42, 0xFD, 0xA0, 0x94, 0x43, 0x4A, 0x39, 0x27, 0xD3, 0x06, 0x2D, 0x43, 0x9A, 0x21,
+                0xE7, 0x61, 0x54, 0x3D, 0xBC, 0xD3, 0x03, 0x2D, 0x09, 0x98, 0xC0, 0xE7, 0x7B, 0x74, 0xF6, 0x98,
+                0xAB, 0x0B, 0x99, 0x80, 0x87, 0x47, 0x6B, 0x3B, 0xD5, 0x86, 0xEC, 0x87, 0xFB, 0x03, 0xB7, 0x86,
+                0x5E, 0x6B, 0xB7, 0xD5, 0x57, 0xE8, 0xEC, 0x7B, 0x31, 0xB6, 0x98, 0x5E, 0xEC, 0xB7, 0xBE, 0x07,
+                0x3A, 0xEC, 0xD3, 0xAB, 0xEE, 0x9A, 0x38, 0xE4, 0xE4, 0xFE, 0x76, 0x0A, 0x99, 0x43, 0x05, 0x64,
+                0x01, 0x38, 0x63, 0xE4, 0x14, 0x06, 0x9B, 0x99, 0x4A, 0x4F, 0xE1, 0x00, 0x73, 0x22, 0x0E, 0x44,
+                0xA0, 0x97, 0x44, 0xC4, 0xAA, 0x61, 0x99, 0x72, 0xAC, 0x4E, 0xCE, 0xE0, 0x35, 0x4C, 0x9D, 0xA0,
+                0x4E, 0x98, 0xA1, 0xAD, 0x43, 0xCE, 0x59, 0x25, 0x54, 0x05, 0xE4, 0xCF, 0x78, 0xA1, 0x94, 0x43,
+                0x0A, 0x19, 0x10, 0x40, 0x85, 0x66, 0xAA, 0xFB, 0xD8, 0x85, 0xD7, 0x6A, 0x28, 0x04, 0x06, 0x45,
+                0xC6, 0x28, 0x60, 0xD9, 0x8A, 0xD7, 0xC7, 0x38, 0xE1, 0x56, 0xA1, 0x82, 0xD0, 0xC8, 0x2E, 0x8A,
+                0x03, 0xE6, 0x49, 0xE5, 0x58, 0x31, 0xEC, 0x51, 0x32, 0x25, 0x35, 0x03, 0x29, 0x19, 0x12, 0xD0,
+                0x0B, 0xEF, 0xE1, 0x30, 0x72, 0x75, 0x2E, 0x39, 0xA4, 0x3A, 0xF8, 0x9B, 0x2B, 0xEC, 0xD5, 0x72,
+                0x46, 0x2E, 0x17, 0xB5, 0x8A, 0xD8, 0xD6, 0x25, 0x05, 0xD3, 0x42, 0x46, 0x3B, 0x16, 0xFD, 0xCE,
+                0xFE, 0x16, 0xF7, 0x04, 0xFC, 0x40, 0xDF, 0x3B, 0x90, 0xFD, 0xCD, 0xF6, 0x5B, 0xFB, 0x6C, 0xFE,
+                0xF0, 0xDE, 0x65, 0xB0, 0x7E, 0xCD, 0xEA, 0xDF, 0xE7, 0xE5, 0xFE, 0x71, 0xD4, 0x65, 0x51, 0x2E,
+                0xCD, 0xFA, 0x87, 0xFD, 0x58, 0xFC, 0x27, 0xD4, 0x68, 0x51, 0x8C, 0xED, 0xAB, 0xA7, 0xD1, 0x50,
+                0x2E, 0x2F, 0xF9, 0x48, 0xC3, 0x9A, 0xB3, 0x23, 0xC5, 0xDE, 0x28, 0x2C, 0xD8, 0xA8, 0xD7, 0xC5,
+                0x68, 0x93, 0x0D, 0x41, 0xCA, 0xA1, 0x40, 0xD9, 0x13, 0x97, 0x41, 0x28, 0xC2, 0x55, 0x6C, 0xEC,
+                0x38, 0xE2, 0xDF, 0x13, 0xD6, 0x61, 0x73, 0xE2, 0x4F, 0x6C, 0x6C, 0xB0, 0x6B, 0x5D, 0x1F, 0x95,
+                0xA0, 0x43, 0xC6, 0x5B, 0x09, 0x60, 0x4F, 0x72, 0xA0, 0x9E, 0x48, 0xE0, 0xE8, 0xE6, 0x04, 0x15,
+                0x82, 0x4C, 0x47, 0xA0, 0x82, 0x08, 0x07, 0x98, 0x96, 0x3C, 0x2C, 0x9A, 0x0E, 0x4D, 0x4A, 0x8A,
+                0x9A, 0x27, 0xEA, 0xEE, 0xE8, 0x1A, 0xF5, 0x05, 0xB1, 0x0B, 0x74, 0xBA, 0x39, 0xEE, 0x79, 0xEC,
+                0x8F, 0x67, 0x48, 0x38, 0xEB, 0x75, 0xE8, 0x79, 0x9F, 0x09, 0x99, 0x1F, 0xCD, 0x06, 0x29, 0xE9,
+                0xF2, 0xE9, 0x79, 0x9F, 0x0D, 0x9D, 0x9B, 0x4B, 0x05, 0xAC, 0xEB, 0x71, 0xA2, 0x19, 0x25, 0x1D,
+                0x98, 0x97, 0x4F, 0x07, 0x2E, 0xEB, 0xF8, 0xA2, 0x9A, 0x05, 0x6D, 0xB0, 0xE7, 0x5F, 0xFB, 0xAE,
+                0xF5, 0xF9, 0x65, 0xF8, 0x3E, 0x39, 0xFE, 0x4B, 0x71, 0xE0, 0xB6, 0xF1, 0x75, 0x65, 0x12, 0x1E,
+                0xDB, 0xB6, 0xB3, 0xE3, 0x9C, 0xB2, 0x0F, 0x75, 0xD0, 0x22, 0x10, 0xD7, 0x2D, 0x8D, 0x76, 0x91,
+                0x37, 0x8F, 0x35, 0xD1, 0x22, 0x00, 0xC4, 0x25, 0x5C, 0xFE, 0xF0, 0x36, 0xBC, 0x35, 0x8E, 0x42,
+                0xE8, 0xA4, 0x03, 0xFC, 0xD2, 0x7D, 0xA6, 0xBC, 0xBA, 0xCF, 0xC8, 0xB8, 0x15, 0x23, 0x54, 0x58,
+                0xB3, 0x2F, 0x5F, 0xB2, 0x9C, 0xA8, 0x89, 0x65, 0x39, 0x54, 0x38, 0xB3, 0xD7, 0x5B, 0x8C, 0xDC,
+                0xA6, 0x99, 0xB1, 0x79, 0x18, 0x38, 0x10, 0x57, 0xC0
+            };
+            static_assert(sizeof(found_payload_sf11) == whitening_length(11), "The SF 11 sequence should cover a 255 byte payload");
+
+            constexpr sequence<whitening_length(11)> prng_payload_sf11 = to_sequence(found_payload_sf11, make_indices<whitening_length(11)>::type());
+
+            /**
+             *  Whitening sequence for payload with SF 12, as found in captures.
+             */
+            constexpr uint8_t found_payload_sf12[] = {
+                0xFD, 0x7C, 0xB4, 0xFF, 0x5F, 0x9F, 0xD7, 0xAB, 0x28, 0x73, 0x91, 0xFF, 0xC5, 0xB5, 0xAB, 0x1C,
+                0x92, 0xE7, 0x76, 0x74, 0x54, 0x9F, 0xFD, 0xC3, 0x7F, 0xA9, 0xB5, 0xD2, 0x5E, 0x46, 0xB7, 0x5C,
+                0x47, 0x7F, 0xFB, 0xFF, 0xEF, 0x35, 0x33, 0x1D, 0x15, 0xE7, 0x3D, 0x5F, 0x85, 0x5D, 0x91, 0xEA,
+                0x87, 0xB7, 0x02, 0x55, 0x41, 0x4D, 0x30, 0xED, 0x18, 0x17, 0x11, 0x8D, 0x4C, 0x02, 0xAB, 0xA0,
+                0xD9, 0x24, 0xD7, 0x24, 0x03, 0x97, 0x43, 0x01, 0x62, 0x8A, 0x7B, 0x99, 0xF4, 0xA6, 0x4E, 0x6F,
+                0xBB, 0x55, 0x49, 0xED, 0xEA, 0x73, 0xBB, 0x36, 0xD9, 0x3E, 0x9C, 0xE3, 0xB2, 0x97, 0x24, 0xE1,
+                0x51, 0x38, 0x6F, 0x9E, 0x38, 0xEC, 0x64, 0xBE, 0x54, 0x1A, 0x99, 0x4B, 0x05, 0x60, 0x01, 0x79,
+                0x48, 0xD4, 0xF0, 0x5A, 0x37, 0x2F, 0xD7, 0x4F, 0x6F, 0x02, 0x30, 0x01, 0x5E, 0x60, 0xBC, 0x5F,
+                0xF7, 0x1D, 0xBF, 0x4E, 0x13, 0xB0, 0xCD, 0x1E, 0xE8, 0xED, 0xE9, 0x9E, 0xA4, 0x39, 0x6B, 0x55,
+                0x72, 0x4F, 0x38, 0xAA, 0x15, 0x39, 0x16, 0xE8, 0x40, 0x11, 0x7E, 0xD8, 0x3E, 0x34, 0x1F, 0x57,
+                0x8D, 0x06, 0xCA, 0x0C, 0x81, 0x55, 0x49, 0xA1, 0x8C, 0x0C, 0x03, 0xCF, 0xC0, 0x88, 0x5B, 0xAD,
+                0x92, 0x33, 0x2C, 0x01, 0x5C, 0x92, 0xAE, 0x01, 0x93, 0x2B, 0x16, 0x9E, 0x1F, 0x0A, 0xAF, 0xF6,
+                0x1D, 0xAB, 0x64, 0xD1, 0x73, 0x44, 0x25, 0x35, 0x05, 0x09, 0xB8, 0x43, 0x9B, 0xE6, 0x61, 0x30,
+                0x70, 0x75, 0x2E, 0x19, 0xC4, 0x4E, 0xD8, 0xDF, 0x25, 0xEE, 0x52, 0x30, 0x26, 0x76, 0x63, 0xD8,
+                0xF6, 0x5A, 0xC5, 0xBB, 0x26, 0x54, 0x02, 0x65, 0x0B, 0x13, 0x90, 0x2A, 0x10, 0x23, 0x41, 0x01,
+                0xF6, 0x13, 0xFC, 0xC8, 0xF4, 0x83, 0x45, 0x2C, 0x2A, 0x53, 0x05, 0xFC, 0xA4, 0x7F, 0xDF, 0xB5,
+                0x27, 0x35, 0x08, 0x42, 0xA3, 0x87, 0x46, 0xB4, 0xAA, 0xDD, 0xD7, 0x67, 0x6E, 0x18, 0x82, 0xCB,
+                0x1A, 0x18, 0xFE, 0x82, 0x75, 0xDD, 0xB6, 0xAE, 0x14, 0xF0, 0x3D, 0x52, 0xE5, 0xC8, 0xE1, 0x7F,
+                0x99, 0x34, 0xC9, 0x5C, 0xEB, 0x4D, 0xA9, 0x9D, 0xDF, 0x7F, 0xB6, 0x12, 0x0F, 0xCA, 0x41, 0xA9,
+                0x20, 0xFB, 0x23, 0x93, 0x7D, 0xA8, 0xEC, 0xC6, 0x69, 0xC3, 0xB1, 0xF0, 0x5F, 0xD3, 0xB7, 0x01,
+                0x43, 0xF6, 0x13, 0xF0, 0xCA, 0xB3, 0x7A, 0x17, 0xB8, 0xA7, 0xC4, 0x0F, 0x72, 0x25, 0x26, 0x65,
+                0xC4, 0xF5, 0x73, 0xFE, 0x3B, 0x95, 0xC4, 0x4A, 0x62, 0x50, 0x3E, 0x44, 0xC6, 0xEF, 0xE2, 0xFB,
+                0x63, 0x15, 0x0E, 0x0A, 0xDB, 0x64, 0x39, 0x40, 0x07, 0x6A, 0x08, 0x32, 0x81, 0x7E, 0x36, 0x93,
+                0x3F, 0xDF, 0xCF, 0x47, 0x5B, 0x38, 0xA7, 0x52, 0xDA, 0x44, 0xBC, 0x57, 0xC6, 0x9D, 0x87, 0x42,
+                0x51, 0xA6, 0xA0, 0x18, 0x02, 0x6C, 0xFA, 0xDE, 0x8E, 0x5D, 0xEB, 0x9E, 0x39, 0x00, 0x1A, 0x42,
+                0x8F, 0xCB, 0xF8, 0x96, 0xDE, 0xB5, 0x13, 0x20, 0x80, 0x13, 0xC0, 0x4D, 0x68, 0x8B, 0x8B, 0xE6,
+                0xC0, 0xA5, 0x7F, 0x2D, 0x40, 0x59, 0xEA, 0x2C, 0xF1, 0xB8, 0x0D, 0xE8, 0x0A, 0x75, 0x1A, 0x59,
+                0xF4, 0x73, 0x35, 0xB7, 0x14, 0x35, 0x17, 0x20, 0x1B, 0xB0, 0x24, 0x41, 0xD2, 0xAF, 0xC7, 0xD6,
+                0xA0, 0x06, 0x08, 0x17, 0x96, 0xCA, 0x9A, 0x93, 0x21, 0xE7, 0x50, 0xE3, 0xA6, 0x58, 0x68, 0x9B,
+                0xC6, 0x4C, 0x89, 0xAE, 0x55, 0x4A, 0x76, 0x67, 0xF7, 0x58, 0x65, 0xBB, 0x37, 0x2F, 0xBB, 0xC2,
+                0x47, 0x71, 0x4F, 0xBE, 0x20, 0x75, 0x62, 0x39, 0x5E, 0x5D, 0xBA, 0xB5, 0x52, 0x03, 0x60, 0xE2,
+                0xF2, 0x93, 0x04, 0x6A, 0x21, 0x44, 0x48, 0x50, 0x5C, 0xEF, 0x2E, 0x38, 0xDA, 0x37, 0x96, 0x09,
+                0x33, 0x56, 0x6F, 0x68, 0x66, 0x24, 0xB2, 0x99, 0x5F
+            };
+            static_assert(sizeof(found_payload_sf12) == whitening_length(12), "The SF 12 sequence should cover a 255 byte payload");
+
+            constexpr sequence<whitening_length(12)> prng_payload_sf12 = to_sequence(found_payload_sf12, make_indices<whitening_length(12)>::type());
+
+            constexpr sequence<5> prng_header_shuffled = shuffle_sequence(prng_header, make_indices<5>::type());
+            constexpr sequence<sizeof(found_payload_sf7)> prng_payload_sf7_shuffled = shuffle_sequence(prng_payload_sf7, make_indices<sizeof(found_payload_sf7)>::type());
+            constexpr sequence<whitening_length(8)>  prng_payload_sf8_shuffled  = shuffle_sequence(prng_payload_sf8,  make_indices<whitening_length(8)>::type());
+            constexpr sequence<whitening_length(9)>  prng_payload_sf9_shuffled  = shuffle_sequence(prng_payload_sf9,  make_indices<whitening_length(9)>::type());
+            constexpr sequence<whitening_length(10)> prng_payload_sf10_shuffled = shuffle_sequence(prng_payload_sf10, make_indices<whitening_length(10)>::type());
+            constexpr sequence<whitening_length(11)> prng_payload_sf11_shuffled = shuffle_sequence(prng_payload_sf11, make_indices<whitening_length(11)>::type());
+            constexpr sequence<whitening_length(12)> prng_payload_sf12_shuffled = shuffle_sequence(prng_payload_sf12, make_indices<whitening_length(12)>::type());
+        }
+
+        const uint8_t *header_whitening_sequence(const bool shuffled) {
+            return shuffled ? prng_header_shuffled.words : prng_header.words;
+        }
+
+        const uint8_t *payload_whitening_sequence(const uint8_t sf, uint32_t *len, const bool shuffled) {
+            const uint8_t *sequence;
+            uint32_t       length;
+
+            switch (sf) {
+                case  6: sequence = shuffled ? prng_payload_sf12_shuffled.words : prng_payload_sf12.words; length = sizeof(prng_payload_sf12); break;
+                case  8: sequence = shuffled ? prng_payload_sf8_shuffled.words  : prng_payload_sf8.words;  length = sizeof(prng_payload_sf8);  break;
+                case  9: sequence = shuffled ? prng_payload_sf9_shuffled.words  : prng_payload_sf9.words;  length = sizeof(prng_payload_sf9);  break;
+                case 10: sequence = shuffled ? prng_payload_sf10_shuffled.words : prng_payload_sf10.words; length = sizeof(prng_payload_sf10); break;
+                case 11: sequence = shuffled ? prng_payload_sf11_shuffled.words : prng_payload_sf11.words; length = sizeof(prng_payload_sf11); break;
+                case 12: sequence = shuffled ? prng_payload_sf12_shuffled.words : prng_payload_sf12.words; length = sizeof(prng_payload_sf12); break;
+                default: sequence = shuffled ? prng_payload_sf7_shuffled.words  : prng_payload_sf7.words;  length = sizeof(prng_payload_sf7);  break;
+            }
+
+            if (len)
+                *len = length;
+
+            return sequence;
+        }
+
+        const uint8_t hamming_decode_lut[256] = {
+            0x00, 0x00, 0x00, 0x03, 0x00, 0x05, 0x06, 0x07, 0x00, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x07, 0x04, 0x07, 0x07, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x07,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x0E, 0x07, 0x08, 0x09, 0x0E, 0x0B, 0x0E, 0x0D, 0x0E, 0x0E,
+            0x00, 0x09, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x09, 0x09, 0x0A, 0x09, 0x0C, 0x09, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x0B, 0x04, 0x05, 0x06, 0x07, 0x08, 0x0B, 0x0B, 0x0B, 0x0C, 0x0D, 0x0E, 0x0B,
+            0x00, 0x01, 0x02, 0x03, 0x0C, 0x05, 0x06, 0x07, 0x0C, 0x09, 0x0A, 0x0B, 0x0C, 0x0C, 0x0C, 0x0F,
+            0x00, 0x05, 0x02, 0x03, 0x05, 0x05, 0x06, 0x05, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x05, 0x0E, 0x0F,
+            0x02, 0x01, 0x02, 0x02, 0x04, 0x05, 0x02, 0x07, 0x08, 0x09, 0x02, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x0D, 0x06, 0x07, 0x08, 0x0D, 0x0A, 0x0B, 0x0D, 0x0D, 0x0E, 0x0D,
+            0x00, 0x01, 0x0A, 0x03, 0x04, 0x05, 0x06, 0x07, 0x0A, 0x09, 0x0A, 0x0A, 0x0C, 0x0D, 0x0A, 0x0F,
+            0x00, 0x03, 0x03, 0x03, 0x04, 0x05, 0x06, 0x03, 0x08, 0x09, 0x0A, 0x03, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x04, 0x01, 0x02, 0x03, 0x04, 0x04, 0x04, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x04, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x06, 0x03, 0x06, 0x05, 0x06, 0x06, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x06, 0x0F,
+            0x01, 0x01, 0x02, 0x01, 0x04, 0x01, 0x06, 0x07, 0x08, 0x01, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x08, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x08, 0x08, 0x0B, 0x08, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x0F, 0x08, 0x09, 0x0A, 0x0F, 0x0C, 0x0F, 0x0F, 0x0F
+        };
+
+        const uint8_t fec_data_lut[256] = {
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+        };
+
+    } /* namespace lora */
+} /* namespace gr */
@@ -21,108 +21,50 @@
 #ifndef TABLES_H
 #define TABLES_H
 
+#include <cstdint>
+
 /**
- *  This file contians the found whitening sequences to be XORed with a word.
+ *  This file declares the whitening sequences to be XORed with a word,
+ *  and the lookup tables of the bit pipeline in `frame_decoder::decode_codewords`. They are defined once, in `tables.cc`.
  */
 namespace gr {
     namespace lora {
 
         /**
-         *  HDR whitening sequence.
+         *  \brief  Return the HDR whitening sequence (5 words).
+         *
+         *  \param  shuffled
+         *          Return it shuffled like the codewords, see `payload_whitening_sequence`.
          */
-        const uint8_t prng_header[] = {
-            0x22, 0x11, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-        };
+        const uint8_t *header_whitening_sequence(const bool shuffled = false);
 
         /**
-         *  Whitening sequence for payload with SF 7.
+         *  \brief  Return the whitening sequence of the payload for the given SF, as found in captures (see `tables.cc`).
+         *          <BR>It covers a payload of 255 bytes, except at SF 7 where the capture is shorter: a frame that
+         *          needs more words than `len` cannot be (de)whitened.
+         *
+         *  \param  sf
+         *          The spreading factor. SF 6 uses the sequence of SF 12, which gives a better accuracy.
+         *  \param  len
+         *          Set to the length of the sequence, if given.
+         *  \param  shuffled
+         *          Return it shuffled like the codewords, to XOR with the deinterleaved words before
+         *          `frame_decoder::deshuffle` (as `frame_decoder::decode_codewords` does), instead of with the
+         *          deshuffled ones (as `frame_decoder::dewhiten` does).
          */
-        const uint8_t prng_payload_sf7[] = { // OK
-            0xdc, 0xec, 0xb0, 0xf4, 0x9c, 0xfc, 0xc4, 0xdc, 0x10, 0xf8, 0x40, 0x34, 0xa8, 0x5c, 0xf0, 0x94, 0x60, 0x08, 0xf8, 0x48, 0xbc, 0x88, 0xa4, 0xd4, 0x14, 0xe4, 0x84, 0x38, 0x68, 0xec, 0xe4, 0xbc, 0xb0, 0x1c, 0x14, 0xa4, 0x3c, 0x4c, 0x90, 0x60, 0x84, 0x70, 0x20, 0x44, 0x04, 0x24, 0x80, 0x98, 0x40, 0xa4, 0x58, 0x04, 0xa0, 0x80, 0x98, 0x40, 0xa4, 0x10, 0x4c, 0x40, 0x60, 0xa8, 0x38, 0xb8, 0xa4, 0x80, 0x14, 0xc8, 0x84, 0xa0, 0x68, 0x68, 0xac, 0xbc, 0x18, 0x1c, 0x8c, 0xa4, 0xb8, 0x4c, 0xd8, 0x28, 0x64, 0xd8, 0x58, 0xdc, 0xb0, 0xa0, 0x9c, 0xd0, 0xc4, 0x44, 0x10, 0x7c, 0x08, 0xb4, 0x00, 0x5c, 0x68, 0x94, 0xe4, 0x08, 0xb0, 0x00, 0x5c, 0x20, 0xdc, 0x4c, 0xa0, 0x60, 0x98, 0x70, 0xec, 0x0c, 0xac, 0xc4, 0x18, 0xa8, 0x8c, 0xb8, 0xf0, 0xc8, 0x38, 0x28, 0x54, 0xd8, 0x44, 0xdc, 0x7c, 0xe8, 0x34, 0x30, 0x5c, 0x74, 0xdc, 0x60, 0xa0, 0xf8, 0x98, 0xf4, 0xa4, 0x1c, 0x04, 0xc4, 0x80, 0xa8, 0x08, 0xb8, 0xb8, 0x80, 0xd8, 0x80, 0x2c, 0x40, 0xf0, 0x58, 0x60, 0xa0, 0xb0, 0xd0, 0x14, 0x0c, 0x74, 0xd4, 0x38, 0xe4, 0x54, 0x70, 0x0c, 0x44, 0xd4, 0x6c, 0xe4, 0x30, 0x70, 0x74, 0x0c, 0x28, 0xc4, 0x50, 0xa8, 0x24, 0xf0, 0x20, 0x60, 0x14, 0xb0, 0xcc, 0x5c, 0x88, 0x94, 0xd4, 0x08, 0xe4, 0x48, 0x70, 0xc0, 0x0c, 0x7c, 0x8c, 0x7c, 0x00, 0xbc, 0x68, 0xa4, 0xe4, 0x5c, 0xf8, 0x64, 0xbc, 0x10, 0xec, 0x50, 0xbc, 0xe4, 0x54, 0x38, 0x44, 0xec, 0x34, 0xbc, 0xd4, 0x54, 0x24, 0x0c, 0x68, 0xd4, 0xf4, 0xe4, 0xb4, 0x38, 0x74, 0xa4, 0x28, 0x5c, 0x50, 0x2c, 0x24, 0xb8, 0x68, 0x80, 0xbc, 0xc8, 0x54, 0xe8, 0x0c, 0x88, 0x9c, 0x8c, 0x04, 0x00, 0x08, 0x68, 0xb8, 0xe4, 0x90, 0xb0, 0x84, 0x14, 0x20, 0x74, 0x4c, 0x38, 0x60, 0x1c, 0x70, 0xa4, 0x44, 0x4c, 0x6c, 0x60, 0x30, 0x38, 0x3c, 0xec, 0x80, 0xbc, 0xc8, 0x1c, 0xa0, 0xec, 0x68, 0xe4, 0xf4, 0xf8, 0xb4, 0xf4, 0x3c, 0x0c, 0xc8, 0xc4, 0x60, 0xe0, 0x38, 0x10, 0xa4, 0x18, 0x14, 0x04, 0xcc, 0x08, 0xc0, 0xb8, 0x34, 0xd8, 0x9c, 0x64, 0xc4, 0x10, 0x58, 0x50, 0xa0, 0xac, 0xd0, 0xd8, 0x44, 0xdc, 0x34, 0xa0, 0xd4, 0x98, 0x6c, 0xa4, 0x88, 0x4c, 0xc4, 0x28, 0xa8, 0x90, 0xb8, 0x3c, 0x80, 0x90, 0xc8, 0xcc, 0xe8, 0x88, 0xc0, 0xd4, 0x24, 0xac, 0x98, 0x90
-        };
-
-        // New
-//        const uint8_t prng_payload_sf7[] = {
-//            0xDC, 0xEC, 0xB0, 0xF4, 0x9C, 0xFC, 0xC4, 0xDC, 0x10, 0xF8, 0x40, 0x34, 0xA8, 0x5C, 0xF0, 0x94, 0x60, 0x08, 0xF8, 0x48, 0xBC, 0x88, 0xA4, 0xD4, 0x14, 0xE4, 0x84, 0x38, 0x68, 0xEC, 0xE4, 0xBC, 0xB0, 0x1C, 0x14, 0xA4, 0x3C, 0x4C, 0x90, 0x60, 0x84, 0x70, 0x20, 0x44, 0x04, 0x24, 0x80, 0x98, 0x40, 0xA4, 0x58, 0x04, 0xA0, 0x80, 0x98, 0x40, 0xA4, 0x10, 0x4C, 0x40, 0x60, 0xA8, 0x38, 0xB8, 0xA4, 0x80, 0x14, 0xC8, 0x84, 0xA0, 0x68, 0x68, 0xAC, 0xBC, 0x18, 0x1C, 0x8C, 0xA4, 0xB8, 0x4C, 0xD8, 0x28, 0x64, 0xD8, 0x58, 0xDC, 0xB0, 0xA0, 0x9C, 0xD0, 0xC4, 0x44, 0x10, 0x7C, 0x08, 0xB4, 0x00, 0x5C, 0x68, 0x94, 0xE4, 0x08, 0xB0, 0x00, 0x5C, 0x20, 0xDC, 0x4C, 0xA0, 0x60, 0x98, 0x70, 0xEC, 0x0C, 0xAC, 0xC4, 0x18, 0xA8, 0x8C, 0xB8, 0xF0, 0xC8, 0x38, 0x28, 0x54, 0xD8, 0x44, 0xDC, 0x7C, 0xE8, 0x34, 0x30, 0x5C, 0x74, 0xDC, 0x60, 0xA0, 0xF8, 0x98, 0xF4, 0xA4, 0x1C, 0x04, 0xC4, 0x80, 0xA8, 0x08, 0xB8, 0xB8, 0x80, 0xD8, 0x80, 0x2C, 0x40, 0xF0, 0x58, 0x60, 0xA0, 0xB0, 0xD0, 0x14, 0x0C, 0x74, 0xD4, 0x38, 0xE4, 0x54, 0x70, 0x0C, 0x44, 0xD4, 0x6C, 0xE4, 0x30, 0x70, 0x74, 0x0C, 0x28, 0xC4, 0x50, 0xA8, 0x24, 0xF0, 0x20, 0x60, 0x14, 0xB0, 0xCC, 0x5C, 0x88, 0x94, 0xD4, 0x08, 0xE4, 0x48, 0x70, 0xC0, 0x0C, 0x7C, 0x8C, 0x7C, 0x00, 0xBC, 0x68, 0xA4, 0xE4, 0x5C, 0xF8, 0x64, 0xBC, 0x10, 0xEC, 0x50, 0xBC, 0xE4, 0x54, 0x38, 0x44, 0xEC, 0x34, 0xBC, 0xD4, 0x54, 0x24, 0x0C, 0x68, 0xD4, 0xF4, 0xE4, 0xB4, 0x38, 0x74, 0xA4, 0x28, 0x5C, 0x50, 0x2C, 0x24, 0xB8, 0x68, 0x80, 0xBC, 0xC8, 0x54, 0xE8, 0x0C, 0x88, 0x9C, 0x8C, 0x04, 0x00, 0x08, 0x68, 0xB8, 0xE4, 0x90, 0x80, 0x00, 0x40, 0x20, 0xA4, 0x28, 0xE8, 0x04, 0x54, 0x70
-//        };
-
-
-        /**
-         *  Whitening sequence for payload with SF 8.
-         */
-        const uint8_t prng_payload_sf8[] = {
-            0xbd, 0xdf, 0xa4, 0xfb, 0x16, 0x7f, 0x85, 0xfe, 0x40, 0xdf, 0x5b, 0xb0, 0xa2, 0x9e, 0xd0, 0x86, 0x26, 0x20, 0x68, 0x4f, 0xf7, 0x2a, 0xb6, 0xd3, 0x5e, 0x46, 0x97, 0x7c, 0x43, 0x7f, 0xe3, 0xb5, 0x73, 0x3e, 0x45, 0x83, 0x25, 0xcb, 0x9b, 0xe0, 0xc7, 0x13, 0x10, 0x51, 0x08, 0xad, 0x02, 0x98, 0x40, 0xa7, 0x5b, 0x04, 0xa2, 0x80, 0x9b, 0x01, 0xc7, 0x20, 0x5b, 0x4f, 0xe9, 0x2a, 0x7a, 0x98, 0xf4, 0xa7, 0x0e, 0x4f, 0x8f, 0x61, 0x49, 0x79, 0xea, 0x94, 0x89, 0x1a, 0xc4, 0x07, 0xa8, 0x4a, 0x92, 0x8a, 0x76, 0x9d, 0x70, 0x4c, 0xb6, 0xab, 0x5e, 0xf2, 0x97, 0x62, 0x08, 0xf8, 0x02, 0xb5, 0x40, 0x3e, 0x5b, 0x83, 0xe9, 0x80, 0x31, 0x01, 0x5e, 0x20, 0xdc, 0x4f, 0xa2, 0x61, 0x9b, 0x32, 0x8c, 0x3e, 0x9a, 0xd8, 0x95, 0x22, 0x4e, 0x9a, 0xa0, 0xac, 0x23, 0x8e, 0x5d, 0x05, 0x64, 0xcf, 0xb9, 0xc1, 0xc4, 0x37, 0x02, 0xdd, 0xce, 0xe7, 0xe9, 0x58, 0xc9, 0xb1, 0xbf, 0x98, 0x0a, 0xcd, 0xc0, 0x8b, 0x7b, 0xdd, 0xb2, 0x0f, 0x54, 0x03, 0x6d, 0x60, 0xe2, 0x4f, 0x6e, 0x2e, 0xb9, 0xc3, 0x16, 0x50, 0x76, 0xb6, 0x2f, 0xe6, 0xd7, 0x30, 0x6c, 0x37, 0xc3, 0x62, 0x4a, 0xbb, 0xa1, 0x54, 0x5e, 0x4d, 0xfd, 0xc6, 0xa2, 0xee, 0xd4, 0xb2, 0x24, 0x3e, 0x23, 0xe9, 0x56, 0x3e, 0x8d, 0x53, 0x42, 0x06, 0x7b, 0x37, 0xf9, 0x9e, 0xf6, 0x86, 0xbc, 0x20, 0xcf, 0x0e, 0xbc, 0x7d, 0xd7, 0x7b, 0x26, 0xdf, 0x61, 0xcb, 0x5d, 0x38, 0xe4, 0x54, 0x39, 0x0e, 0xef, 0x87, 0xb8, 0xd5, 0x57, 0x67, 0x6e, 0xd8, 0x82, 0xeb, 0x4b, 0x3c, 0x7a, 0x56, 0xf4, 0x0d, 0x45, 0x96, 0x31, 0xc6, 0x1b, 0x73, 0xc6, 0x95, 0x7b, 0x11, 0xb2, 0xa5, 0x1f, 0x9a, 0xc7, 0xe6, 0x30, 0x4f, 0x47, 0x2a, 0xeb, 0x1a, 0x63, 0xa7, 0x65, 0x54, 0x6e, 0xcf, 0x39, 0xe2, 0xdf, 0x5b, 0xb6, 0x51, 0x57, 0xe6, 0xe3, 0xb0, 0x38, 0x3e, 0xcf, 0xc2, 0xbc, 0xd7, 0x9c, 0xe2, 0x8c, 0x58, 0xb1, 0xca, 0x74, 0x3c, 0xb6, 0x9d, 0x5e, 0xae, 0xfc, 0xe5, 0xe9, 0xf8, 0xa9, 0xb5, 0x5b, 0x3e, 0xb7, 0xd9, 0x07, 0x61, 0x28, 0x3a, 0x90, 0x7e, 0x76, 0xb3, 0x3f, 0xcb, 0x5f, 0xab, 0xee, 0xf3, 0xeb, 0x72, 0xc0, 0xb3, 0x28, 0x5c, 0xd9, 0x4d, 0xb6, 0x9d, 0x57, 0x4c, 0xa0, 0x29, 0x92, 0xb9, 0x1d, 0x83, 0x95, 0xd3, 0x8e, 0x2b, 0xe9, 0xf3, 0xa2, 0x29, 0x25, 0x15, 0x40, 0xcf, 0x6d, 0xca, 0x89, 0xd6, 0xd4, 0xa1, 0xc3, 0x51, 0x39, 0x4d, 0x85, 0x8d, 0x49, 0x44, 0xe8, 0xe2, 0xbb, 0x1a, 0x84, 0x00, 0x49, 0x98, 0xec, 0x65, 0x72, 0x10, 0x6e, 0x80, 0x40, 0xdd, 0x76, 0x65, 0x3b, 0x51, 0x8e, 0x02, 0xb8, 0x70, 0xd7, 0xe2, 0xa7, 0x9a, 0x48, 0xab, 0xc2, 0x38, 0x7d, 0x5e, 0xbe, 0x06, 0x86, 0x4c, 0x09, 0x72, 0xaf, 0xf4, 0x58, 0x9e, 0x3c, 0x80, 0xed, 0xdd, 0xa5, 0x2e, 0x55, 0xf8, 0xbc, 0xd8, 0xed, 0x4d, 0xb9, 0xa0, 0x16, 0xfe, 0x5f, 0xf9, 0xde, 0x79, 0xa7, 0x34, 0xd8, 0x37, 0xf6, 0xb9, 0x77, 0x5a, 0x6b, 0x2e, 0x76, 0xf8, 0x36, 0xb5, 0x8b, 0xc3, 0xc2, 0xe2, 0xc1, 0x53, 0x38, 0x0a, 0xfd, 0x2b, 0xf2, 0x83, 0xf5, 0x64, 0x25, 0x5e, 0x33, 0x49, 0x50, 0xfb, 0x64, 0xd5, 0xa2, 0x41, 0x21, 0x85, 0x5c, 0x41, 0x25, 0x4d, 0x09, 0xe6, 0xe3, 0xa5, 0x79, 0xd9, 0x77, 0x06, 0x6e, 0x4c, 0xc0, 0x77, 0x35, 0xfc, 0x11, 0xd5, 0x5d, 0x0a, 0x97, 0x50, 0x05, 0xa9, 0xe9, 0xb3, 0x7b, 0x79, 0x96, 0x15, 0x13, 0x04, 0x8f, 0x62, 0x91, 0x5e, 0x74, 0x12, 0x75, 0x9e, 0x3e, 0xad, 0x4b, 0x97, 0xe3, 0xf0, 0x8a, 0x03, 0x41, 0x60, 0xd1, 0xd2, 0x4b, 0xbb, 0xda, 0x3f, 0x3d
-        };
-
-        // New
-//        const uint8_t prng_payload_sf8[] = {
-//            0xBD, 0x54, 0x2C, 0x70, 0x1C, 0x74, 0x0C, 0x74, 0x40, 0x54, 0x58, 0x38, 0x20, 0x14, 0x50, 0x0C, 0x2C, 0x20, 0x68, 0x4C, 0x7C, 0x28, 0x3C, 0x50, 0x54, 0x4C, 0x1C, 0x7C, 0x40, 0x74, 0x60, 0x3C, 0x70, 0x34, 0x4C, 0x08, 0x2C, 0x48, 0x18, 0x60, 0x4C, 0x10, 0x10, 0x58, 0x08, 0x24, 0x00, 0x18, 0x40, 0x2C, 0x58, 0x04, 0x20, 0x00, 0x18, 0x00, 0x4C, 0x20, 0x58, 0x4C, 0x68, 0x28, 0x78, 0x18, 0x7C, 0x2C, 0x04, 0x4C, 0x04, 0x60, 0x48, 0x78, 0x68, 0x1C, 0x08, 0x10, 0x4C, 0x0C, 0x28, 0x48, 0x10, 0x08, 0x7C, 0x1C, 0x70, 0x44, 0x3C, 0x28, 0x54, 0x70, 0x1C, 0x68, 0x08, 0x78, 0x00, 0x3C, 0x40, 0x34, 0x58, 0x08, 0x68, 0x00, 0x30, 0x00, 0x54, 0x20, 0x54, 0x4C, 0x20, 0x60, 0x18, 0x30, 0x04, 0x34, 0x38, 0x40, 0x10, 0x28, 0x44, 0x18, 0x20, 0x64, 0x20, 0x2C, 0x54, 0x18, 0x6C, 0x44, 0x38, 0x40, 0x2C, 0x34, 0x1C, 0x5C, 0x44, 0x6C, 0x68, 0x58, 0x08, 0x38, 0x04, 0x14, 0x00, 0x44, 0x40, 0x08, 0x58, 0x1C, 0x20, 0x0C, 0x50, 0x00, 0x64, 0x20, 0x40, 0x4C, 0x64, 0x28, 0x30, 0x50, 0x1C, 0x04, 0x7C, 0x54, 0x38, 0x6C, 0x5C, 0x30, 0x64, 0x7C, 0x40, 0x68, 0x64, 0x30, 0x30, 0x5C, 0x54, 0x04, 0x54, 0x54, 0x20, 0x6C, 0x50, 0x30, 0x2C, 0x34, 0x20, 0x40, 0x1C, 0x28, 0x0C, 0x50, 0x40, 0x4C, 0x58, 0x34, 0x68, 0x14, 0x78, 0x0C, 0x34, 0x20, 0x64, 0x4C, 0x34, 0x60, 0x5C, 0x78, 0x2C, 0x54, 0x20, 0x70, 0x54, 0x3C, 0x6C, 0x5C, 0x38, 0x0C, 0x64, 0x04, 0x30, 0x54, 0x5C, 0x6C, 0x64, 0x58, 0x00, 0x60, 0x40, 0x3C, 0x70, 0x5C, 0x7C, 0x04, 0x4C, 0x14, 0x38, 0x44, 0x18, 0x78, 0x4C, 0x1C, 0x78, 0x18, 0x30, 0x2C, 0x1C, 0x18, 0x4C, 0x6C, 0x10, 0x5C, 0x44, 0x20, 0x40, 0x18, 0x40, 0x60, 0x10, 0x14, 0x54, 0x34, 0x58, 0x34, 0x38
-//        };
-
-
-        /**
-         *  Whitening sequence for payload with SF 9.
-         */
-        const uint8_t prng_payload_sf9[] = {
-            0xfd, 0xbe, 0x94, 0xef, 0x1a, 0xf7, 0x07, 0xfd, 0x01, 0xff, 0x0b, 0x94, 0xba, 0x1a, 0xda, 0x07, 0x64, 0x01, 0x78, 0x0b, 0xdf, 0xba, 0xb0, 0xda, 0x9e, 0x64, 0x86, 0x78, 0x0b, 0xdf, 0xf1, 0xb0, 0x3b, 0x9e, 0x57, 0x86, 0x2d, 0x0b, 0xb9, 0xf1, 0x83, 0x3b, 0x80, 0x57, 0x01, 0x2d, 0x40, 0xb9, 0x10, 0x83, 0x47, 0x80, 0xa8, 0x03, 0x99, 0x41, 0xa3, 0x12, 0x5f, 0x03, 0x69, 0x08, 0x79, 0x98, 0xf4, 0xa7, 0x0e, 0x5f, 0xcf, 0x6d, 0xe9, 0x79, 0xab, 0xf6, 0xb9, 0x2e, 0xd8, 0xcf, 0x2e, 0x41, 0xd1, 0x2b, 0x26, 0xb9, 0x68, 0xb8, 0xb8, 0x22, 0x1c, 0xd1, 0x07, 0x27, 0x60, 0x48, 0x14, 0xb8, 0x88, 0x9c, 0x48, 0x86, 0xa1, 0x60, 0x03, 0x04, 0x16, 0x94, 0x4e, 0x42, 0xa9, 0xa1, 0xf9, 0x03, 0xc8, 0x16, 0x3e, 0x46, 0x98, 0xab, 0x8e, 0xf9, 0xf1, 0xe8, 0x3b, 0x32, 0x57, 0x9e, 0xe7, 0x8c, 0x18, 0xf1, 0x80, 0x3f, 0x9e, 0x5f, 0xcd, 0xe7, 0xe8, 0x58, 0xe9, 0xb1, 0x9f, 0x92, 0x82, 0xcf, 0x00, 0xea, 0x2b, 0x88, 0xbe, 0xaf, 0x56, 0x82, 0x2e, 0x08, 0x92, 0x6b, 0x17, 0xae, 0x3b, 0x4a, 0xd7, 0x2a, 0x66, 0x92, 0x13, 0x76, 0x21, 0x3b, 0xa5, 0xd3, 0xd3, 0x65, 0x26, 0x13, 0x02, 0x41, 0x52, 0xad, 0x46, 0xd3, 0xa8, 0x26, 0xb2, 0x23, 0x52, 0x12, 0xb3, 0xce, 0x97, 0xa9, 0xc6, 0x33, 0x30, 0x72, 0x27, 0xbf, 0x7b, 0x1d, 0x7b, 0xc7, 0x9d, 0x30, 0xeb, 0x27, 0x38, 0x73, 0xd6, 0x79, 0x2f, 0x9f, 0x03, 0xeb, 0x39, 0x2c, 0xe8, 0xd6, 0x7b, 0x27, 0x9d, 0x43, 0x80, 0x59, 0xc9, 0xec, 0xae, 0x79, 0x93, 0x9f, 0x16, 0x80, 0x74, 0xc9, 0x3e, 0xae, 0x56, 0x93, 0x4d, 0x57, 0xcd, 0x64, 0x2b, 0x3e, 0xc8, 0x56, 0xea, 0x6d, 0xa8, 0x8d, 0x9b, 0x0f, 0x86, 0xc8, 0x02, 0xe8, 0x80, 0xe9, 0x27, 0xbb, 0xdd, 0x86, 0xe5, 0x4a, 0x79, 0x80, 0x2e, 0x07, 0x9b, 0xd9, 0x89, 0xed, 0xe2, 0x73, 0x18, 0x2e, 0xe9, 0xeb, 0x38, 0xd9, 0x95, 0xe0, 0x8d, 0x98, 0xd1, 0x8a, 0x74, 0x2c, 0x32, 0x1d, 0x17, 0x8e, 0x2d, 0x91, 0xf5, 0x44, 0xbf, 0x36, 0x1d, 0x15, 0xc7, 0x2d, 0x7b, 0xb5, 0x96, 0xbb, 0x50, 0x1d, 0x6b, 0xc5, 0x53, 0x3b, 0x41, 0xb6, 0x85, 0x54, 0x1a, 0x6d, 0x8d, 0x53, 0xdb, 0x41, 0x85, 0xa5, 0x29, 0x9a, 0xca, 0x8e, 0x8a, 0xfa, 0xd6, 0x91, 0xb8, 0xa5, 0x98, 0xc1, 0x8c, 0xca, 0xda, 0xe6, 0xaa, 0xa1, 0x27, 0x18, 0xc8, 0x8d, 0x05, 0xfb, 0x8d, 0xca, 0x40, 0xa7, 0x40, 0x51, 0x29, 0x4d, 0xc5, 0xbd, 0x7d, 0x1c, 0xe0, 0x60, 0xfb, 0x31, 0x94, 0x44, 0x71, 0x7d, 0xfe, 0xe8, 0xb0, 0x7a, 0x55, 0xd7, 0xbc, 0x21, 0xfd, 0xda, 0xf6, 0xb8, 0xfc, 0xdf, 0xd4, 0x9c, 0x21, 0xfc, 0xf2, 0x76, 0xf9, 0xfc, 0xbe, 0x17, 0xaf, 0x41, 0xe3, 0xca, 0xbe, 0x6f, 0x5f, 0xbf, 0x0c, 0x87, 0x2d, 0xc3, 0x48, 0x36, 0x74, 0x57, 0x73, 0x4d, 0x43, 0xad, 0xd0, 0x18, 0xe3, 0xe0, 0xb0, 0x72, 0x35, 0x6f, 0x49, 0xf4, 0x52, 0x6b, 0xac, 0xb4, 0xd8, 0x35, 0xf6, 0x59, 0x77, 0x5e, 0x7b, 0xae, 0xbc, 0xda, 0x3e, 0xf7, 0x32, 0x53, 0x84, 0xeb, 0x23, 0x30, 0x18, 0x7e, 0xb1, 0x52, 0x64, 0xb4, 0xbe, 0x05, 0x56, 0x0a, 0x0c, 0x91, 0x76, 0x50, 0xb1, 0x3e, 0x59, 0x57, 0x6e, 0x0d, 0xa3, 0xb6, 0x7e, 0x89, 0x76, 0x4b, 0x7d, 0x6e, 0xde, 0x82, 0x90, 0x5e, 0xca, 0x72, 0x4d, 0x71, 0xe9, 0xdc, 0x82, 0xd0, 0x15, 0x9a, 0x83, 0x4d, 0x09, 0xeb, 0x20, 0x82, 0x6f, 0x74, 0x1e, 0x93, 0x18, 0x8d, 0x0b, 0x20, 0xb1, 0x2e, 0x60, 0x1e, 0xf1, 0x10, 0xfd, 0x0f, 0x5e, 0xb7, 0x9b, 0x40, 0x94, 0x0a, 0x89, 0x02, 0xa0, 0xb7, 0x66, 0x43, 0x77, 0xb6, 0xc7, 0x3e, 0x3f, 0xdf
-        };
-
-        // New
-//        const uint8_t prng_payload_sf9[] = {
-//            0xFD, 0xBE, 0x1C, 0x64, 0x10, 0x7C, 0x0C, 0x74, 0x00, 0x74, 0x08, 0x1C, 0x38, 0x10, 0x58, 0x0C, 0x6C, 0x00, 0x78, 0x08, 0x54, 0x38, 0x38, 0x58, 0x14, 0x6C, 0x0C, 0x78, 0x08, 0x54, 0x70, 0x38, 0x38, 0x14, 0x5C, 0x0C, 0x24, 0x08, 0x38, 0x70, 0x08, 0x38, 0x00, 0x5C, 0x00, 0x24, 0x40, 0x38, 0x10, 0x08, 0x40, 0x00, 0x28, 0x00, 0x18, 0x40, 0x2C, 0x10, 0x4C, 0x40, 0x60, 0x28, 0x78, 0x18, 0x7C, 0x2C, 0x04, 0x4C, 0x04, 0x60, 0x48, 0x78, 0x28, 0x7C, 0x38, 0x04, 0x40, 0x04, 0x28, 0x48, 0x50, 0x28, 0x2C, 0x38, 0x68, 0x40, 0x34, 0x28, 0x14, 0x50, 0x0C, 0x2C, 0x20, 0x68, 0x04, 0x34, 0x00, 0x14, 0x48, 0x0C, 0x20, 0x20, 0x20, 0x04, 0x1C, 0x14, 0x44, 0x48, 0x20, 0x20, 0x78, 0x00, 0x40, 0x1C, 0x3C, 0x4C, 0x18, 0x28, 0x04, 0x78, 0x70, 0x60, 0x38, 0x30, 0x5C, 0x1C, 0x6C, 0x04, 0x18, 0x70, 0x08, 0x3C, 0x1C, 0x5C, 0x44, 0x6C, 0x68, 0x58, 0x68, 0x38, 0x14, 0x18, 0x00, 0x44, 0x00, 0x68, 0x28, 0x00, 0x3C, 0x24, 0x54, 0x00, 0x24, 0x00, 0x10, 0x68, 0x1C, 0x2C, 0x38, 0x48, 0x5C, 0x20, 0x6C, 0x10, 0x10, 0x7C, 0x28, 0x38, 0x2C, 0x58, 0x50, 0x6C, 0x2C, 0x10, 0x00, 0x48, 0x58, 0x2C, 0x44, 0x50, 0x28, 0x2C, 0x30, 0x20, 0x58, 0x18, 0x38, 0x44, 0x14, 0x28, 0x4C, 0x30, 0x10, 0x68, 0x64, 0x30, 0x70, 0x14, 0x78, 0x44, 0x14, 0x10, 0x60, 0x64, 0x34, 0x60, 0x5C, 0x78, 0x2C, 0x14, 0x00, 0x60, 0x50, 0x3C, 0x64, 0x5C, 0x78, 0x2C, 0x54, 0x60, 0x08, 0x54, 0x50, 0x6C, 0x24, 0x78, 0x10, 0x54, 0x3C, 0x08, 0x74, 0x5C, 0x34, 0x24, 0x5C, 0x10, 0x04, 0x5C, 0x5C, 0x64, 0x0C, 0x34, 0x48, 0x5C, 0x68, 0x24, 0x08, 0x1C, 0x10, 0x04, 0x00, 0x48, 0x08, 0x68, 0x00, 0x08, 0x14, 0x08, 0x00, 0x00, 0x6C, 0x08, 0x20
-//        };
-
+        const uint8_t *payload_whitening_sequence(const uint8_t sf, uint32_t *len = nullptr, const bool shuffled = false);
 
         /**
-         *  Whitening sequence for payload with SF 10.
+         *  Every dewhitened codeword, still shuffled, deshuffled, bit reversed and decoded with `hamming_decode_soft_byte`,
+         *  for CR 4/8 and 4/7.
          */
-        const uint8_t prng_payload_sf10[] = {
-            0xfd, 0xfe, 0xf4, 0xdf, 0x0e, 0xfb, 0x8f, 0x7f, 0x02, 0xfe, 0x4b, 0xb4, 0xea, 0x3e, 0xc2, 0x83, 0x6a, 0x88, 0xfa, 0x48, 0xfe, 0xaa, 0xf4, 0xf2, 0x4e, 0x62, 0xab, 0xf8, 0xd1, 0xfc, 0xe0, 0xb4, 0x73, 0x7e, 0x65, 0x83, 0x21, 0xcb, 0x93, 0x72, 0x87, 0x32, 0x40, 0x75, 0x50, 0x29, 0x2c, 0x19, 0x9a, 0x84, 0x4a, 0x00, 0xea, 0x30, 0xa9, 0x04, 0x8b, 0x88, 0x49, 0x0a, 0xe2, 0x2a, 0x38, 0xb9, 0xa4, 0xa3, 0x16, 0xdf, 0xcd, 0x60, 0x4b, 0x7b, 0xea, 0x94, 0x89, 0x1a, 0xd0, 0x47, 0x28, 0x60, 0xd3, 0xaa, 0x26, 0xb9, 0x68, 0xb8, 0xb8, 0x22, 0x1c, 0xd1, 0x06, 0x65, 0x40, 0x18, 0x30, 0xa0, 0x3c, 0x92, 0xc9, 0x4c, 0xe2, 0x01, 0x73, 0x64, 0x2e, 0x34, 0xd0, 0x83, 0x20, 0xe2, 0x18, 0x32, 0x8e, 0x7c, 0x9a, 0xf8, 0xd5, 0x32, 0x46, 0x1e, 0xe0, 0xcd, 0x73, 0xca, 0x25, 0x8d, 0x7a, 0x64, 0xfe, 0x6a, 0xb5, 0x33, 0x5d, 0x35, 0xbd, 0x72, 0x96, 0xf0, 0x1b, 0xbf, 0x02, 0x1c, 0x40, 0xad, 0x30, 0x9e, 0x47, 0x55, 0x30, 0x04, 0xd3, 0x02, 0x6d, 0x62, 0xe2, 0x3f, 0x6a, 0x26, 0xb1, 0x41, 0x54, 0x2c, 0x2e, 0xb2, 0x03, 0x52, 0x01, 0xaf, 0xab, 0xd4, 0xd0, 0xe7, 0x26, 0x13, 0x62, 0x41, 0x06, 0xa5, 0x62, 0x53, 0xbb, 0xed, 0x92, 0x13, 0x17, 0x3a, 0x1b, 0x50, 0x94, 0x29, 0x0d, 0xd2, 0x42, 0x06, 0x3b, 0x17, 0xc9, 0xda, 0xea, 0x0e, 0x7e, 0x03, 0xbe, 0x2b, 0xe4, 0xa5, 0x69, 0xf4, 0xe8, 0x76, 0xb3, 0xfd, 0x14, 0x94, 0x36, 0x41, 0x64, 0xca, 0xf1, 0x28, 0xb6, 0xd6, 0x15, 0x46, 0x1f, 0x5c, 0x9a, 0x63, 0xcc, 0x3f, 0xfa, 0x54, 0xf4, 0x0d, 0x05, 0xf6, 0x21, 0xe2, 0x93, 0xe9, 0x05, 0xb3, 0x0a, 0x55, 0xfa, 0x29, 0x81, 0x1d, 0x9d, 0x0a, 0x82, 0x4a, 0x48, 0x8b, 0x31, 0xfd, 0x2b, 0x23, 0x5f, 0x9d, 0x64, 0x48, 0x73, 0xc9, 0x4e, 0x57, 0xbf, 0xd1, 0x51, 0xe7, 0x67, 0x30, 0x39, 0x3e, 0xaf, 0xe3, 0xac, 0xef, 0x10, 0x70, 0x4e, 0x73, 0xa0, 0xde, 0x28, 0x90, 0xac, 0xba, 0x00, 0x4d, 0x86, 0x62, 0xa1, 0x58, 0x63, 0xd1, 0x26, 0x8a, 0x89, 0x45, 0xc9, 0xe2, 0xea, 0x13, 0x82, 0x7a, 0x5e, 0x03, 0x3d, 0xda, 0xdf, 0xa9, 0x6c, 0xf3, 0xc9, 0x12, 0xf0, 0x8f, 0xa0, 0x56, 0x1f, 0x27, 0xc7, 0xf8, 0x3b, 0xe8, 0xd6, 0x3e, 0xd4, 0x82, 0x2f, 0x85, 0x59, 0x29, 0x9d, 0xce, 0x96, 0x4e, 0x4c, 0xa4, 0x0f, 0x9b, 0x12, 0xec, 0x1d, 0xce, 0xa1, 0x4e, 0x42, 0xaa, 0xeb, 0x50, 0x29, 0x8d, 0xc5, 0xfd, 0x5d, 0x04, 0xec, 0x46, 0x7a, 0x63, 0xf5, 0x94, 0x05, 0x21, 0x5e, 0x8e, 0xb9, 0xe1, 0x9d, 0xb3, 0x8f, 0x35, 0xb1, 0x32, 0x64, 0x97, 0xe1, 0x17, 0x35, 0xcf, 0x1c, 0x82, 0x16, 0x1c, 0x54, 0x7b, 0xed, 0xb3, 0xfe, 0xdd, 0xbf, 0x06, 0xc4, 0x0c, 0x29, 0x46, 0xa7, 0x70, 0x08, 0xf5, 0x0c, 0xd5, 0xd1, 0x61, 0x4f, 0x93, 0x80, 0x12, 0x4f, 0xc3, 0x20, 0x80, 0x43, 0x67, 0x49, 0xc2, 0xab, 0x6f, 0x5d, 0xf3, 0xef, 0x51, 0xe8, 0x81, 0xfb, 0xb5, 0xc9, 0x51, 0x72, 0x2e, 0x7e, 0xf8, 0x2e, 0xf7, 0xab, 0xd7, 0x86, 0x6a, 0xa3, 0xb1, 0x09, 0x7e, 0x91, 0x52, 0x04, 0x98, 0x2a, 0x8b, 0xd4, 0x48, 0x64, 0x00, 0xe2, 0x4c, 0x41, 0x28, 0x7c, 0xda, 0xac, 0x26, 0x93, 0xb3, 0x34, 0x49, 0x14, 0x52, 0x69, 0x0a, 0x76, 0xd0, 0x75, 0x0e, 0x0c, 0x2c, 0xc4, 0x2b, 0x04, 0xf0, 0x42, 0x36, 0x6c, 0x3c, 0x89, 0x89, 0xab, 0x3a, 0x8e, 0xdd, 0xca, 0xa7, 0xeb, 0xbe, 0xa9, 0xd3, 0xe4, 0x94, 0xe7, 0xe0, 0xf9, 0xb8, 0x3e, 0xf9, 0xe7, 0xac, 0xd3, 0x09, 0x79, 0x61, 0x80, 0x82, 0x41, 0x31, 0x48, 0xa0, 0x50, 0x96, 0x02, 0x26, 0x64, 0x85, 0x16
-        };
-
-        // New
-//        const uint8_t prng_payload_sf10[] = {
-//            0xFD, 0xFE, 0xF4, 0x54, 0x04, 0x70, 0x04, 0x74, 0x00, 0x74, 0x48, 0x3C, 0x68, 0x34, 0x40, 0x08, 0x64, 0x00, 0x78, 0x48, 0x74, 0x28, 0x7C, 0x70, 0x04, 0x68, 0x04, 0x78, 0x48, 0x74, 0x60, 0x3C, 0x70, 0x34, 0x4C, 0x08, 0x2C, 0x40, 0x18, 0x60, 0x0C, 0x30, 0x40, 0x7C, 0x50, 0x20, 0x2C, 0x10, 0x10, 0x0C, 0x48, 0x00, 0x68, 0x30, 0x28, 0x04, 0x04, 0x00, 0x48, 0x00, 0x60, 0x28, 0x38, 0x38, 0x2C, 0x28, 0x1C, 0x5C, 0x44, 0x60, 0x48, 0x78, 0x68, 0x1C, 0x08, 0x10, 0x58, 0x44, 0x28, 0x68, 0x50, 0x28, 0x2C, 0x38, 0x68, 0x30, 0x30, 0x28, 0x1C, 0x50, 0x0C, 0x6C, 0x40, 0x18, 0x10, 0x38, 0x3C, 0x14, 0x48, 0x04, 0x60, 0x00, 0x70, 0x20, 0x24, 0x14, 0x48, 0x00, 0x28, 0x60, 0x18, 0x30, 0x04, 0x34, 0x38, 0x60, 0x50, 0x38, 0x4C, 0x1C, 0x60, 0x44, 0x70, 0x48, 0x4C, 0x1C, 0x70, 0x64, 0x78, 0x68, 0x3C, 0x30, 0x54, 0x7C, 0x14, 0x78, 0x00, 0x70, 0x18, 0x34, 0x08, 0x14, 0x40, 0x24, 0x30, 0x1C, 0x44, 0x54, 0x38, 0x04, 0x50, 0x00, 0x64, 0x60, 0x60, 0x3C, 0x60, 0x24, 0x30, 0x40, 0x5C, 0x2C, 0x2C, 0x30, 0x00, 0x58, 0x10, 0x2C, 0x2C, 0x5C, 0x50, 0x6C, 0x2C, 0x50, 0x40, 0x48, 0x08, 0x2C, 0x68, 0x50, 0x28, 0x6C, 0x10, 0x50, 0x1C, 0x20, 0x3C, 0x58, 0x1C, 0x28, 0x0C, 0x50, 0x40, 0x0C, 0x38, 0x24, 0x4C, 0x18, 0x68, 0x04, 0x74, 0x00, 0x34, 0x28, 0x4C, 0x74, 0x60, 0x74, 0x64, 0x74, 0x30, 0x74, 0x1C, 0x5C, 0x1C, 0x48, 0x64, 0x44, 0x78, 0x30, 0x3C, 0x5C, 0x1C, 0x0C, 0x14, 0x4C, 0x1C, 0x68, 0x64, 0x3C, 0x78, 0x5C, 0x7C, 0x44, 0x2C, 0x64, 0x28, 0x68, 0x18, 0x60, 0x0C, 0x3C, 0x08, 0x7C, 0x18, 0x00, 0x04, 0x14, 0x04, 0x08, 0x08, 0x48, 0x48, 0x08, 0x30, 0x0C, 0x1C, 0x1C, 0x08, 0x00, 0x60, 0x2C, 0x10
-//        };
-
-
-        /**
-         *  Whitening sequence for payload with SF 11.
-         */
-        const uint8_t prng_payload_sf11[] = {
-            0xfd, 0xfe, 0xb4, 0xbf, 0x3e, 0x8f, 0xa3, 0xd3, 0xd0, 0x75, 0x04, 0xfe, 0xc1, 0xb5, 0xea, 0x3e, 0xc2, 0xc3, 0x4a, 0x80, 0x6e, 0x2c, 0x7a, 0x59, 0xfe, 0x6a, 0x94, 0x82, 0x2a, 0x7a, 0x47, 0x62, 0x84, 0xf8, 0x42, 0xfd, 0xa0, 0x94, 0x43, 0x4a, 0x39, 0x27, 0xd3, 0x06, 0x2d, 0x43, 0x9a, 0x21, 0xe7, 0x61, 0x54, 0x3d, 0xbc, 0xd3, 0x03, 0x2d, 0x09, 0x98, 0xc0, 0xe7, 0x7b, 0x74, 0xf6, 0x98, 0xab, 0x0b, 0x99, 0x80, 0x87, 0x47, 0x6b, 0x3b, 0xd5, 0x86, 0xec, 0x87, 0xfb, 0x03, 0xb7, 0x86, 0x5e, 0x6b, 0xb7, 0xd5, 0x57, 0xe8, 0xec, 0x7b, 0x31, 0xb6, 0x98, 0x5e, 0xec, 0xb7, 0xbe, 0x07, 0x3a, 0xec, 0xd3, 0xab, 0xee, 0x9a, 0x38, 0xe4, 0xe4, 0xfe, 0x76, 0x0a, 0x99, 0x43, 0x05, 0x64, 0x01, 0x38, 0x63, 0xe4, 0x14, 0x06, 0x9b, 0x99, 0x4a, 0x4f, 0xe1, 0x00, 0x73, 0x22, 0x0e, 0x44, 0xa0, 0x97, 0x44, 0xc4, 0xaa, 0x61, 0x99, 0x72, 0xac, 0x4e, 0xce, 0xe0, 0x35, 0x4c, 0x9d, 0xa0, 0x4e, 0x98, 0xa1, 0xad, 0x43, 0xce, 0x59, 0x25, 0x54, 0x05, 0xe4, 0xcf, 0x78, 0xa1, 0x94, 0x43, 0x0a, 0x19, 0x10, 0x40, 0x85, 0x66, 0xaa, 0xfb, 0xd8, 0x85, 0xd7, 0x6a, 0x28, 0x04, 0x06, 0x45, 0xc6, 0x28, 0x60, 0xd9, 0x8a, 0xd7, 0xc7, 0x38, 0xe1, 0x56, 0xa1, 0x82, 0xd0, 0xc8, 0x2e, 0x8a, 0x03, 0xe6, 0x49, 0xe5, 0x58, 0x31, 0xec, 0x51, 0x32, 0x25, 0x35, 0x03, 0x29, 0x19, 0x12, 0xd0, 0x0b, 0xef, 0xe1, 0x30, 0x72, 0x75, 0x2e, 0x39, 0xa4, 0x3a, 0xf8, 0x9b, 0x2b, 0xec, 0xd5, 0x72, 0x46, 0x2e, 0x17, 0xb5, 0x8a, 0xd8, 0xd6, 0x25, 0x05, 0xd3, 0x42, 0x46, 0x3b, 0x16, 0xfd, 0xce, 0xfe, 0x16, 0xf7, 0x04, 0xfc, 0x40, 0xdf, 0x3b, 0x90, 0xfd, 0xcd, 0xf6, 0x5b, 0xfb, 0x6c, 0xfe, 0xf0, 0xde, 0x65, 0xb0, 0x7e, 0xcd, 0xea, 0xdf, 0xe7, 0xe5, 0xfe, 0x71, 0xd4, 0x65, 0x51, 0x2e, 0xcd, 0xfa, 0x87, 0xfd, 0x58, 0xfc, 0x27, 0xd4, 0x68, 0x51, 0x8c, 0xed, 0xab, 0xa7, 0xd1, 0x50, 0x2e, 0x2f, 0xf9, 0x48, 0xc3, 0x9a, 0xb3, 0x23, 0xc5, 0xde, 0x28, 0x2c, 0xd8, 0xa8, 0xd7, 0xc5, 0x68, 0x93, 0x0d, 0x41, 0xca, 0xa1, 0x40, 0xd9, 0x13, 0x97, 0x41, 0x28, 0xc2, 0x55, 0x6c, 0xec, 0x38, 0xe2, 0xdf, 0x13, 0xd6, 0x61, 0x73, 0xe2, 0x4f, 0x6c, 0x6c, 0xb0, 0x6b, 0x5d, 0x1f, 0x95, 0xa0, 0x43, 0xc6, 0x5b, 0x09, 0x60, 0x4f, 0x72, 0xa0, 0x9e, 0x48, 0xe0, 0xe8, 0xe6, 0x04, 0x15, 0x82, 0x4c, 0x47, 0xa0, 0x82, 0x08, 0x07, 0x98, 0x96, 0x3c, 0x2c, 0x9a, 0x0e, 0x4d, 0x4a, 0x8a, 0x9a, 0x27, 0xea, 0xee, 0xe8, 0x1a, 0xf5, 0x05, 0xb1, 0x0b, 0x74, 0xba, 0x39, 0xee, 0x79, 0xec, 0x8f, 0x67, 0x48, 0x38, 0xeb, 0x75, 0xe8, 0x79, 0x9f, 0x09, 0x99, 0x1f, 0xcd, 0x06, 0x29, 0xe9, 0xf2, 0xe9, 0x79, 0x9f, 0x0d, 0x9d, 0x9b, 0x4b, 0x05, 0xac, 0xeb, 0x71, 0xa2, 0x19, 0x25, 0x1d, 0x98, 0x97, 0x4f, 0x07, 0x2e, 0xeb, 0xf8, 0xa2, 0x9a, 0x05, 0x6d, 0xb0, 0xe7, 0x5f, 0xfb, 0xae, 0xf5, 0xf9, 0x65, 0xf8, 0x3e, 0x39, 0xfe, 0x4b, 0x71, 0xe0, 0xb6, 0xf1, 0x75, 0x65, 0x12, 0x1e, 0xdb, 0xb6, 0xb3, 0xe3, 0x9c, 0xb2, 0x0f, 0x75, 0xd0, 0x22, 0x10, 0xd7, 0x2d, 0x8d, 0x76, 0x91, 0x37, 0x8f, 0x35, 0xd1, 0x22, 0x00, 0xc4, 0x25, 0x5c, 0xfe, 0xf0, 0x36, 0xbc, 0x35, 0x8e, 0x42, 0xe8, 0xa4, 0x03, 0xfc, 0xd2, 0x7d, 0xa6, 0xbc, 0xba, 0xcf, 0xc8, 0xb8, 0x15, 0x23, 0x54, 0x58, 0xb3, 0x2f, 0x5f, 0xb2, 0x9c, 0xa8, 0x89, 0x65, 0x39, 0x54, 0x38, 0xb3, 0xd7, 0x5b, 0x8c, 0xdc, 0xa6, 0x99, 0xb1, 0x79, 0x18, 0x38, 0x10, 0x57, 0xc0
-        };
-
-        // New
-//        const uint8_t prng_payload_sf11[] = {
-//            0xFD, 0xFE, 0xB4, 0xBF, 0x34, 0x04, 0x28, 0x58, 0x10, 0x74, 0x04, 0x74, 0x48, 0x34, 0x68, 0x34, 0x40, 0x48, 0x40, 0x00, 0x6C, 0x2C, 0x78, 0x58, 0x74, 0x68, 0x1C, 0x00, 0x20, 0x70, 0x44, 0x68, 0x04, 0x78, 0x48, 0x74, 0x20, 0x1C, 0x40, 0x40, 0x30, 0x24, 0x58, 0x04, 0x24, 0x48, 0x18, 0x20, 0x2C, 0x40, 0x44, 0x30, 0x34, 0x58, 0x08, 0x24, 0x00, 0x18, 0x40, 0x6C, 0x78, 0x74, 0x74, 0x18, 0x28, 0x08, 0x18, 0x00, 0x0C, 0x44, 0x68, 0x38, 0x54, 0x04, 0x6C, 0x0C, 0x70, 0x08, 0x3C, 0x0C, 0x54, 0x68, 0x3C, 0x54, 0x44, 0x6C, 0x6C, 0x70, 0x38, 0x3C, 0x18, 0x54, 0x64, 0x7C, 0x1C, 0x14, 0x3C, 0x6C, 0x58, 0x28, 0x6C, 0x18, 0x38, 0x64, 0x2C, 0x5C, 0x6C, 0x0C, 0x18, 0x48, 0x0C, 0x6C, 0x00, 0x38, 0x60, 0x2C, 0x14, 0x0C, 0x18, 0x10, 0x40, 0x4C, 0x60, 0x00, 0x70, 0x60, 0x24, 0x54, 0x2C, 0x1C, 0x44, 0x44, 0x28, 0x60, 0x18, 0x70, 0x64, 0x64, 0x5C, 0x6C, 0x3C, 0x4C, 0x1C, 0x20, 0x44, 0x18, 0x20, 0x64, 0x60, 0x5C, 0x54, 0x2C, 0x54, 0x04, 0x6C, 0x44, 0x78, 0x20, 0x5C, 0x60, 0x10, 0x14, 0x18, 0x48, 0x04, 0x6C, 0x20, 0x78, 0x58, 0x5C, 0x5C, 0x20, 0x08, 0x04, 0x00, 0x4C, 0x44, 0x28, 0x68, 0x58, 0x08, 0x5C, 0x04, 0x38, 0x50, 0x5C, 0x24, 0x00, 0x50, 0x48, 0x24, 0x08, 0x00, 0x64, 0x20, 0x64, 0x5C, 0x20, 0x6C, 0x58, 0x30, 0x2C, 0x3C, 0x00, 0x20, 0x30, 0x00, 0x58, 0x40, 0x6C, 0x64, 0x30, 0x70, 0x3C, 0x04, 0x20, 0x08, 0x30, 0x60, 0x58, 0x28, 0x6C, 0x50, 0x70, 0x0C, 0x04, 0x04, 0x38, 0x20, 0x50, 0x1C, 0x24, 0x0C, 0x50, 0x40, 0x0C, 0x18, 0x04, 0x78, 0x44, 0x7C, 0x1C, 0x7C, 0x04, 0x74, 0x40, 0x14, 0x18, 0x08, 0x78, 0x40, 0x74, 0x50, 0x78, 0x64, 0x74, 0x70, 0x14, 0x0C, 0x08, 0x60, 0x40, 0x68, 0x54, 0x64, 0x6C, 0x74, 0x70
-//        };
-
-
-        /**
-         *  Whitening sequence for payload with SF 12.
-         */
-        const uint8_t prng_payload_sf12[] = {
-            0xfd, 0x7c, 0xb4, 0xff, 0x5f, 0x9f, 0xd7, 0xab, 0x28, 0x73, 0x91, 0xff, 0xc5, 0xb5, 0xab, 0x1c, 0x92, 0xe7, 0x76, 0x74, 0x54, 0x9f, 0xfd, 0xc3, 0x7f, 0xa9, 0xb5, 0xd2, 0x5e, 0x46, 0xb7, 0x5c, 0x47, 0x7f, 0xfb, 0xff, 0xef, 0x35, 0x33, 0x1d, 0x15, 0xe7, 0x3d, 0x5f, 0x85, 0x5d, 0x91, 0xea, 0x87, 0xb7, 0x02, 0x55, 0x41, 0x4d, 0x30, 0xed, 0x18, 0x17, 0x11, 0x8d, 0x4c, 0x02, 0xab, 0xa0, 0xd9, 0x24, 0xd7, 0x24, 0x03, 0x97, 0x43, 0x01, 0x62, 0x8a, 0x7b, 0x99, 0xf4, 0xa6, 0x4e, 0x6f, 0xbb, 0x55, 0x49, 0xed, 0xea, 0x73, 0xbb, 0x36, 0xd9, 0x3e, 0x9c, 0xe3, 0xb2, 0x97, 0x24, 0xe1, 0x51, 0x38, 0x6f, 0x9e, 0x38, 0xec, 0x64, 0xbe, 0x54, 0x1a, 0x99, 0x4b, 0x05, 0x60, 0x01, 0x79, 0x48, 0xd4, 0xf0, 0x5a, 0x37, 0x2f, 0xd7, 0x4f, 0x6f, 0x02, 0x30, 0x01, 0x5e, 0x60, 0xbc, 0x5f, 0xf7, 0x1d, 0xbf, 0x4e, 0x13, 0xb0, 0xcd, 0x1e, 0xe8, 0xed, 0xe9, 0x9e, 0xa4, 0x39, 0x6b, 0x55, 0x72, 0x4f, 0x38, 0xaa, 0x15, 0x39, 0x16, 0xe8, 0x40, 0x11, 0x7e, 0xd8, 0x3e, 0x34, 0x1f, 0x57, 0x8d, 0x06, 0xca, 0x0c, 0x81, 0x55, 0x49, 0xa1, 0x8c, 0x0c, 0x03, 0xcf, 0xc0, 0x88, 0x5b, 0xad, 0x92, 0x33, 0x2c, 0x01, 0x5c, 0x92, 0xae, 0x01, 0x93, 0x2b, 0x16, 0x9e, 0x1f, 0x0a, 0xaf, 0xf6, 0x1d, 0xab, 0x64, 0xd1, 0x73, 0x44, 0x25, 0x35, 0x05, 0x09, 0xb8, 0x43, 0x9b, 0xe6, 0x61, 0x30, 0x70, 0x75, 0x2e, 0x19, 0xc4, 0x4e, 0xd8, 0xdf, 0x25, 0xee, 0x52, 0x30, 0x26, 0x76, 0x63, 0xd8, 0xf6, 0x5a, 0xc5, 0xbb, 0x26, 0x54, 0x02, 0x65, 0x0b, 0x13, 0x90, 0x2a, 0x10, 0x23, 0x41, 0x01, 0xf6, 0x13, 0xfc, 0xc8, 0xf4, 0x83, 0x45, 0x2c, 0x2a, 0x53, 0x05, 0xfc, 0xa4, 0x7f, 0xdf, 0xb5, 0x27, 0x35, 0x08, 0x42, 0xa3, 0x87, 0x46, 0xb4, 0xaa, 0xdd, 0xd7, 0x67, 0x6e, 0x18, 0x82, 0xcb, 0x1a, 0x18, 0xfe, 0x82, 0x75, 0xdd, 0xb6, 0xae, 0x14, 0xf0, 0x3d, 0x52, 0xe5, 0xc8, 0xe1, 0x7f, 0x99, 0x34, 0xc9, 0x5c, 0xeb, 0x4d, 0xa9, 0x9d, 0xdf, 0x7f, 0xb6, 0x12, 0x0f, 0xca, 0x41, 0xa9, 0x20, 0xfb, 0x23, 0x93, 0x7d, 0xa8, 0xec, 0xc6, 0x69, 0xc3, 0xb1, 0xf0, 0x5f, 0xd3, 0xb7, 0x01, 0x43, 0xf6, 0x13, 0xf0, 0xca, 0xb3, 0x7a, 0x17, 0xb8, 0xa7, 0xc4, 0x0f, 0x72, 0x25, 0x26, 0x65, 0xc4, 0xf5, 0x73, 0xfe, 0x3b, 0x95, 0xc4, 0x4a, 0x62, 0x50, 0x3e, 0x44, 0xc6, 0xef, 0xe2, 0xfb, 0x63, 0x15, 0x0e, 0x0a, 0xdb, 0x64, 0x39, 0x40, 0x07, 0x6a, 0x08, 0x32, 0x81, 0x7e, 0x36, 0x93, 0x3f, 0xdf, 0xcf, 0x47, 0x5b, 0x38, 0xa7, 0x52, 0xda, 0x44, 0xbc, 0x57, 0xc6, 0x9d, 0x87, 0x42, 0x51, 0xa6, 0xa0, 0x18, 0x02, 0x6c, 0xfa, 0xde, 0x8e, 0x5d, 0xeb, 0x9e, 0x39, 0x00, 0x1a, 0x42, 0x8f, 0xcb, 0xf8, 0x96, 0xde, 0xb5, 0x13, 0x20, 0x80, 0x13, 0xc0, 0x4d, 0x68, 0x8b, 0x8b, 0xe6, 0xc0, 0xa5, 0x7f, 0x2d, 0x40, 0x59, 0xea, 0x2c, 0xf1, 0xb8, 0x0d, 0xe8, 0x0a, 0x75, 0x1a, 0x59, 0xf4, 0x73, 0x35, 0xb7, 0x14, 0x35, 0x17, 0x20, 0x1b, 0xb0, 0x24, 0x41, 0xd2, 0xaf, 0xc7, 0xd6, 0xa0, 0x06, 0x08, 0x17, 0x96, 0xca, 0x9a, 0x93, 0x21, 0xe7, 0x50, 0xe3, 0xa6, 0x58, 0x68, 0x9b, 0xc6, 0x4c, 0x89, 0xae, 0x55, 0x4a, 0x76, 0x67, 0xf7, 0x58, 0x65, 0xbb, 0x37, 0x2f, 0xbb, 0xc2, 0x47, 0x71, 0x4f, 0xbe, 0x20, 0x75, 0x62, 0x39, 0x5e, 0x5d, 0xba, 0xb5, 0x52, 0x03, 0x60, 0xe2, 0xf2, 0x93, 0x04, 0x6a, 0x21, 0x44, 0x48, 0x50, 0x5c, 0xef, 0x2e, 0x38, 0xda, 0x37, 0x96, 0x09, 0x33, 0x56, 0x6f, 0x68, 0x66, 0x24, 0xb2, 0x99, 0x5f
-        };
-
-        // new from cr4/7
-//        const uint8_t prng_payload_sf12[] = {
-//            0xFD, 0x58, 0xB5, 0xFF, 0x5E, 0x9C, 0xD4, 0xA8, 0x28, 0x70, 0x10, 0xFC, 0xC4, 0xB4, 0xA8, 0x1C, 0x90, 0xE4, 0x74, 0x74, 0x54, 0x9C, 0xFC, 0xC0, 0x7C, 0xA8, 0xB4, 0xD0, 0x5C, 0x44, 0xB4, 0x5C, 0x44, 0x78, 0xF0, 0x7C, 0xEC, 0x34, 0x30, 0x1C, 0x14, 0xE4, 0x3C, 0x5C, 0x84, 0x5C, 0x90, 0xE8, 0x84, 0xB4, 0x00, 0x54, 0x40, 0x4C, 0x30, 0xFC, 0x1C, 0x1C, 0x90, 0x8C, 0x4C, 0x00, 0xA8, 0xA0, 0xD8, 0x64, 0xD4, 0x24, 0x00, 0x94, 0x40, 0x00, 0x60, 0x88, 0x78, 0x98, 0xF4, 0xA4, 0x4C, 0x2C, 0x98, 0x44, 0x4C, 0xE4, 0x68, 0x70, 0xB8, 0x34, 0xD8, 0x3C, 0x9C, 0xE0, 0xF0, 0x94, 0x24, 0xE0, 0x50, 0x38, 0x6C, 0x9C, 0x38, 0xAC, 0x44, 0xAC, 0x50, 0x10, 0x18, 0x48, 0x04, 0x60, 0x00, 0x78, 0x48, 0x94, 0xD0, 0x58, 0x34, 0x2C, 0xD4, 0x4C, 0x6C, 0x00, 0x30, 0x00, 0x5C, 0x60, 0xFC, 0x7C, 0xE4, 0x18, 0xB4, 0xCC, 0x10, 0xB0, 0xCC, 0x1C, 0xE8, 0xEC, 0xA8, 0xBC, 0xB4, 0x38, 0xE8, 0x54, 0x70, 0x4C, 0x38, 0xA8, 0x14, 0x78, 0x34, 0xF8, 0x44, 0x18, 0xFC, 0xD8, 0x3C, 0x34, 0x1C, 0x54, 0x8C, 0x44, 0xF8, 0x1C, 0x80, 0x44, 0x4C, 0xB8, 0x0C, 0x1C, 0x00, 0xCC, 0xC0, 0x88, 0x58, 0xEC, 0xB0, 0x20, 0x2C, 0x0C, 0x5C, 0x90, 0x2C, 0x00, 0x90, 0x28, 0x14, 0x8C, 0x18, 0x10, 0x2C, 0xD4, 0x5C, 0xA8, 0x64, 0xD0, 0x70, 0x04, 0x04, 0x24, 0x00, 0x00, 0x38, 0x40, 0x98, 0xE4, 0x60, 0x30, 0x70, 0x34, 0x4C, 0x68, 0x94, 0x08, 0x90, 0x1C, 0x24, 0xAC, 0x10, 0x30, 0x24, 0x74, 0x20, 0xF8, 0xE4, 0x5C, 0xCC, 0x38, 0x24, 0x54, 0x00, 0x64, 0x08, 0x50, 0xF0, 0x18, 0x04, 0x2C, 0xC0, 0x00, 0xF4, 0x10, 0xFC, 0xC8, 0xF4, 0xC0, 0x64, 0x3C, 0x2C, 0x58, 0x84, 0xFC, 0xA4, 0x7C, 0xDC, 0xB4, 0x24, 0x74, 0x28, 0x50, 0xE4, 0xAC, 0x40, 0xB4, 0x38, 0xD4, 0xD4, 0x64, 0x6C
-//        };
-
-//        // new from all
-//        const uint8_t prng_payload_sf12[] = {
-//            0x7D, 0xFE, 0xB7, 0xFF, 0x5E, 0x9C, 0xD4, 0xA8, 0x28, 0x70, 0x10, 0xFC, 0xC4, 0xB4, 0xA8, 0x1C, 0x90, 0xE4, 0x74, 0x74, 0x54, 0x1C, 0xFC, 0xC0, 0x7C, 0x28, 0xBC, 0xD0, 0x5C, 0x44, 0x3C, 0x5C, 0x44, 0x78, 0xF0, 0x74, 0xEC, 0x34, 0x30, 0x1C, 0x1C, 0x64, 0x74, 0x5C, 0x14, 0x5C, 0x90, 0xE8, 0x04, 0x34, 0x00, 0x54, 0x40, 0x4C, 0x30, 0xFC, 0x1C, 0x1C, 0x10, 0x04, 0x4C, 0x00, 0x28, 0x20, 0x58, 0x64, 0x7C, 0x24, 0x00, 0x94, 0x40, 0x00, 0x60, 0x88, 0x78, 0x18, 0x7C, 0xA4, 0x4C, 0x2C, 0x10, 0x44, 0x4C, 0x64, 0x68, 0x70, 0xB8, 0x3C, 0xD8, 0x3C, 0x14, 0xE8, 0x50, 0x14, 0x20, 0x60, 0x50, 0x38, 0x6C, 0x1C, 0x38, 0x2C, 0x44, 0xEC, 0x50, 0x10, 0x10, 0x48, 0x04, 0x60, 0x00, 0x78, 0x48, 0x9C, 0xD0, 0x50, 0x34, 0x2C, 0xD4, 0x44, 0x64, 0x00, 0x30, 0x00, 0x54, 0x60, 0xFC, 0x7C, 0x64, 0x18, 0x34, 0x4C, 0x18, 0xB0, 0xCC, 0x1C, 0xE8
-//        };
+        extern const uint8_t hamming_decode_lut[256];
 
         /**
-         *  Whitening sequence for payload with SF 6.
-         *  Should be the same as SF12...?
+         *  The data bits (1, 2, 3 and 5) of every dewhitened codeword, still shuffled, after deshuffling and reversing
+         *  its bits, for CR 4/6 and 4/5 (`fec_extract_data_only`).
          */
-        const uint8_t prng_payload_sf6[] = {
-            0x65, 0xFA, 0xB7, 0xFF, 0x5E, 0x14, 0x5C, 0x20, 0x28, 0x78, 0x10, 0x74, 0x4C, 0x34, 0x28, 0x14, 0x10, 0x6C, 0x7C, 0x74, 0x54, 0x1C, 0x74, 0x48, 0x7C, 0x28, 0x3C, 0x50, 0x54, 0x4C, 0x3C, 0x5C, 0x44, 0x78, 0x70, 0x74, 0x64, 0x3C, 0x38, 0x14, 0x1C, 0x6C, 0x74, 0x7C, 0x04, 0x5C, 0x10, 0x68, 0x0C, 0x34, 0x00, 0x5C, 0x40, 0x44, 0x30, 0x7C, 0x1C, 0x1C, 0x10, 0x04, 0x4C, 0x00, 0x28, 0x20, 0x58, 0x64, 0x7C, 0x34, 0x04, 0x1C, 0x40, 0x00, 0x60, 0x08, 0x78, 0x18, 0x7C, 0x2C, 0x44, 0x2C, 0x10, 0x44, 0x4C, 0x64, 0x68, 0x70, 0x38, 0x3C, 0x58, 0x34, 0x14, 0x68, 0x50, 0x04, 0x20, 0x60, 0x50, 0x38, 0x6C, 0x1C, 0x38, 0x24, 0x4C, 0x6C, 0x78, 0x10, 0x10, 0x48, 0x04, 0x68, 0x00, 0x78, 0x40, 0x1C, 0x58, 0x40, 0x30, 0x24, 0x54, 0x44, 0x64, 0x00, 0x30, 0x00, 0x54, 0x20, 0x54, 0x6C, 0x60, 0x10, 0x3C, 0x4C, 0x18, 0x38, 0x44, 0x14, 0x68, 0x64, 0x28, 0x3C, 0x3C, 0x3C, 0x60, 0x54, 0x70, 0x44, 0x30, 0x28, 0x14, 0x78, 0x7C, 0x50, 0x54, 0x1C, 0x74, 0x58, 0x34, 0x34, 0x14, 0x5C, 0x04, 0x4C, 0x38, 0x3C, 0x04, 0x4C, 0x44, 0x30, 0x04, 0x14, 0x00, 0x44, 0x40, 0x48, 0x70, 0x7C, 0x34, 0x28, 0x2C, 0x04, 0x54, 0x10, 0x24, 0x00, 0x10, 0x68, 0x3C, 0x1C, 0x1C, 0x10, 0x2C, 0x58, 0x54, 0x20, 0x6C, 0x50, 0x70, 0x0C, 0x0C, 0x24, 0x28, 0x00, 0x38, 0x50, 0x50, 0x6C, 0x64, 0x30, 0x70, 0x3C, 0x04, 0x20, 0x78, 0x10, 0x50, 0x5C, 0x28, 0x64, 0x50, 0x30, 0x2C, 0x34, 0x00, 0x60, 0x08, 0x54, 0x44, 0x30, 0x24, 0x54, 0x00, 0x6C, 0x00, 0x10, 0x50, 0x00, 0x00, 0x24, 0x40, 0x00, 0x7C, 0x18, 0x74, 0x48, 0x7C, 0x00, 0x0C, 0x0C, 0x30, 0x54, 0x04, 0x7C, 0x2C, 0x74, 0x5C, 0x34, 0x2C, 0x7C, 0x68, 0x78, 0x7C, 0x28, 0x48, 0x34, 0x30, 0x5C, 0x5C, 0x6C, 0x64
-        };
+        extern const uint8_t fec_data_lut[256];
     }
 }
 
@@ -0,0 +1,154 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Thread pool** : Fixed set of worker threads running a batch of tasks fork-join style.
+         *          <BR>The calling thread takes part in the work, so a pool of size 1 starts no threads at all.
+         */
+        class thread_pool {
+            private:
+                std::vector<std::thread>                  d_workers;
+                std::mutex                                d_mutex;
+                std::condition_variable                   d_start;      ///< Signals a new batch (or shutdown) to the workers.
+                std::condition_variable                   d_done;       ///< Signals the end of a batch to `run`.
+                const std::vector<std::function<void()>> *d_tasks;      ///< Batch currently being run.
+                std::atomic<uint32_t>                     d_next;       ///< Index of the next task to take.
+                uint32_t                                  d_busy;       ///< Workers still inside the current batch.
+                uint64_t                                  d_batch;      ///< Incremented for every batch.
+                bool                                      d_stop;
+
+                /**
+                 *  \brief  Take tasks from the current batch until none are left.
+                 */
+                void drain() {
+                    const std::vector<std::function<void()>> &tasks = *this->d_tasks;
+
+                    for (uint32_t i = this->d_next++; i < tasks.size(); i = this->d_next++) {
+                        tasks[i]();
+                    }
+                }
+
+                void worker() {
+                    uint64_t seen = 0u;
+
+                    for (;;) {
+                        {
+                            std::unique_lock<std::mutex> lock(this->d_mutex);
+                            this->d_start.wait(lock, [&] { return this->d_stop || this->d_batch != seen; });
+
+                            if (this->d_stop) return;
+                            seen = this->d_batch;
+                        }
+
+                        this->drain();
+
+                        std::lock_guard<std::mutex> lock(this->d_mutex);
+                        if (--this->d_busy == 0u) {
+                            this->d_done.notify_one();
+                        }
+                    }
+                }
+
+            public:
+                /**
+                 *  \brief  Default ctor.
+                 *
+                 *  \param  threads
+                 *          Total amount of threads working on a batch, including the caller of `run`.
+                 */
+                explicit thread_pool(const uint32_t threads)
+                    : d_tasks(nullptr), d_next(0u), d_busy(0u), d_batch(0u), d_stop(false) {
+                    for (uint32_t i = 1u; i < threads; i++) {
+                        this->d_workers.emplace_back(&thread_pool::worker, this);
+                    }
+                }
+
+                ~thread_pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(this->d_mutex);
+                        this->d_stop = true;
+                    }
+                    this->d_start.notify_all();
+
+                    for (std::thread &t : this->d_workers) {
+                        t.join();
+                    }
+                }
+
+                thread_pool(const thread_pool&)            = delete;
+                thread_pool& operator=(const thread_pool&) = delete;
+
+                /**
+                 *  \brief  Run all given tasks and return once every one of them has finished.
+                 *
+                 *  \param  tasks
+                 *          The tasks to run, in any order and on any thread.
+                 */
+                void run(const std::vector<std::function<void()>> &tasks) {
+                    if (tasks.empty()) return;
+
+                    this->d_tasks = &tasks;
+                    this->d_next  = 0u;
+
+                    // Not worth waking anyone for a single task
+                    if (this->d_workers.empty() || tasks.size() == 1u) {
+                        this->drain();
+                        return;
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(this->d_mutex);
+                        this->d_busy = this->d_workers.size();
+                        this->d_batch++;
+                    }
+                    this->d_start.notify_all();
+
+                    this->drain();
+
+                    std::unique_lock<std::mutex> lock(this->d_mutex);
+                    this->d_done.wait(lock, [&] { return this->d_busy == 0u; });
+                }
+
+                uint32_t size() const { return this->d_workers.size() + 1u; }
+
+                /**
+                 *  \brief  Return the worker threads, without the caller of `run`.
+                 */
+                std::vector<std::thread> &workers() { return this->d_workers; }
+        };
+
+    } // namespace lora
+} // namespace gr
+
+#endif /* THREAD_POOL_H */
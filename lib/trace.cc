@@ -0,0 +1,330 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "trace.h"
+
+namespace gr {
+    namespace lora {
+        namespace trace {
+
+            std::atomic<uint32_t> mask(0u);
+
+            /**
+             *  Header in front of each record in the ring buffer.
+             */
+            struct record {
+                uint32_t size;      ///< Bytes after the header.
+                uint8_t  kind;      ///< 0: text, 1: samples (name, '\0', samples).
+                uint8_t  category;  ///< Index of the category bit.
+                uint8_t  level;
+                uint8_t  pad;
+                double   time;      ///< Seconds since `configure`.
+            };
+
+            /**
+             *  The ring buffer and the thread writing it out. Producers only hold the lock to copy a record in.
+             */
+            class writer {
+                private:
+                    static const size_t capacity = 4u << 20;
+
+                    std::vector<char>       d_ring;
+                    uint64_t                d_head;         ///< Bytes ever written into the ring.
+                    uint64_t                d_tail;         ///< Bytes ever taken out by the thread.
+                    uint64_t                d_written;      ///< Bytes ever written to the files.
+                    uint64_t                d_dropped;
+                    bool                    d_running;
+                    std::mutex              d_mutex;
+                    std::condition_variable d_wakeup;
+                    std::condition_variable d_flushed;
+                    std::thread             d_thread;
+
+                    FILE                   *d_text;
+                    FILE                   *d_samples;
+                    uint64_t                d_samples_written;
+                    std::chrono::steady_clock::time_point d_start;
+
+                    void copy_in(const void *data, const size_t len) {
+                        const size_t at    = this->d_head % capacity;
+                        const size_t first = std::min(len, capacity - at);
+
+                        memcpy(&this->d_ring[at], data, first);
+                        memcpy(&this->d_ring[0], static_cast<const char *>(data) + first, len - first);
+                        this->d_head += len;
+                    }
+
+                    void write_out(const char *data, const size_t len) {
+                        static const char *categories[] = { "DETECT", "SYNC", "DEMOD", "HEADER", "FRAME", "SAMPLES" };
+                        static const char  levels[]     = { '?', 'W', 'I', 'V' };
+
+                        for (size_t at = 0u; at < len; ) {
+                            record r;
+                            memcpy(&r, data + at, sizeof(record));
+                            const char *payload = data + at + sizeof(record);
+                            at += sizeof(record) + r.size;
+
+                            if (r.kind == 0u) {
+                                fprintf(this->d_text, "[%12.6f] %-7s %c %.*s\n", r.time,
+                                        r.category < 6u ? categories[r.category] : "?", levels[r.level & 3u], (int)r.size, payload);
+                            } else {
+                                const size_t name_len = strnlen(payload, r.size);
+                                const size_t count    = (r.size - name_len - 1u) / sizeof(gr_complex);
+
+                                fwrite(payload + name_len + 1u, sizeof(gr_complex), count, this->d_samples);
+                                fprintf(this->d_text, "[%12.6f] SAMPLES V %s: %zu samples at %llu\n",
+                                        r.time, payload, count, (unsigned long long)this->d_samples_written);
+                                this->d_samples_written += count;
+                            }
+                        }
+
+                        fflush(this->d_text);
+                        fflush(this->d_samples);
+                    }
+
+                    void run() {
+                        std::vector<char> pending;
+                        std::unique_lock<std::mutex> lock(this->d_mutex);
+
+                        for (;;) {
+                            this->d_wakeup.wait(lock, [this] { return this->d_head != this->d_tail || !this->d_running; });
+
+                            if (this->d_head == this->d_tail && !this->d_running)
+                                return;
+
+                            // Take everything out, and write it without holding the lock
+                            const uint64_t end = this->d_head;
+                            const size_t   len = end - this->d_tail;
+                            const size_t   at  = this->d_tail % capacity;
+                            const size_t first = std::min(len, capacity - at);
+
+                            pending.resize(len);
+                            memcpy(&pending[0],     &this->d_ring[at], first);
+                            memcpy(&pending[first], &this->d_ring[0],  len - first);
+                            this->d_tail = end;
+
+                            lock.unlock();
+                            this->write_out(&pending[0], len);
+                            lock.lock();
+
+                            this->d_written = end;
+                            this->d_flushed.notify_all();
+                        }
+                    }
+
+                    void stop() {
+                        if (!this->d_thread.joinable())
+                            return;
+
+                        {
+                            std::lock_guard<std::mutex> lock(this->d_mutex);
+                            this->d_running = false;
+                        }
+                        this->d_wakeup.notify_one();
+                        this->d_thread.join();
+
+                        fclose(this->d_text);
+                        fclose(this->d_samples);
+                    }
+
+                public:
+                    writer() : d_ring(capacity), d_head(0u), d_tail(0u), d_written(0u), d_dropped(0u), d_running(false),
+                               d_text(nullptr), d_samples(nullptr), d_samples_written(0u) {}
+
+                    ~writer() {
+                        mask.store(0u);
+                        this->stop();
+                    }
+
+                    bool start(const std::string &path) {
+                        this->stop();
+
+                        this->d_text    = fopen((path + ".txt").c_str(),   "w");
+                        this->d_samples = fopen((path + ".cfile").c_str(), "wb");
+
+                        if (!this->d_text || !this->d_samples) {
+                            std::cerr << "[LoRa Decoder] WARNING : Could not open " << path << ".txt or .cfile for tracing!" << std::endl;
+                            if (this->d_text)    fclose(this->d_text);
+                            if (this->d_samples) fclose(this->d_samples);
+                            return false;
+                        }
+
+                        this->d_head = this->d_tail = this->d_written = 0u;
+                        this->d_samples_written = 0u;
+                        this->d_start   = std::chrono::steady_clock::now();
+                        this->d_running = true;
+                        this->d_thread  = std::thread(&writer::run, this);
+                        return true;
+                    }
+
+                    void put(const uint8_t kind, const uint32_t category_bits, const uint32_t l,
+                             const void *a, const size_t a_len, const void *b, const size_t b_len) {
+                        record r;
+                        r.size     = (uint32_t)(a_len + b_len);
+                        r.kind     = kind;
+                        r.category = 0u;
+                        r.level    = (uint8_t)l;
+                        r.pad      = 0u;
+                        r.time     = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->d_start).count();
+
+                        while (r.category < 24u && !(category_bits & (1u << r.category)))
+                            r.category++;
+
+                        const size_t total = sizeof(record) + r.size;
+
+                        std::lock_guard<std::mutex> lock(this->d_mutex);
+
+                        if (!this->d_running || total > capacity - (this->d_head - this->d_tail)) {
+                            this->d_dropped++;
+                            return;
+                        }
+
+                        this->copy_in(&r, sizeof(record));
+                        this->copy_in(a, a_len);
+                        this->copy_in(b, b_len);
+                        this->d_wakeup.notify_one();
+                    }
+
+                    void flush() {
+                        std::unique_lock<std::mutex> lock(this->d_mutex);
+                        const uint64_t end = this->d_head;
+
+                        this->d_flushed.wait(lock, [this, end] { return this->d_written >= end || !this->d_running; });
+                    }
+
+                    void disable() {
+                        this->flush();
+                        this->stop();
+                    }
+
+                    uint64_t dropped() {
+                        std::lock_guard<std::mutex> lock(this->d_mutex);
+                        return this->d_dropped;
+                    }
+            };
+
+            static writer &instance() {
+                static writer w;
+                return w;
+            }
+
+            void configure(const level l, const uint32_t categories, const std::string &path) {
+                mask.store(0u);
+
+                if (instance().start(path))
+                    mask.store((categories & ALL) | ((uint32_t)l << 24u));
+            }
+
+            bool configure(const std::string &spec, const std::string &path) {
+                static const char *level_names[]    = { "warning", "info", "verbose" };
+                static const char *category_names[] = { "detect", "sync", "demod", "header", "frame", "samples" };
+
+                if (spec.empty() || spec == "off") {
+                    disable();
+                    return true;
+                }
+
+                const size_t      colon = spec.find(':');
+                const std::string name  = spec.substr(0u, colon);
+                uint32_t          l     = 0u;
+                uint32_t          cats  = colon == std::string::npos ? (uint32_t)ALL : 0u;
+
+                for (uint32_t i = 0u; i < 3u; i++) {
+                    if (name == level_names[i]) l = i + 1u;
+                }
+
+                for (size_t from = colon; from != std::string::npos && from < spec.size(); ) {
+                    const size_t      to  = spec.find(',', from + 1u);
+                    const std::string cat = spec.substr(from + 1u, to == std::string::npos ? std::string::npos : to - from - 1u);
+                    bool              known = cat == "all";
+
+                    if (known) cats |= ALL;
+
+                    for (uint32_t i = 0u; i < 6u; i++) {
+                        if (cat == category_names[i]) {
+                            cats |= 1u << i;
+                            known = true;
+                        }
+                    }
+
+                    if (!known) l = 0u;
+                    from = to;
+                }
+
+                if (l == 0u || cats == 0u) {
+                    std::cerr << "[LoRa Decoder] WARNING : Invalid trace setting \"" << spec
+                              << "\", expected <warning|info|verbose>[:<detect|sync|demod|header|frame|samples|all>,...]" << std::endl;
+                    return false;
+                }
+
+                configure((level)l, cats, path);
+                return true;
+            }
+
+            void disable() {
+                mask.store(0u);
+                instance().disable();
+            }
+
+            void flush() {
+                instance().flush();
+            }
+
+            uint64_t dropped() {
+                return instance().dropped();
+            }
+
+            void text(const category c, const level l, const std::string &line) {
+                instance().put(0u, c, l, line.data(), line.size(), nullptr, 0u);
+            }
+
+            void samples(const char *name, const gr_complex *samples, const uint32_t len) {
+                instance().put(1u, SAMPLES, VERBOSE, name, strlen(name) + 1u, samples, len * sizeof(gr_complex));
+            }
+
+            /**
+             *  Reads `GR_LORA_TRACE` and `GR_LORA_TRACE_FILE` when the library is loaded.
+             */
+            static struct from_environment {
+                from_environment() {
+                    const char *spec = getenv("GR_LORA_TRACE");
+                    const char *path = getenv("GR_LORA_TRACE_FILE");
+
+                    if (spec && *spec)
+                        configure(std::string(spec), path && *path ? std::string(path) : std::string("/tmp/grlora_trace"));
+                }
+            } environment;
+
+        } /* namespace trace */
+    } /* namespace lora */
+} /* namespace gr */
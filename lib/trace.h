@@ -0,0 +1,174 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "lora_complex.h"
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Trace** : Runtime debug output of the decoder, off by default.
+         *          <BR>Each trace point has a category and a level, and is only formatted when both are enabled.
+         *          Enabled trace points are copied into a ring buffer, which a background thread writes to
+         *          `<path>.txt` (text) and `<path>.cfile` (samples), so the caller never waits on I/O.
+         *          When the ring buffer is full, records are dropped and counted instead.
+         *          <BR>Disabled, a trace point costs a relaxed load of one atomic and a branch.
+         *          <BR>Enable with `configure`, or at startup with the environment:
+         *          <BR>`GR_LORA_TRACE=<level>[:<category>,...]`, e.g. `info` or `verbose:detect,sync,samples`
+         *          <BR>`GR_LORA_TRACE_FILE=<path>` (default `/tmp/grlora_trace`)
+         */
+        namespace trace {
+
+            /**
+             *  \brief  What a trace point is about.
+             */
+            enum category : uint32_t {
+                DETECT  = 1u << 0,  ///< Preamble detection.
+                SYNC    = 1u << 1,  ///< Upchirp and downchirp synchronisation.
+                DEMOD   = 1u << 2,  ///< Demodulated symbols and CFO.
+                HEADER  = 1u << 3,  ///< Decoded HDR.
+                FRAME   = 1u << 4,  ///< The payload's bit pipeline.
+                SAMPLES = 1u << 5,  ///< Raw samples of detected and synced symbols, and the ideal chirps.
+                ALL     = (1u << 24) - 1u
+            };
+
+            /**
+             *  \brief  How detailed a trace point is. Enabling a level also enables the ones below it.
+             */
+            enum level : uint32_t {
+                WARNING = 1u,       ///< Unexpected, but decoding continues.
+                INFO    = 2u,       ///< Once per frame or state change.
+                VERBOSE = 3u        ///< Once per symbol or more.
+            };
+
+            /**
+             *  \brief  The enabled categories in the lower 24 bits, the enabled level in the upper 8. Zero when off.
+             */
+            extern std::atomic<uint32_t> mask;
+
+            /**
+             *  \brief  Return whether trace points of the given category and level are enabled.
+             */
+            inline bool enabled(const category c, const level l) {
+                const uint32_t m = mask.load(std::memory_order_relaxed);
+                return (m & c) && l <= (m >> 24u);
+            }
+
+            /**
+             *  \brief  Enable the given categories up to the given level, and (re)start the writer.
+             *
+             *  \param  l
+             *          The most detailed level to enable.
+             *  \param  categories
+             *          The categories to enable, or'ed together.
+             *  \param  path
+             *          The output files without extension.
+             */
+            void configure(const level l, const uint32_t categories, const std::string &path = "/tmp/grlora_trace");
+
+            /**
+             *  \brief  Parse a `GR_LORA_TRACE` value and `configure` accordingly. Returns false if it is invalid.
+             */
+            bool configure(const std::string &spec, const std::string &path = "/tmp/grlora_trace");
+
+            /**
+             *  \brief  Disable every trace point, and write what is still buffered.
+             */
+            void disable();
+
+            /**
+             *  \brief  Wait until every record traced so far has been written.
+             */
+            void flush();
+
+            /**
+             *  \brief  Return the amount of records dropped because the ring buffer was full.
+             */
+            uint64_t dropped();
+
+            /**
+             *  \brief  Queue a line of text.
+             */
+            void text(const category c, const level l, const std::string &line);
+
+            /**
+             *  \brief  Queue a copy of the given samples, written to the samples file and noted in the text file.
+             *
+             *  \param  name
+             *          Label of the samples in the text file.
+             *  \param  samples
+             *          The samples to copy.
+             *  \param  len
+             *          Length of said array.
+             */
+            void samples(const char *name, const gr_complex *samples, const uint32_t len);
+
+            /**
+             *  \brief  Formats one line with `<<` and queues it when it goes out of scope.
+             */
+            class line {
+                private:
+                    category           d_category;
+                    level              d_level;
+                    std::ostringstream d_stream;
+
+                public:
+                    line(const category c, const level l) : d_category(c), d_level(l) {}
+                    ~line() { text(this->d_category, this->d_level, this->d_stream.str()); }
+
+                    template <typename T>
+                    line& operator<<(const T &value) {
+                        this->d_stream << value;
+                        return *this;
+                    }
+            };
+
+        } /* namespace trace */
+    } /* namespace lora */
+} /* namespace gr */
+
+/**
+ *  \brief  Trace `EXPR` (a `<<` chain) in the given category and level, e.g. `LORA_TRACE(SYNC, VERBOSE, "Cd: " << c);`.
+ */
+#define LORA_TRACE(CATEGORY, LEVEL, EXPR)                                                                           \
+    do {                                                                                                            \
+        if (gr::lora::trace::enabled(gr::lora::trace::CATEGORY, gr::lora::trace::LEVEL)) {                          \
+            gr::lora::trace::line(gr::lora::trace::CATEGORY, gr::lora::trace::LEVEL) << EXPR;                       \
+        }                                                                                                           \
+    } while (0)
+
+/**
+ *  \brief  Trace a copy of `LEN` samples under the given name, if the `SAMPLES` category is enabled (at `VERBOSE`).
+ */
+#define LORA_TRACE_SAMPLES(NAME, PTR, LEN)                                                                          \
+    do {                                                                                                            \
+        if (gr::lora::trace::enabled(gr::lora::trace::SAMPLES, gr::lora::trace::VERBOSE)) {                        \
+            gr::lora::trace::samples(NAME, PTR, LEN);                                                               \
+        }                                                                                                           \
+    } while (0)
+
+#endif /* TRACE_H */
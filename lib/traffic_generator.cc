@@ -0,0 +1,204 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "traffic_generator.h"
+
+namespace gr {
+    namespace lora {
+
+        traffic_generator::traffic_generator(const traffic_config &config)
+            : d_config(config),
+              d_position(0u),
+              d_next_packet(0u),
+              d_gen(config.seed),
+              d_noise(0.0f, 1.0f) {
+            if (config.samp_rate < 125e3f || std::fmod((double)config.samp_rate, 125e3) != 0.0)
+                throw std::invalid_argument("[LoRa Traffic] ERROR : Sample rate should be a multiple of 125 kHz!");
+            if (config.sfs.empty())
+                throw std::invalid_argument("[LoRa Traffic] ERROR : No spreading factors to choose from!");
+            if (config.min_length == 0u || config.min_length > config.max_length || config.max_length > 255u)
+                throw std::invalid_argument("[LoRa Traffic] ERROR : Payload lengths should be between 1 and 255!");
+            if (config.duration <= 0.0 || config.packet_rate < 0.0 || config.max_cfo < 0.0f || config.max_timing_offset < 0.0f
+                    || config.min_snr > config.max_snr || config.collision_probability < 0.0 || config.collision_probability > 1.0)
+                throw std::invalid_argument("[LoRa Traffic] ERROR : Invalid duration, rate, CFO, timing offset, SNR or collision probability!");
+
+            // Throws for a SF or CR that is out of range
+            for (const uint8_t sf : config.sfs)
+                frame_encoder(config.samp_rate, sf, config.cr);
+
+            for (uint8_t sf = 7u; sf <= 12u; sf++)
+                this->d_encoders.emplace_back(config.samp_rate, sf, config.cr);
+
+            this->d_total_samples = (uint64_t)(config.duration * config.samp_rate);
+
+            // White over the whole band, with `noise_level` in the 125 kHz channel
+            this->d_noise_sigma = std::sqrt(std::pow(10.0f, config.noise_level / 10.0f) * (config.samp_rate / 125e3f) / 2.0f);
+
+            this->schedule();
+        }
+
+        /**
+         *  Draw the nodes and their packets, then force the collisions and mark every packet that overlaps another.
+         *  Uses its own generator, seeded with `seed + 1`, so the noise does not depend on the schedule.
+         */
+        void traffic_generator::schedule() {
+            const traffic_config &c = this->d_config;
+            std::mt19937_64 gen(c.seed + 1u);
+
+            std::uniform_int_distribution<size_t>   pick_sf(0u, c.sfs.size() - 1u);
+            std::uniform_real_distribution<float>   cfo(-c.max_cfo, c.max_cfo);
+            std::uniform_real_distribution<float>   snr(c.min_snr, c.max_snr);
+            std::uniform_real_distribution<float>   timing(0.0f, c.max_timing_offset);
+            std::uniform_int_distribution<uint32_t> length(c.min_length, c.max_length);
+            std::uniform_int_distribution<uint32_t> byte(0u, 255u);
+            std::uniform_real_distribution<double>  chance(0.0, 1.0);
+            std::exponential_distribution<double>   gap(c.packet_rate > 0.0 ? c.packet_rate : 1.0);
+
+            for (uint32_t node = 0u; node < c.nodes && c.packet_rate > 0.0; node++) {
+                const uint8_t        sf       = c.sfs[pick_sf(gen)];
+                const float          node_cfo = cfo(gen);
+                const float          node_snr = snr(gen);
+                const frame_encoder &encoder  = this->d_encoders[sf - 7u];
+
+                // One packet at a time: the next one arrives a random gap after the previous one ended
+                for (double t = gap(gen); ; ) {
+                    traffic_packet p;
+                    p.node          = node;
+                    p.sf            = sf;
+                    p.cr            = c.cr;
+                    p.cfo           = node_cfo;
+                    p.snr           = node_snr;
+                    p.timing_offset = c.max_timing_offset > 0.0f ? timing(gen) : 0.0f;
+                    p.start         = (uint64_t)(t * c.samp_rate) + (uint64_t)p.timing_offset;
+                    p.collided      = false;
+                    p.payload.resize(std::min(length(gen), encoder.max_payload_length()));
+                    p.samples       = encoder.frame_samples(p.payload.size());
+
+                    if (p.start + p.samples > this->d_total_samples)
+                        break;
+
+                    for (uint8_t &b : p.payload) b = (uint8_t)byte(gen);
+
+                    this->d_packets.push_back(p);
+                    t = (double)(p.start + p.samples) / c.samp_rate + gap(gen);
+                }
+            }
+
+            std::stable_sort(this->d_packets.begin(), this->d_packets.end(), [](const traffic_packet &a, const traffic_packet &b) {
+                return a.start < b.start;
+            });
+
+            for (size_t i = 1u; i < this->d_packets.size() && c.collision_probability > 0.0; i++) {
+                traffic_packet &p = this->d_packets[i];
+
+                if (chance(gen) >= c.collision_probability)
+                    continue;
+
+                // Start during the previous packet of another node
+                size_t j = i;
+                while (j > 0u && this->d_packets[j - 1u].node == p.node) j--;
+                if (j == 0u)
+                    continue;
+
+                const traffic_packet &other = this->d_packets[j - 1u];
+                const uint64_t        start = other.start + std::uniform_int_distribution<uint32_t>(0u, other.samples - 1u)(gen);
+
+                if (start + p.samples <= this->d_total_samples)
+                    p.start = start;
+            }
+
+            std::stable_sort(this->d_packets.begin(), this->d_packets.end(), [](const traffic_packet &a, const traffic_packet &b) {
+                return a.start < b.start;
+            });
+
+            for (size_t i = 0u; i < this->d_packets.size(); i++) {
+                const uint64_t end = this->d_packets[i].start + this->d_packets[i].samples;
+
+                for (size_t j = i + 1u; j < this->d_packets.size() && this->d_packets[j].start < end; j++)
+                    this->d_packets[i].collided = this->d_packets[j].collided = true;
+            }
+        }
+
+        /**
+         *  The frame at its SNR above the noise, moved to its CFO within the channel.
+         */
+        void traffic_generator::modulate(const uint32_t index, std::vector<gr_complex> &samples) {
+            const traffic_packet &p       = this->d_packets[index];
+            frame_encoder        &encoder = this->d_encoders[p.sf - 7u];
+
+            encoder.set_timing_offset(p.timing_offset - std::floor(p.timing_offset));
+            encoder.modulate(p.payload.data(), p.payload.size(), samples);
+
+            const float  amplitude = std::sqrt(std::pow(10.0f, (this->d_config.noise_level + p.snr) / 10.0f));
+            const double freq      = (this->d_config.offset + p.cfo) / this->d_config.samp_rate;
+
+            // On absolute indices, like a mixer that runs all the time
+            for (uint32_t k = 0u; k < samples.size(); k++)
+                samples[k] *= std::polar(amplitude, (float)(2.0 * M_PI * std::fmod(freq * (p.start + k), 1.0)));
+        }
+
+        uint32_t traffic_generator::generate(gr_complex *out, const uint32_t count) {
+            const uint32_t n   = (uint32_t)std::min<uint64_t>(count, this->d_total_samples - this->d_position);
+            const uint64_t end = this->d_position + n;
+
+            for (uint32_t i = 0u; i < n; i++)
+                out[i] = this->d_noise_sigma * gr_complex(this->d_noise(this->d_gen), this->d_noise(this->d_gen));
+
+            while (this->d_next_packet < this->d_packets.size() && this->d_packets[this->d_next_packet].start < end) {
+                this->d_active.push_back(active_packet());
+                this->d_active.back().index = this->d_next_packet;
+                this->modulate(this->d_next_packet, this->d_active.back().samples);
+                this->d_next_packet++;
+            }
+
+            for (const active_packet &a : this->d_active) {
+                const traffic_packet &p    = this->d_packets[a.index];
+                const uint64_t        from = std::max(this->d_position, p.start);
+                const uint64_t        to   = std::min(end, p.start + p.samples);
+
+                for (uint64_t k = from; k < to; k++)
+                    out[k - this->d_position] += a.samples[k - p.start];
+            }
+
+            this->d_active.erase(std::remove_if(this->d_active.begin(), this->d_active.end(), [&](const active_packet &a) {
+                return this->d_packets[a.index].start + this->d_packets[a.index].samples <= end;
+            }), this->d_active.end());
+
+            this->d_position = end;
+            return n;
+        }
+
+        void traffic_generator::rewind() {
+            this->d_position    = 0u;
+            this->d_next_packet = 0u;
+            this->d_active.clear();
+            this->d_gen.seed(this->d_config.seed);
+            this->d_noise.reset();
+        }
+
+    } /* namespace lora */
+} /* namespace gr */
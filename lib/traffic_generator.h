@@ -0,0 +1,132 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TRAFFIC_GENERATOR_H
+#define TRAFFIC_GENERATOR_H
+
+#include "frame_encoder.h"
+#include "lora_complex.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **traffic_config** : The network to simulate with `traffic_generator`.
+         */
+        struct traffic_config {
+            float                samp_rate     = 1e6f;     ///< Sample rate of the output, a multiple of 125 kHz.
+            double               duration      = 10.0;     ///< Length of the output in seconds.
+            uint32_t             nodes         = 10u;      ///< Amount of transmitters.
+            double               packet_rate   = 0.1;      ///< Mean packets per second of every node (Poisson arrivals).
+            std::vector<uint8_t> sfs           = { 7u };   ///< The SF of every node is drawn from these, repeat one to weigh it more.
+            uint8_t              cr            = 4u;       ///< Coding rate of the payloads, 1 to 4 for 4/5 to 4/8.
+            uint32_t             min_length    = 16u;      ///< Shortest payload.
+            uint32_t             max_length    = 16u;      ///< Longest payload, at most what `frame_encoder` can whiten.
+            float                max_cfo       = 0.0f;     ///< Every node has a fixed CFO in `[-max_cfo, max_cfo]` Hz.
+            float                max_timing_offset = 0.0f; ///< Every packet is delayed by `[0, max_timing_offset)` samples.
+            float                min_snr       = 30.0f;    ///< Every node has a fixed SNR in `[min_snr, max_snr]` dB, in the 125 kHz channel.
+            float                max_snr       = 30.0f;
+            float                noise_level   = -50.0f;   ///< Noise power in the 125 kHz channel, in dB. The noise is white over the whole sample rate.
+            double               collision_probability = 0.0; ///< Chance that a packet is moved to start during the previous packet of another node.
+            double               offset        = 100e3;    ///< Center frequency of the channel, in Hz from 0, like the captures in `examples/`.
+            uint64_t             seed          = 1u;
+        };
+
+        /**
+         *  \brief  **traffic_packet** : A packet in the generated traffic, the ground truth to compare a decoder against.
+         */
+        struct traffic_packet {
+            uint64_t             start;                    ///< Index of the first sample of its preamble.
+            uint32_t             samples;                  ///< Length of the frame in samples.
+            uint32_t             node;
+            uint8_t              sf;
+            uint8_t              cr;
+            float                cfo;                      ///< In Hz.
+            float                snr;                      ///< In dB, in the 125 kHz channel.
+            float                timing_offset;            ///< Delay in samples, the integer part is in `start`.
+            bool                 collided;                 ///< Whether another packet overlaps it (whatever its SF).
+            std::vector<uint8_t> payload;
+        };
+
+        /**
+         *  \brief  **Traffic generator** : Simulates the LoRa traffic of a network of nodes in one channel, as IQ samples.
+         *          <BR>Every node gets a SF, CFO and SNR, and sends packets with random payloads at Poisson distributed times,
+         *          one at a time. Packets can be forced to collide, on top of those that do by chance.
+         *          The whole schedule is drawn by the ctor, after which `generate` streams the samples in blocks of any size,
+         *          only modulating the frames it is in.
+         */
+        class traffic_generator {
+            private:
+                traffic_config              d_config;
+                std::vector<frame_encoder>  d_encoders;         ///< One for every SF from 7 to 12.
+                std::vector<traffic_packet> d_packets;          ///< Sorted on their start.
+                uint64_t                    d_total_samples;
+                uint64_t                    d_position;         ///< Index of the next sample to generate.
+                uint32_t                    d_next_packet;      ///< Index of the first packet that has not started yet.
+                float                       d_noise_sigma;      ///< Standard deviation of each component of the noise.
+                std::mt19937_64             d_gen;
+                std::normal_distribution<float> d_noise;
+
+                struct active_packet {
+                    uint32_t                index;
+                    std::vector<gr_complex> samples;
+                };
+                std::vector<active_packet>  d_active;           ///< The modulated packets that overlap `d_position`.
+
+                void schedule();
+                void modulate(const uint32_t index, std::vector<gr_complex> &samples);
+
+            public:
+                /**
+                 *  \brief  Default ctor, draws the schedule. Throws `std::invalid_argument` for an invalid configuration.
+                 *
+                 *  \param  config
+                 *          The network to simulate.
+                 */
+                traffic_generator(const traffic_config &config);
+
+                /**
+                 *  \brief  Write the next samples of the traffic, returns how many (less than `count` at the end, then 0).
+                 *
+                 *  \param  out
+                 *          Output buffer.
+                 *  \param  count
+                 *          Length of said buffer.
+                 */
+                uint32_t generate(gr_complex *out, const uint32_t count);
+
+                /**
+                 *  \brief  Start over from the first sample, with the same schedule and noise.
+                 */
+                void rewind();
+
+                const std::vector<traffic_packet> &packets() const { return this->d_packets; }
+                uint64_t total_samples()                     const { return this->d_total_samples; }
+                uint64_t position()                          const { return this->d_position; }
+                const traffic_config &config()               const { return this->d_config; }
+        };
+
+    } /* namespace lora */
+} /* namespace gr */
+
+#endif /* TRAFFIC_GENERATOR_H */
@@ -0,0 +1,133 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "upchirp_correlator.h"
+#include "kernels.h"
+
+namespace gr {
+    namespace lora {
+
+        upchirp_correlator::upchirp_correlator()
+            : d_ideal(nullptr), d_len(0u), d_linear(false), d_sign(1.0), d_ramp_mean(0.0), d_ramp_sd(1.0) {
+        }
+
+        /**
+         *  Least squares fit of a line through the ideal ifreq. If no sample deviates more than
+         *  0.1% of the ramp's range from it, the ramp `k` can stand in for the ideal chirp.
+         */
+        void upchirp_correlator::set_ideal(const float *ideal_ifreq, const uint32_t len) {
+            this->d_ideal     = ideal_ifreq;
+            this->d_len       = len;
+            this->d_ramp_mean = (len - 1.0) / 2.0;
+            this->d_ramp_sd   = std::sqrt(((double)len * len - 1.0) / 12.0);
+
+            double mean = 0.0, cov = 0.0;
+
+            for (uint32_t k = 0u; k < len; k++) {
+                mean += ideal_ifreq[k];
+            }
+            mean /= len;
+
+            for (uint32_t k = 0u; k < len; k++) {
+                cov += (k - this->d_ramp_mean) * (ideal_ifreq[k] - mean);
+            }
+
+            const double slope     = cov / (len * this->d_ramp_sd * this->d_ramp_sd);
+            const double tolerance = 1e-3 * std::abs(slope) * len;
+            double       max_error = 0.0;
+
+            for (uint32_t k = 0u; k < len; k++) {
+                max_error = std::max(max_error, std::abs(ideal_ifreq[k] - (mean + slope * (k - this->d_ramp_mean))));
+            }
+
+            this->d_sign   = slope < 0.0 ? -1.0 : 1.0;
+            this->d_linear = slope != 0.0 && max_error <= tolerance;
+        }
+
+        float upchirp_correlator::best(const float *samples_ifreq, const uint32_t window, const uint32_t from, const uint32_t to, int32_t *index) const {
+            if (!this->d_linear) {
+                return this->best_direct(samples_ifreq, window, from, to, index);
+            }
+
+            const uint32_t len = this->d_len;
+            float max_correlation = 0.0f;
+
+            if (from >= to || from + len >= window) {
+                return max_correlation;
+            }
+
+            // Running sums over x[i .. i + len), in double: they are updated, never recomputed
+            double sum_x = 0.0, sum_xx = 0.0, sum_kx = 0.0;
+
+            for (uint32_t k = 0u; k < len; k++) {
+                const double x = samples_ifreq[from + k];
+                sum_x  += x;
+                sum_xx += x * x;
+                sum_kx += k * x;
+            }
+
+            const double norm = this->d_sign / (this->d_ramp_sd * (len - 1.0));
+
+            for (uint32_t i = from; i < to && (i + len) < window; i++) {
+                if (i != from) {
+                    // Slide by one: drop x[i - 1], add x[i + len - 1]
+                    const double x_out = samples_ifreq[i - 1u];
+                    const double x_in  = samples_ifreq[i + len - 1u];
+
+                    sum_x  += x_in - x_out;
+                    sum_xx += x_in * x_in - x_out * x_out;
+                    sum_kx += len * x_in - sum_x;
+                }
+
+                const double mean     = sum_x / len;
+                const double variance = sum_xx / len - mean * mean;
+
+                if (variance <= 0.0) continue;
+
+                const float correlation = (float)((sum_kx - this->d_ramp_mean * sum_x) / std::sqrt(variance) * norm);
+
+                if (correlation > max_correlation) {
+                    *index = i;
+                    max_correlation = correlation;
+                }
+            }
+
+            return max_correlation;
+        }
+
+        float upchirp_correlator::best_direct(const float *samples_ifreq, const uint32_t window, const uint32_t from, const uint32_t to, int32_t *index) const {
+            float max_correlation = 0.0f;
+
+            for (uint32_t i = from; i < to && (i + this->d_len) < window; i++) {
+                const float correlation = gr::lora::kernels::cross_correlate_ifreq(samples_ifreq + i, this->d_ideal, this->d_len);
+
+                if (correlation > max_correlation) {
+                    *index = i;
+                    max_correlation = correlation;
+                }
+            }
+
+            return max_correlation;
+        }
+
+    } // namespace lora
+} // namespace gr
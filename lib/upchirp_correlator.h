@@ -0,0 +1,89 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef UPCHIRP_CORRELATOR_H
+#define UPCHIRP_CORRELATOR_H
+
+#include <cstdint>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Upchirp correlator** : Normalized cross correlation of an instantaneous frequency window
+         *          against the ideal upchirp, at every offset in a range.
+         *          <BR>The ideal upchirp's instantaneous frequency is a linear ramp, and normalized cross correlation
+         *          is invariant to scaling and shifting either input. Correlating against `k = 0..len-1` therefore
+         *          gives the same result, and only needs running sums of `x`, `x^2` and `k * x`, which are
+         *          updated in O(1) when the offset moves by one sample.
+         *          <BR>Should the ideal ifreq not be linear (e.g. when the sample rate equals the bandwidth
+         *          and the phase wraps), the correlation falls back to `kernels::cross_correlate_ifreq` per offset.
+         */
+        class upchirp_correlator {
+            private:
+                const float *d_ideal;       ///< The ideal upchirp ifreq, used by the fallback.
+                uint32_t     d_len;         ///< Correlation length.
+                bool         d_linear;      ///< Whether `d_ideal` is a linear ramp.
+                double       d_sign;        ///< Sign of the ramp's slope.
+                double       d_ramp_mean;   ///< Mean of `k = 0..len-1`.
+                double       d_ramp_sd;     ///< Standard deviation of `k = 0..len-1`.
+
+            public:
+                upchirp_correlator();
+
+                /**
+                 *  \brief  Set the ideal upchirp to correlate against.
+                 *
+                 *  \param  ideal_ifreq
+                 *          The instantaneous frequency of the ideal upchirp, kept by pointer.
+                 *  \param  len
+                 *          The correlation length, at least 2.
+                 */
+                void set_ideal(const float *ideal_ifreq, const uint32_t len);
+
+                /**
+                 *  \brief  Return the highest correlation over offsets `[from, to)` with `offset + len < window`,
+                 *          or 0 if none is positive.
+                 *
+                 *  \param  samples_ifreq
+                 *          The instantaneous frequency to search.
+                 *  \param  window
+                 *          The size of said array.
+                 *  \param  from
+                 *          The first offset to try.
+                 *  \param  to
+                 *          The offset to stop at.
+                 *  \param  index
+                 *          Set to the offset of the highest correlation, if a positive one was found.
+                 */
+                float best(const float *samples_ifreq, const uint32_t window, const uint32_t from, const uint32_t to, int32_t *index) const;
+
+                /**
+                 *  \brief  Same as `best`, but always with one `kernels::cross_correlate_ifreq` per offset.
+                 */
+                float best_direct(const float *samples_ifreq, const uint32_t window, const uint32_t from, const uint32_t to, int32_t *index) const;
+
+                bool is_linear() const { return this->d_linear; }
+        };
+
+    } // namespace lora
+} // namespace gr
+
+#endif /* UPCHIRP_CORRELATOR_H */
@@ -21,6 +21,7 @@
 #ifndef UTILITIES_H
 #define UTILITIES_H
 
+#include <chrono>
 #include <cstdint>
 
 namespace gr {
@@ -45,6 +46,13 @@ namespace gr {
             return t > max ? max : t;
         }
 
+        /**
+         *  \brief  Return the wall clock time in nanoseconds since the epoch, comparable between blocks and processes.
+         */
+        inline int64_t wall_clock_ns() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
         /**
          *  \brief  Rotate the given bits to the left and return the result.
          *
@@ -66,6 +74,37 @@ namespace gr {
             return ((bits << count) & len_mask) | (bits >> (size - count));
         }
 
+        /**
+         *  \brief  Transpose the 8x8 bit matrix with row `i` in byte `i` (and column `j` in bit `j`),
+         *          by swapping 2x2, 4x4 and then 2 4x4 blocks on the whole word (Hacker's Delight, 7-3).
+         *
+         *  \param  x
+         *          The matrix to transpose.
+         */
+        inline uint64_t transpose_8x8(uint64_t x) {
+            uint64_t t;
+
+            t = (x ^ (x >> 7u))  & 0x00AA00AA00AA00AAull;  x ^= t ^ (t << 7u);
+            t = (x ^ (x >> 14u)) & 0x0000CCCC0000CCCCull;  x ^= t ^ (t << 14u);
+            t = (x ^ (x >> 28u)) & 0x00000000F0F0F0F0ull;  x ^= t ^ (t << 28u);
+
+            return x;
+        }
+
+        /**
+         *  \brief  Reverse the bit order within each of the 8 bytes of the word, by swapping nibbles, pairs and then bits.
+         *
+         *  \param  x
+         *          The bytes to reverse.
+         */
+        inline uint64_t bit_reverse_bytes(uint64_t x) {
+            x = (x & 0xF0F0F0F0F0F0F0F0ull) >> 4u | (x & 0x0F0F0F0F0F0F0F0Full) << 4u;
+            x = (x & 0xCCCCCCCCCCCCCCCCull) >> 2u | (x & 0x3333333333333333ull) << 2u;
+            x = (x & 0xAAAAAAAAAAAAAAAAull) >> 1u | (x & 0x5555555555555555ull) << 1u;
+
+            return x;
+        }
+
         /**
          *  \brief  Return the `v` represented in a binary string.
          *
@@ -153,7 +192,7 @@ namespace gr {
          *  \param  even
          *          Check for even (`true`) or uneven (`false`) parity.
          */
-        bool check_parity_string(const std::string& word, const bool even = true) {
+        inline bool check_parity_string(const std::string& word, const bool even = true) {
             size_t count = 0, i = 0;
 
             while(i < 7) {
@@ -173,7 +212,7 @@ namespace gr {
          *  \param  even
          *          Check for even (`true`) or uneven (`false`) parity.
          */
-        bool check_parity(uint64_t word, const bool even = true) {
+        inline bool check_parity(uint64_t word, const bool even = true) {
             word ^= word >> 1;
             word ^= word >> 2;
             word = (word & 0x1111111111111111UL) * 0x1111111111111111UL;
@@ -191,7 +230,7 @@ namespace gr {
          *  \param  n
          *          The amount of indices.
          */
-        uint32_t select_bits(const uint32_t data, const uint8_t *indices, const uint8_t n) {
+        inline uint32_t select_bits(const uint32_t data, const uint8_t *indices, const uint8_t n) {
             uint32_t r = 0u;
 
             for(uint8_t i = 0u; i < n; ++i)
@@ -214,7 +253,7 @@ namespace gr {
          *  \param  out_data
          *          The resulting data words.
          */
-        void fec_extract_data_only(const uint8_t *in_data, const uint32_t len, const uint8_t *indices, const uint8_t n, uint8_t *out_data) {
+        inline void fec_extract_data_only(const uint8_t *in_data, const uint32_t len, const uint8_t *indices, const uint8_t n, uint8_t *out_data) {
             for (uint32_t i = 0u, out_index = 0u; i < len; i += 2u) {
                 const uint8_t d2 = (i + 1u < len) ? select_bits(in_data[i + 1u], indices, n) & 0xFF
                                                   : 0u;
@@ -271,6 +310,21 @@ namespace gr {
             return pack_byte(p1, bit(v, 0), bit(v, 1), bit(v, 2), p2, bit(v, 3), p3, p4);
         }
 
+        /**
+         *  \brief  Return the value whose Gray code (`v ^ (v >> 1)`, as applied to every demodulated bin) is the given word.
+         *
+         *  \param  word
+         *          The Gray coded word.
+         */
+        inline uint32_t gray_decode(const uint32_t word) {
+            uint32_t v = word;
+
+            for (uint32_t shift = word >> 1u; shift; shift >>= 1u)
+                v ^= shift;
+
+            return v;
+        }
+
         /**
          *  \brief  Hamming(8,4) decoding by constructing a Syndrome matrix LUT for XORing on parity errors.
          *
@@ -278,7 +332,7 @@ namespace gr {
          *          The byte to decode.
          *  \return Returs a nibble containing the corrected data.
          */
-        uint8_t hamming_decode_soft_byte(uint8_t v) {
+        inline uint8_t hamming_decode_soft_byte(uint8_t v) {
             // Precalculation
             // Which bits are covered (including self)?
             // p1 10110100
@@ -341,7 +395,7 @@ namespace gr {
          *  \param  out_data
          *          The decoded result words.
          */
-        void hamming_decode_soft(const uint8_t *words, const uint32_t len, uint8_t *out_data) {
+        inline void hamming_decode_soft(const uint8_t *words, const uint32_t len, uint8_t *out_data) {
             for (uint32_t i = 0u, out_index = 0u; i < len; i += 2u) {
                 const uint8_t d2 = (i + 1u < len) ? hamming_decode_soft_byte(words[i + 1u])
                                                   : 0u;
@@ -350,6 +404,67 @@ namespace gr {
             }
         }
 
+        /**
+         *  \brief  CRC-16-CCITT (polynomial `0x1021`, initial value `0x0000`, MSB first, no final XOR).
+         *
+         *  \param  data
+         *          The bytes to checksum.
+         *  \param  len
+         *          Length of said array.
+         */
+        inline uint16_t crc16_ccitt(const uint8_t *data, const uint32_t len) {
+            uint16_t crc = 0x0000u;
+
+            for (uint32_t i = 0u; i < len; i++) {
+                crc ^= (uint16_t)(data[i] << 8u);
+
+                for (uint32_t b = 0u; b < 8u; b++) {
+                    crc = (crc & 0x8000u) ? (uint16_t)((crc << 1u) ^ 0x1021u) : (uint16_t)(crc << 1u);
+                }
+            }
+
+            return crc;
+        }
+
+        /**
+         *  \brief  The 5-bit checksum of the explicit HDR, over its first 3 nibbles (12 bits).
+         *          <BR>Each checksum bit is the parity of a fixed subset of the HDR bits, so any single bit error changes it.
+         *
+         *  \param  n0
+         *          The MSB nibble of the payload length.
+         *  \param  n1
+         *          The LSB nibble of the payload length.
+         *  \param  n2
+         *          The coding rate (upper 3 bits) and the payload CRC flag (LSB).
+         */
+        inline uint8_t header_checksum(const uint8_t n0, const uint8_t n1, const uint8_t n2) {
+            const uint8_t c4 = bit(n0, 3) ^ bit(n0, 2) ^ bit(n0, 1) ^ bit(n0, 0);
+            const uint8_t c3 = bit(n0, 3) ^ bit(n1, 3) ^ bit(n1, 2) ^ bit(n1, 1) ^ bit(n2, 0);
+            const uint8_t c2 = bit(n0, 2) ^ bit(n1, 3) ^ bit(n1, 0) ^ bit(n2, 3) ^ bit(n2, 1);
+            const uint8_t c1 = bit(n0, 1) ^ bit(n1, 2) ^ bit(n1, 0) ^ bit(n2, 2) ^ bit(n2, 1) ^ bit(n2, 0);
+            const uint8_t c0 = bit(n0, 0) ^ bit(n1, 1) ^ bit(n2, 3) ^ bit(n2, 2) ^ bit(n2, 1) ^ bit(n2, 0);
+
+            return (uint8_t)(c4 << 4u | c3 << 3u | c2 << 2u | c1 << 1u | c0);
+        }
+
+        /**
+         *  \brief  The CRC a LoRa transmitter appends to the payload: the CRC-16-CCITT of all but the last 2 bytes,
+         *          XORed with those 2 bytes (the last one in the LSB).
+         *          <BR>It is sent LSB first, right after the payload.
+         *
+         *  \param  payload
+         *          The payload bytes.
+         *  \param  len
+         *          Length of said array.
+         */
+        inline uint16_t payload_crc(const uint8_t *payload, const uint32_t len) {
+            switch (len) {
+                case 0u:  return 0x0000u;
+                case 1u:  return payload[0];
+                default:  return crc16_ccitt(payload, len - 2u) ^ payload[len - 1u] ^ (uint16_t)(payload[len - 2u] << 8u);
+            }
+        }
+
     }
 }
 
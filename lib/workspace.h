@@ -0,0 +1,110 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2017 Pieter Robyns, William Thenaers.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <volk/volk.h>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace gr {
+    namespace lora {
+
+        /**
+         *  \brief  **Workspace** : A single cache-line-aligned block of scratch memory, carved into buffers once.
+         *          <BR>Sum the `bytes_for` of every buffer, `allocate` that total and `take` the buffers in any order.
+         *          Every buffer starts on its own cache line, so none of them share a line with their neighbours.
+         */
+        class workspace {
+            private:
+                uint8_t *d_base;    ///< Start of the allocation.
+                size_t   d_size;    ///< Size of the allocation in bytes.
+                size_t   d_used;    ///< Bytes already handed out by `take`.
+
+            public:
+                static const size_t alignment = 64u;   ///< Size of a cache line, also enough for any VOLK kernel.
+
+                /**
+                 *  \brief  Return the amount of bytes `take` will use for the given amount of elements.
+                 *
+                 *  \param  count
+                 *          The amount of elements of type `T`.
+                 */
+                template <typename T>
+                static size_t bytes_for(const size_t count) {
+                    return (count * sizeof(T) + alignment - 1u) & ~(alignment - 1u);
+                }
+
+                workspace() : d_base(nullptr), d_size(0u), d_used(0u) {}
+
+                ~workspace() {
+                    if (this->d_base) volk_free(this->d_base);
+                }
+
+                workspace(const workspace&)            = delete;
+                workspace& operator=(const workspace&) = delete;
+
+                /**
+                 *  \brief  Allocate (and zero) the whole workspace, invalidating all buffers taken before.
+                 *
+                 *  \param  bytes
+                 *          Total size, the sum of `bytes_for` of every buffer.
+                 */
+                void allocate(const size_t bytes) {
+                    if (this->d_base) volk_free(this->d_base);
+
+                    this->d_base = static_cast<uint8_t *>(volk_malloc(bytes, alignment));
+                    if (!this->d_base) throw std::bad_alloc();
+
+                    memset(this->d_base, 0, bytes);
+                    this->d_size = bytes;
+                    this->d_used = 0u;
+                }
+
+                /**
+                 *  \brief  Hand out the next buffer.
+                 *
+                 *  \param  count
+                 *          The amount of elements of type `T`.
+                 */
+                template <typename T>
+                T *take(const size_t count) {
+                    const size_t bytes = bytes_for<T>(count);
+
+                    if (this->d_used + bytes > this->d_size) {
+                        throw std::logic_error("[LoRa Decoder] ERROR : Workspace is smaller than the buffers taken from it!");
+                    }
+
+                    T *buffer = reinterpret_cast<T *>(this->d_base + this->d_used);
+                    this->d_used += bytes;
+
+                    return buffer;
+                }
+
+                size_t size() const { return this->d_size; }
+        };
+
+    } // namespace lora
+} // namespace gr
+
+#endif /* WORKSPACE_H */
@@ -22,15 +22,37 @@
 from gnuradio import gr
 from gnuradio.filter import freq_xlating_fir_filter_ccf, firdes, fractional_resampler_cc
 from gnuradio.analog import quadrature_demod_cf
-from gnuradio.blocks import null_sink, delay
+from gnuradio.blocks import delay
 import lora
 import pmt
 
 class lora_receiver(gr.hier_block2):
     """
     docstring for block lora_receiver
+
+    sf can be a single spreading factor or a list of them. A list decodes all
+    given spreading factors behind one resampler and channelizer.
+
+    demodulation is 'gradient', 'fft' or 'auto', which times both at startup
+    and keeps the fastest for each spreading factor.
+
+    export_raw publishes the unfiltered samples of every decoded symbol on the
+    'debug' port (single spreading factor only), copied into a c32vector PDU
+    per symbol. Off, neither the copies nor the delay line feeding them are
+    made.
+
+    crc_check is 'off', 'flag' (publish every frame with crc_ok in its
+    metadata) or 'drop' (only publish frames whose payload CRC matches).
+
+    threshold_margin, in dB, tracks the noise floor and keeps the detection
+    threshold that far above it. 0 uses the absolute threshold instead.
+
+    set_sf switches a single spreading factor while running. Call
+    c_decoder.prepare(sf, out_samp_rate) before starting the flowgraph for
+    every higher spreading factor it may switch to, so its input buffer fits:
+    set_sf returns False, keeping the current one, if it was not.
     """
-    def __init__(self, in_samp_rate, freq, offset, sf, out_samp_rate, threshold = 0.01):
+    def __init__(self, in_samp_rate, freq, offset, sf, out_samp_rate, threshold = 0.01, demodulation = 'auto', export_raw = False, crc_check = 'flag', threshold_margin = 0):
         gr.hier_block2.__init__(self,
             "lora_receiver",  # Min, Max, gr.sizeof_<type>
             gr.io_signature(1, 1, gr.sizeof_gr_complex),  # Input signature
@@ -44,10 +66,15 @@ class lora_receiver(gr.hier_block2):
         bw                 = 125000
 
         # Define blocks
-        null1          = null_sink(gr.sizeof_float)
-        null2          = null_sink(gr.sizeof_float)
-        self.c_decoder = lora.decoder(out_samp_rate, sf)
+        self.multi_sf  = isinstance(sf, (list, tuple))
+        self.export_raw = export_raw and not self.multi_sf
+        if self.multi_sf:
+            self.c_decoder = lora.multi_sf_decoder(out_samp_rate, [int(s) for s in sf], 0, demodulation)
+        else:
+            self.c_decoder = lora.decoder(out_samp_rate, sf, demodulation, self.export_raw)
         self.set_threshold(threshold)
+        self.set_threshold_margin(threshold_margin)
+        self.set_crc_check(crc_check)
 
         decimation = 1
 
@@ -55,7 +82,6 @@ class lora_receiver(gr.hier_block2):
         channelizer      = freq_xlating_fir_filter_ccf(decimation, lpf, offset, out_samp_rate)
         self.channelizer = channelizer
         resampler        = fractional_resampler_cc(0, float(in_samp_rate) / float(out_samp_rate))
-        self.delay       = delay(gr.sizeof_gr_complex, int((len(lpf)-1) / 2.0))
 
         # Messages
         self.message_port_register_hier_out('debug')
@@ -65,20 +91,25 @@ class lora_receiver(gr.hier_block2):
         self.connect( (self,        0), (resampler,      0) )
         self.connect( (resampler,   0), (channelizer,    0) )
         self.connect( (channelizer, 0), (self.c_decoder, 0) )
-        self.connect( (resampler,   0), (self.delay,     0) )
-        self.connect( (self.delay,  0), (self.c_decoder, 1) )
-        self.msg_connect( (self.c_decoder, 'debug' ), (self, 'debug' ) )
+        if self.export_raw:
+            # Align the raw samples with the channelizer's group delay
+            self.delay = delay(gr.sizeof_gr_complex, int((len(lpf)-1) / 2.0))
+            self.connect( (resampler,   0), (self.delay,     0) )
+            self.connect( (self.delay,  0), (self.c_decoder, 1) )
+            self.msg_connect( (self.c_decoder, 'debug' ), (self, 'debug' ) )
         self.msg_connect( (self.c_decoder, 'frames'), (self, 'frames') )
 
     def get_sf(self):
         return self.sf
 
     def set_sf(self, sf):
-        self.sf = sf
         ## hier_block2 does not have a realtime attribute:
         ##     http://gnuradio.org/doc/sphinx/runtime.html?highlight=hier_block2#gnuradio.gr.hier_block2
         # if self.realtime:
-        self.c_decoder.set_sf(self.sf)
+        if self.multi_sf or not self.c_decoder.set_sf(sf):
+            return False
+        self.sf = sf
+        return True
 
     def get_offset(self):
         return self.offset
@@ -93,3 +124,17 @@ class lora_receiver(gr.hier_block2):
     def set_threshold(self, threshold):
         self.threshold = threshold
         self.c_decoder.set_abs_threshold(self.threshold)
+
+    def get_threshold_margin(self):
+        return self.threshold_margin
+
+    def set_threshold_margin(self, threshold_margin):
+        self.threshold_margin = threshold_margin
+        self.c_decoder.set_threshold_margin(self.threshold_margin)
+
+    def get_crc_check(self):
+        return self.crc_check
+
+    def set_crc_check(self, crc_check):
+        self.crc_check = crc_check
+        self.c_decoder.set_crc_check(self.crc_check)
@@ -706,6 +706,11 @@ class message_mongodb_sink(gr.basic_block):
             self.tag = ''
 
     def msg_handler(self, msg):
+        # Frames are PDUs, store their bytes along with their metadata
+        meta = {}
+        if pmt.is_pair(msg):
+            meta = pmt.to_python(pmt.car(msg)) or {}
+            msg = pmt.cdr(msg)
         msg = pmt.to_python(msg)
 
         record = {
@@ -714,4 +719,8 @@ class message_mongodb_sink(gr.basic_block):
             "chirp": Binary(msg.tobytes())
         }
 
+        for key in ("sf", "cr", "length", "crc_ok", "cfo", "snr", "preamble_index"):
+            if key in meta:
+                record[key] = meta[key]
+
         self.collection.insert_one(record)
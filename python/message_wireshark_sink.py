@@ -705,6 +705,9 @@ class message_wireshark_sink(gr.basic_block):
         self.client = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
 
     def msg_handler(self, msg):
+        # Frames are PDUs, only send their bytes
+        if pmt.is_pair(msg):
+            msg = pmt.cdr(msg)
         msg = pmt.to_python(msg)
         self.client.sendto(msg, (self.host, self.port))
 
@@ -9,14 +9,23 @@
 
 %{
 #include "lora/decoder.h"
+#include "lora/latency_sink.h"
 #include "lora/message_file_sink.h"
 #include "lora/message_socket_sink.h"
+#include "lora/multi_sf_decoder.h"
+#include "lora/multichannel_receiver.h"
 %}
 
 
 %include "lora/decoder.h"
 GR_SWIG_BLOCK_MAGIC2(lora, decoder);
+%include "lora/latency_sink.h"
+GR_SWIG_BLOCK_MAGIC2(lora, latency_sink);
 %include "lora/message_file_sink.h"
 GR_SWIG_BLOCK_MAGIC2(lora, message_file_sink);
 %include "lora/message_socket_sink.h"
 GR_SWIG_BLOCK_MAGIC2(lora, message_socket_sink);
+%include "lora/multi_sf_decoder.h"
+GR_SWIG_BLOCK_MAGIC2(lora, multi_sf_decoder);
+%include "lora/multichannel_receiver.h"
+GR_SWIG_BLOCK_MAGIC2(lora, multichannel_receiver);